@@ -3,7 +3,25 @@
 // Include the header where InstrumentInfo is defined
 // It contains: pluginInstanceId and tags  [oai_citation:3‡Conductor.h](file-service://file-LpDXG54mpw8MSGPQWWDu9E)
 #include "Conductor.h" // or wherever InstrumentInfo lives
-#include <cmath>
+
+namespace
+{
+    // Built once so routing never constructs a String on the audio thread
+    const juce::String& masterBusName()
+    {
+        static const juce::String name("Master");
+        return name;
+    }
+}
+
+AudioRouter::AudioRouter(RcuDomain& routeDomain)
+    : routes(routeDomain)
+{
+    const juce::ScopedLock sl(writeLock);
+    indexForBus(masterBusName());
+    ensureBusExists(masterBusName());
+    publishRoutes();
+}
 
 void AudioRouter::prepare(double sampleRate, int maxBlockSize, int numChannels)
 {
@@ -11,14 +29,22 @@ void AudioRouter::prepare(double sampleRate, int maxBlockSize, int numChannels)
     jassert(maxBlockSize > 0);
     jassert(numChannels > 0);
 
+    const juce::ScopedLock sl(writeLock);
     sr = sampleRate;
     maxBlock = maxBlockSize;
     channels = numChannels;
+    meters.prepare(sampleRate);
 
+    // Fresh buses; the old ones live until the table pointing at them is reclaimed
+    auto previousBuses = std::make_shared<std::map<juce::String, juce::AudioBuffer<float>>>(std::move(buses));
     buses.clear();
-    ensureBusExists("Master");
+    ensureBusExists(masterBusName());
     for (const auto& stem : stemDefinitions)
         ensureBusExists(stem.name);
+    for (const auto& busName : graphBuses)
+        ensureBusExists(busName);
+
+    publishRoutes([previousBuses] { previousBuses->clear(); });
 }
 
 void AudioRouter::beginBlock(int numSamples)
@@ -26,44 +52,67 @@ void AudioRouter::beginBlock(int numSamples)
     jassert(numSamples > 0);
     jassert(numSamples <= maxBlock);
 
+    const auto* table = routes.get();
+    if (table == nullptr)
+        return;
+
     // Ensure all bus buffers have correct shape then clear only this block region
-    for (auto& [name, buf] : buses)
+    for (auto* buf : table->busBuffers)
     {
-        if (buf.getNumChannels() != channels || buf.getNumSamples() != maxBlock)
-            buf.setSize(channels, maxBlock, false, true, true);
+        if (buf == nullptr)
+            continue;
+
+        if (buf->getNumChannels() != channels || buf->getNumSamples() != maxBlock)
+            buf->setSize(channels, maxBlock, false, true, true);
 
-        buf.clear(0, numSamples);
+        buf->clear(0, numSamples);
     }
 }
 
-void AudioRouter::routeAudio(const juce::String& pluginInstanceId,
+void AudioRouter::routeAudio(int pluginSlotIndex,
                             const juce::AudioBuffer<float>& pluginAudio,
                             int numSamples)
 {
-    if (numSamples <= 0) return;
+    const auto* table = routes.get();
+    if (numSamples <= 0 || table == nullptr) return;
 
-    // Always to Master
-    addToBus("Master", pluginAudio, numSamples);
-
-    // Route to one stem bus (MVP)
-    auto it = tagsByPluginId.find(pluginInstanceId);
-
-    const TagSet empty;
-    const TagSet& tags = (it != tagsByPluginId.end()) ? it->second : empty;
-
-    const auto stem = chooseStemBusFor(pluginInstanceId, tags);
+    static const RouteTable::SlotRoute masterOnly;
+    const auto& route = pluginSlotIndex >= 0 && pluginSlotIndex < (int) table->routesBySlot.size()
+                            ? table->routesBySlot[(size_t) pluginSlotIndex]
+                            : masterOnly;
     if (renderDebugEnabled)
     {
-        const auto key = pluginInstanceId.toStdString();
+        const auto key = route.pluginId.toStdString();
         if (renderDebugLoggedPlugins.insert(key).second)
-            logRenderMatch(pluginInstanceId, tags, stem.isNotEmpty() ? stem : "Master");
+            logRenderMatch(route.pluginId, route.tagList, route.stem.isNotEmpty() ? route.stem : "Master");
     }
-    if (stem.isNotEmpty() && stem != "Master")
-        addToBus(stem, pluginAudio, numSamples);
+
+    // Master, the stem and every send are filled in one pass over the plugin's audio
+    constexpr int kMaxDestinations = 16;
+    MixKernels::Destination destinations[kMaxDestinations];
+    int numDestinations = 0;
+    for (int i = 0; i < route.numDestinations; ++i)
+    {
+        if (numDestinations == kMaxDestinations)
+        {
+            MixKernels::accumulate(pluginAudio.getArrayOfReadPointers(), pluginAudio.getNumChannels(),
+                                   destinations, numDestinations, numSamples);
+            numDestinations = 0;
+        }
+
+        const auto& entry = table->destinations[(size_t) (route.firstDestination + i)];
+        auto* bus = table->busBuffers[(size_t) entry.bus];
+        destinations[numDestinations++] = { bus->getArrayOfWritePointers(), bus->getNumChannels(), entry.gain };
+    }
+
+    MixKernels::accumulate(pluginAudio.getArrayOfReadPointers(), pluginAudio.getNumChannels(),
+                           destinations, numDestinations, numSamples);
 }
 
 void AudioRouter::rebuildTagIndex(const std::vector<InstrumentInfo>& orchestra)
 {
+    const juce::ScopedLock sl(writeLock);
+
     // Build a fresh map then swap (avoid mutating the live map in-place)
     std::unordered_map<juce::String, TagSet> fresh;
 
@@ -77,10 +126,12 @@ void AudioRouter::rebuildTagIndex(const std::vector<InstrumentInfo>& orchestra)
     }
 
     tagsByPluginId.swap(fresh);
+    publishRoutes();
 }
 
 void AudioRouter::setStemRules(const std::vector<StemRuleDefinition>& stems)
 {
+    const juce::ScopedLock sl(writeLock);
     std::vector<StemDefinition> normalised;
     normalised.reserve(stems.size());
     std::unordered_set<std::string> desiredNames;
@@ -100,55 +151,199 @@ void AudioRouter::setStemRules(const std::vector<StemRuleDefinition>& stems)
         ensureBusExists(stem.stemName);
     }
 
+    // Dropped buses are unlinked now and freed with the table that still points at them.
+    // Heuristic stems come back in publishRoutes if a loaded plugin still uses them.
+    using BusNode = std::map<juce::String, juce::AudioBuffer<float>>::node_type;
+    auto droppedBuses = std::make_shared<std::vector<BusNode>>();
     for (auto it = buses.begin(); it != buses.end();)
     {
         const auto lower = it->first.toLowerCase().toStdString();
-        if (lower != "master" && desiredNames.find(lower) == desiredNames.end())
-            it = buses.erase(it);
+        if (lower != "master" && desiredNames.find(lower) == desiredNames.end() && graphBuses.count(it->first) == 0)
+            droppedBuses->push_back(buses.extract(it++));
         else
             ++it;
     }
 
     stemDefinitions.swap(normalised);
+    publishRoutes([droppedBuses] { droppedBuses->clear(); });
 }
 
-const juce::AudioBuffer<float>* AudioRouter::getBusBuffer(const juce::String& busName) const
+void AudioRouter::setPluginSlots(const std::vector<juce::String>& pluginIds)
 {
-    auto it = buses.find(busName);
-    if (it == buses.end()) return nullptr;
-    return &it->second;
+    const juce::ScopedLock sl(writeLock);
+    pluginIdsBySlot = pluginIds;
+    publishRoutes();
 }
 
-std::map<juce::String, float> AudioRouter::calculateRmsPerBus(int numSamples) const
+void AudioRouter::publishRoutes(std::function<void()> alsoReclaim)
 {
-    std::map<juce::String, float> rmsValues;
-    if (numSamples <= 0)
-        return rmsValues;
+    auto next = std::make_unique<RouteTable>();
 
-    for (const auto& [name, buf] : buses)
+    // A bus that is routed to exists by the time the table is laid out below
+    auto busIndexFor = [this](const juce::String& busName)
     {
-        const int channelsToUse = buf.getNumChannels();
-        const int samplesToUse = juce::jmin(numSamples, buf.getNumSamples());
+        ensureBusExists(busName);
+        return indexForBus(busName);
+    };
 
-        if (channelsToUse == 0 || samplesToUse == 0)
-        {
-            rmsValues[name] = 0.0f;
+    next->destinations.push_back({ 0, 1.0f });
+
+    next->routesBySlot.resize(pluginIdsBySlot.size());
+    for (size_t slotIndex = 0; slotIndex < pluginIdsBySlot.size(); ++slotIndex)
+    {
+        const auto& pluginId = pluginIdsBySlot[slotIndex];
+        if (pluginId.isEmpty())
             continue;
+
+        static const TagSet empty;
+        auto tagsIt = tagsByPluginId.find(pluginId);
+        const TagSet& tags = tagsIt != tagsByPluginId.end() ? tagsIt->second : empty;
+        const auto stem = chooseStemBusFor(pluginId, tags);
+
+        auto& route = next->routesBySlot[slotIndex];
+        route.pluginId = pluginId;
+        route.stem = stem;
+        for (const auto& tag : tags)
+            route.tagList << (route.tagList.isEmpty() ? "" : ", ") << juce::String(tag);
+
+        route.firstDestination = (int) next->destinations.size();
+
+        // A graph bus reaches Master through its own output once its inserts have run
+        const bool viaGraphBus = stem.isNotEmpty() && stem != masterBusName() && graphBuses.count(stem) > 0;
+        if (!viaGraphBus)
+            next->destinations.push_back({ 0, 1.0f });
+
+        if (stem.isNotEmpty() && stem != masterBusName())
+            next->destinations.push_back({ busIndexFor(stem), 1.0f });
+
+        if (auto sends = sendsByPluginId.find(pluginId); sends != sendsByPluginId.end())
+        {
+            for (const auto& send : sends->second)
+                next->destinations.push_back({ busIndexFor(send.busName), send.gain });
         }
 
-        double sumSquares = 0.0;
-        for (int ch = 0; ch < channelsToUse; ++ch)
+        route.numDestinations = (int) next->destinations.size() - route.firstDestination;
+    }
+
+    // Every bus is in the table, and so cleared each block, routed to or not
+    for (const auto& [name, buf] : buses)
+        indexForBus(name);
+
+    next->busBuffers.resize(busIndices.size(), nullptr);
+    next->busMeterSlots.resize(busIndices.size(), -1);
+    for (auto& [name, buf] : buses)
+    {
+        const auto index = (size_t) indexForBus(name);
+        next->busBuffers[index] = &buf;
+        next->busMeterSlots[index] = meters.slotFor(name);
+    }
+
+    routes.publish(std::move(next), std::move(alsoReclaim));
+}
+
+int AudioRouter::indexForBus(const juce::String& busName)
+{
+    if (busName.isEmpty())
+        return -1;
+
+    return busIndices.emplace(busName, (int) busIndices.size()).first->second;
+}
+
+int AudioRouter::getBusIndex(const juce::String& busName)
+{
+    const juce::ScopedLock sl(writeLock);
+    return indexForBus(busName);
+}
+
+void AudioRouter::setBusGraph(const std::vector<juce::String>& graphBusNames,
+                              const std::unordered_map<juce::String, std::vector<SendDefinition>>& sends)
+{
+    const juce::ScopedLock sl(writeLock);
+    std::unordered_set<juce::String> fresh;
+    for (const auto& busName : graphBusNames)
+    {
+        if (busName.isEmpty() || busName == masterBusName())
+            continue;
+
+        fresh.insert(busName);
+        ensureBusExists(busName);
+    }
+
+    // Sends only ever target buses the graph evaluates, or their audio would go nowhere
+    std::unordered_map<juce::String, std::vector<SendDefinition>> validSends;
+    for (const auto& [pluginId, pluginSends] : sends)
+    {
+        for (const auto& send : pluginSends)
         {
-            const float* data = buf.getReadPointer(ch);
-            for (int i = 0; i < samplesToUse; ++i)
-                sumSquares += static_cast<double>(data[i]) * static_cast<double>(data[i]);
+            if (send.gain > 0.0f && fresh.count(send.busName) > 0)
+                validSends[pluginId].push_back(send);
         }
+    }
 
-        const double meanSquare = sumSquares / static_cast<double>(channelsToUse * samplesToUse);
-        rmsValues[name] = static_cast<float>(std::sqrt(meanSquare));
+    graphBuses.swap(fresh);
+    sendsByPluginId.swap(validSends);
+    publishRoutes();
+}
+
+juce::String AudioRouter::resolveBusName(const juce::String& busName) const
+{
+    const juce::ScopedLock sl(writeLock);
+    for (const auto& [name, buf] : buses)
+    {
+        if (name.equalsIgnoreCase(busName))
+            return name;
     }
 
-    return rmsValues;
+    for (const auto& stem : stemDefinitions)
+    {
+        if (stem.name.equalsIgnoreCase(busName))
+            return stem.name;
+    }
+
+    return busName;
+}
+
+juce::AudioBuffer<float>* AudioRouter::getBusForProcessing(int busIndex) const
+{
+    // A graph can name a bus added after the table it is evaluated against was published
+    const auto* table = routes.get();
+    if (table == nullptr || busIndex < 0 || busIndex >= (int) table->busBuffers.size())
+        return nullptr;
+
+    return table->busBuffers[(size_t) busIndex];
+}
+
+void AudioRouter::sumBusInto(juce::AudioBuffer<float>& source, int destinationBus, int numSamples)
+{
+    // If source is mono, the kernel duplicates it into channel 1 as well
+    if (auto* destination = getBusForProcessing(destinationBus))
+    {
+        const MixKernels::Destination target { destination->getArrayOfWritePointers(), destination->getNumChannels(), 1.0f };
+        MixKernels::accumulate(source.getArrayOfReadPointers(), source.getNumChannels(), &target, 1, numSamples);
+    }
+}
+
+const juce::AudioBuffer<float>* AudioRouter::getBusBuffer(const juce::String& busName) const
+{
+    const juce::ScopedLock sl(writeLock);
+    auto it = buses.find(busName);
+    if (it == buses.end()) return nullptr;
+    return &it->second;
+}
+
+void AudioRouter::measureBuses(int numSamples)
+{
+    const auto* table = routes.get();
+    if (numSamples <= 0 || table == nullptr)
+        return;
+
+    for (size_t bus = 0; bus < table->busBuffers.size(); ++bus)
+    {
+        if (table->busBuffers[bus] != nullptr)
+            meters.measure(table->busMeterSlots[bus], *table->busBuffers[bus], numSamples);
+    }
+
+    meters.endBlock(numSamples);
 }
 
 AudioRouter::TagSet AudioRouter::normaliseTags(const std::vector<juce::String>& tags)
@@ -212,23 +407,6 @@ void AudioRouter::ensureBusExists(const juce::String& busName)
     buses.emplace(busName, std::move(buf));
 }
 
-void AudioRouter::addToBus(const juce::String& busName,
-                           const juce::AudioBuffer<float>& src,
-                           int numSamples)
-{
-    ensureBusExists(busName);
-
-    auto& dst = buses[busName];
-
-    const int copyChannels = juce::jmin(dst.getNumChannels(), src.getNumChannels());
-    for (int ch = 0; ch < copyChannels; ++ch)
-        dst.addFrom(ch, 0, src, ch, 0, numSamples);
-
-    // If src is mono, duplicate into remaining channels (optional but handy)
-    if (src.getNumChannels() == 1 && dst.getNumChannels() >= 2)
-        dst.addFrom(1, 0, src, 0, 0, numSamples);
-}
-
 void AudioRouter::setRenderDebugEnabled(bool enabled)
 {
     renderDebugEnabled = enabled;
@@ -236,18 +414,8 @@ void AudioRouter::setRenderDebugEnabled(bool enabled)
         renderDebugLoggedPlugins.clear();
 }
 
-void AudioRouter::logRenderMatch(const juce::String& pluginInstanceId, const TagSet& tags, const juce::String& stemName)
+void AudioRouter::logRenderMatch(const juce::String& pluginInstanceId, const juce::String& tagList, const juce::String& stemName)
 {
-    juce::String tagList;
-    bool first = true;
-    for (const auto& tag : tags)
-    {
-        if (!first)
-            tagList += ", ";
-        first = false;
-        tagList += juce::String(tag);
-    }
-
     juce::String stemLabel = stemName.isNotEmpty() ? stemName : "Master";
     DBG("Render Routing: " + pluginInstanceId + " -> " + stemLabel + " tags=[" + tagList + "]");
 }
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "BusMeters.h"
+#include "MixKernels.h"
+#include "RcuDomain.h"
 #include <unordered_map>
 #include <unordered_set>
 #include <map>
@@ -13,7 +16,9 @@ struct InstrumentInfo;
 class AudioRouter
 {
 public:
-    AudioRouter() = default;
+    // Route tables are published in routeDomain; the audio thread reads them inside one of
+    // its ReadScopes
+    explicit AudioRouter(RcuDomain& routeDomain);
 
     struct StemRuleDefinition
     {
@@ -21,14 +26,21 @@ public:
         std::vector<std::vector<juce::String>> matchRules; // each rule is a list of required tags
     };
 
+    struct SendDefinition
+    {
+        juce::String busName; // return bus
+        float gain = 0.0f;
+    };
+
     // Call once when audio engine starts / sample rate changes
     void prepare(double sampleRate, int maxBlockSize, int numChannels);
 
     // Call at start of each audio block (audio thread)
     void beginBlock(int numSamples);
 
-    // Call once per rendered plugin buffer (audio thread)
-    void routeAudio(const juce::String& pluginInstanceId,
+    // Call once per rendered plugin buffer (audio thread). Only indexes the compiled route
+    // table; a slot with no route goes to Master.
+    void routeAudio(int pluginSlotIndex,
                     const juce::AudioBuffer<float>& pluginAudio,
                     int numSamples);
     void setRenderDebugEnabled(bool enabled);
@@ -36,11 +48,32 @@ public:
     // Non-audio thread: rebuild tags lookup from orchestra data
     void rebuildTagIndex(const std::vector<InstrumentInfo>& orchestra);
     void setStemRules(const std::vector<StemRuleDefinition>& stems);
+    // Non-audio thread: plugin id per slot index (empty when free), as the plugin graph has them
+    void setPluginSlots(const std::vector<juce::String>& pluginIdsBySlot);
+    // Non-audio thread: buses that are nodes of the bus graph (inserts, their own output, or
+    // returns). A plugin whose stem is one of these feeds it instead of Master; everything
+    // else still goes straight to Master as well as to its stem.
+    void setBusGraph(const std::vector<juce::String>& graphBusNames,
+                     const std::unordered_map<juce::String, std::vector<SendDefinition>>& sends);
+
+    // Existing bus or stem whose name matches ignoring case, else the name unchanged
+    juce::String resolveBusName(const juce::String& busName) const;
+
+    // Non-audio thread: the bus's index, which it keeps for as long as the router lives, even
+    // while the bus itself does not exist. Master is 0; -1 for an empty name.
+    int getBusIndex(const juce::String& busName);
+
+    // Audio thread, while evaluating the bus graph. Null for an index with no bus behind it.
+    juce::AudioBuffer<float>* getBusForProcessing(int busIndex) const;
+    void sumBusInto(juce::AudioBuffer<float>& source, int destinationBus, int numSamples);
+
+    // Audio thread, once the bus graph has run: feeds every bus to its meter
+    void measureBuses(int numSamples);
+    // Any non-audio thread; reads the latest meter snapshot, never the buses
+    std::vector<BusMeters::Reading> getMeterReadings() const { return meters.getReadings(); }
 
     // Optional: expose buses for downstream recorder/debug (non-audio thread use)
     const juce::AudioBuffer<float>* getBusBuffer(const juce::String& busName) const;
-    const std::map<juce::String, juce::AudioBuffer<float>>& getAllBuses() const { return buses; }
-    std::map<juce::String, float> calculateRmsPerBus(int numSamples) const;
 
 private:
     using TagSet = std::unordered_set<std::string>;
@@ -50,6 +83,33 @@ private:
         std::vector<TagSet> rules;
     };
 
+    // Everything routeAudio needs, compiled off the audio thread whenever tags, stem rules,
+    // the bus graph or the plugin slots change. Bus buffers stay put until the table that
+    // points at them has been reclaimed.
+    struct RouteTable
+    {
+        struct Destination
+        {
+            int bus = 0;
+            float gain = 1.0f;
+        };
+
+        struct SlotRoute
+        {
+            int firstDestination = 0;
+            int numDestinations = 1;      // the default is Master alone
+            juce::String pluginId;        // for render debug logging
+            juce::String stem;
+            juce::String tagList;
+        };
+
+        // By bus index, index 0 being Master; null for the index of a bus that is gone
+        std::vector<juce::AudioBuffer<float>*> busBuffers;
+        std::vector<int> busMeterSlots;                     // -1 when unmetered
+        std::vector<Destination> destinations;              // entry 0 is Master at unity
+        std::vector<SlotRoute> routesBySlot;
+    };
+
     // ===== Routing policy (temporary MVP) =====
     // Later we’ll replace this with match rules.
     juce::String chooseStemBusFor(const juce::String& pluginInstanceId, const TagSet& tags) const;
@@ -57,11 +117,12 @@ private:
     static TagSet normaliseTags(const std::vector<juce::String>& tags);
 
     void ensureBusExists(const juce::String& busName);
+    // Caller holds writeLock. alsoReclaim runs once no reader can see the previous table.
+    void publishRoutes(std::function<void()> alsoReclaim = {});
+    // Caller holds writeLock
+    int indexForBus(const juce::String& busName);
 
-    void addToBus(const juce::String& busName,
-                  const juce::AudioBuffer<float>& src,
-                  int numSamples);
-    void logRenderMatch(const juce::String& pluginInstanceId, const TagSet& tags, const juce::String& stemName);
+    void logRenderMatch(const juce::String& pluginInstanceId, const juce::String& tagList, const juce::String& stemName);
 
 private:
     double sr = 0.0;
@@ -71,11 +132,20 @@ private:
     bool renderDebugEnabled = false;
     std::unordered_set<std::string> renderDebugLoggedPlugins;
 
-    // Buses (audio thread writes into these each block)
+    // Buses (audio thread writes into these each block, through the route table)
     std::map<juce::String, juce::AudioBuffer<float>> buses;
+    std::unordered_map<juce::String, int> busIndices;   // guarded by writeLock, only grows
 
-    // Tag lookup (rebuilt on non-audio thread, read on audio thread)
-    // For MVP we accept eventual consistency: tags update between blocks.
+    // Routing inputs, written on non-audio threads under writeLock and compiled into routes
+    mutable juce::CriticalSection writeLock;
     std::unordered_map<juce::String, TagSet> tagsByPluginId;
     std::vector<StemDefinition> stemDefinitions;
+    std::vector<juce::String> pluginIdsBySlot;
+
+    // Bus graph nodes and per-plugin sends, set with setBusGraph
+    std::unordered_set<juce::String> graphBuses;
+    std::unordered_map<juce::String, std::vector<SendDefinition>> sendsByPluginId;
+
+    BusMeters meters;
+    RcuSnapshot<RouteTable> routes;
 };
@@ -0,0 +1,103 @@
+#include "AudioThreadAllocationGuard.h"
+
+#if OSCDAW_AUDIO_ALLOCATION_GUARD
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    // Plain ints so the first touch from inside operator new never needs dynamic initialisation
+    thread_local int realtimeDepth = 0;
+    thread_local int allowDepth = 0;
+    std::atomic<juce::uint64> allocationCount{ 0 };
+
+    void* allocate(std::size_t size)
+    {
+        if (realtimeDepth > 0 && allowDepth == 0)
+            allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+        if (size == 0)
+            size = 1;
+
+        for (;;)
+        {
+            if (auto* ptr = std::malloc(size))
+                return ptr;
+
+            auto handler = std::get_new_handler();
+            if (handler == nullptr)
+                throw std::bad_alloc();
+            handler();
+        }
+    }
+}
+
+namespace AudioThreadAllocationGuard
+{
+    ScopedRealtimeSection::ScopedRealtimeSection()
+    {
+        if (realtimeDepth++ == 0)
+            countOnEntry = allocationCount.load(std::memory_order_relaxed);
+    }
+
+    ScopedRealtimeSection::~ScopedRealtimeSection()
+    {
+        if (--realtimeDepth == 0)
+        {
+           #if OSCDAW_AUDIO_ALLOCATION_GUARD_ASSERTS
+            // Something on the callback thread allocated; break here and walk back to it
+            jassert(allocationCount.load(std::memory_order_relaxed) == countOnEntry);
+           #endif
+        }
+    }
+
+    ScopedAllowAllocation::ScopedAllowAllocation()
+    {
+        ++allowDepth;
+    }
+
+    ScopedAllowAllocation::~ScopedAllowAllocation()
+    {
+        --allowDepth;
+    }
+
+    juce::uint64 getAllocationCount()
+    {
+        return allocationCount.load(std::memory_order_relaxed);
+    }
+}
+
+// Global replacements. The nothrow forms forward to these; aligned new keeps its own pairing
+void* operator new(std::size_t size)
+{
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return allocate(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+#endif
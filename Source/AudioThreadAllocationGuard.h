@@ -0,0 +1,57 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Debug-build check that the audio callback stays allocation free. While a
+// ScopedRealtimeSection is alive on a thread, every global operator new made on that
+// thread is counted. Code we do not control (plugin processBlock) opts out with
+// ScopedAllowAllocation. In release builds this all compiles away and the count stays 0.
+#ifndef OSCDAW_AUDIO_ALLOCATION_GUARD
+ #define OSCDAW_AUDIO_ALLOCATION_GUARD JUCE_DEBUG
+#endif
+
+// Set to 1 to hit a jassert when a realtime section that allocated is left
+#ifndef OSCDAW_AUDIO_ALLOCATION_GUARD_ASSERTS
+ #define OSCDAW_AUDIO_ALLOCATION_GUARD_ASSERTS 0
+#endif
+
+namespace AudioThreadAllocationGuard
+{
+#if OSCDAW_AUDIO_ALLOCATION_GUARD
+    class ScopedRealtimeSection
+    {
+    public:
+        ScopedRealtimeSection();
+        ~ScopedRealtimeSection();
+
+    private:
+        juce::uint64 countOnEntry = 0;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedRealtimeSection)
+    };
+
+    class ScopedAllowAllocation
+    {
+    public:
+        ScopedAllowAllocation();
+        ~ScopedAllowAllocation();
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedAllowAllocation)
+    };
+
+    // Total allocations seen inside realtime sections since startup
+    juce::uint64 getAllocationCount();
+#else
+    struct ScopedRealtimeSection
+    {
+        ScopedRealtimeSection() {}
+    };
+
+    struct ScopedAllowAllocation
+    {
+        ScopedAllowAllocation() {}
+    };
+
+    inline juce::uint64 getAllocationCount() { return 0; }
+#endif
+}
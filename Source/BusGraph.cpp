@@ -0,0 +1,137 @@
+#include "BusGraph.h"
+#include <algorithm>
+
+const juce::String& BusGraph::masterName()
+{
+    static const juce::String name("Master");
+    return name;
+}
+
+std::vector<BusGraph::Node> BusGraph::compile(const std::vector<BusDefinition>& definitions)
+{
+    std::vector<Node> nodes;
+    Node master;
+    master.name = masterName();
+
+    for (const auto& definition : definitions)
+    {
+        const auto name = definition.name.trim();
+        if (name.isEmpty())
+            continue;
+
+        if (name.equalsIgnoreCase(masterName()))
+        {
+            if (master.inserts.empty())
+                master.inserts = definition.inserts;
+            continue;
+        }
+
+        const bool duplicate = std::any_of(nodes.begin(), nodes.end(),
+                                           [&name](const Node& existing) { return existing.name.equalsIgnoreCase(name); });
+        if (duplicate)
+            continue;
+
+        Node node;
+        node.name = name;
+        node.output = definition.output.trim();
+        node.inserts = definition.inserts;
+        node.isReturn = definition.isReturn;
+        nodes.push_back(std::move(node));
+    }
+
+    // Resolve outputs to indices; -1 is Master
+    const int numNodes = (int) nodes.size();
+    std::vector<int> outputs((size_t) numNodes, -1);
+    for (int i = 0; i < numNodes; ++i)
+    {
+        auto& node = nodes[(size_t) i];
+        if (node.output.isEmpty() || node.output.equalsIgnoreCase(masterName()))
+            continue;
+
+        for (int j = 0; j < numNodes; ++j)
+        {
+            if (j != i && nodes[(size_t) j].name.equalsIgnoreCase(node.output))
+            {
+                outputs[(size_t) i] = j;
+                break;
+            }
+        }
+
+        if (outputs[(size_t) i] < 0)
+            DBG("BusGraph: " << node.name << " outputs to unknown bus " << node.output << ", using Master");
+    }
+
+    // Break cycles where the walk along outputs first comes back on itself
+    std::vector<int> state((size_t) numNodes, 0); // 0 = unseen, 1 = on the current walk, 2 = done
+    for (int start = 0; start < numNodes; ++start)
+    {
+        std::vector<int> walk;
+        for (int current = start; current >= 0 && state[(size_t) current] != 2;)
+        {
+            if (state[(size_t) current] == 1)
+            {
+                const int last = walk.back();
+                DBG("BusGraph: " << nodes[(size_t) last].name << " -> " << nodes[(size_t) current].name
+                                 << " closes a cycle, using Master");
+                outputs[(size_t) last] = -1;
+                break;
+            }
+
+            state[(size_t) current] = 1;
+            walk.push_back(current);
+            current = outputs[(size_t) current];
+        }
+
+        for (auto index : walk)
+            state[(size_t) index] = 2;
+    }
+
+    // A bus sits one level above the deepest bus feeding it; the graph is acyclic now, so
+    // this settles within numNodes passes
+    std::vector<int> levels((size_t) numNodes, 0);
+    for (int pass = 0; pass < numNodes; ++pass)
+    {
+        bool changed = false;
+        for (int i = 0; i < numNodes; ++i)
+        {
+            const int output = outputs[(size_t) i];
+            if (output >= 0 && levels[(size_t) output] <= levels[(size_t) i])
+            {
+                levels[(size_t) output] = levels[(size_t) i] + 1;
+                changed = true;
+            }
+        }
+
+        if (!changed)
+            break;
+    }
+
+    int masterLevel = 0;
+    for (int i = 0; i < numNodes; ++i)
+    {
+        auto& node = nodes[(size_t) i];
+        node.level = levels[(size_t) i];
+        node.output = outputs[(size_t) i] >= 0 ? nodes[(size_t) outputs[(size_t) i]].name : masterName();
+        masterLevel = juce::jmax(masterLevel, node.level + 1);
+    }
+
+    std::stable_sort(nodes.begin(), nodes.end(),
+                     [](const Node& a, const Node& b) { return a.level < b.level; });
+
+    master.level = masterLevel;
+    nodes.push_back(std::move(master));
+    return nodes;
+}
+
+std::vector<int> BusGraph::levelStarts(const std::vector<Node>& nodes)
+{
+    std::vector<int> starts;
+    for (int i = 0; i < (int) nodes.size(); ++i)
+    {
+        if (i == 0 || nodes[(size_t) i].level != nodes[(size_t) i - 1].level)
+            starts.push_back(i);
+    }
+
+    starts.push_back((int) nodes.size());
+    return starts;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+// One bus the processing graph knows about beyond a plain stem tap: a stem with an insert
+// chain or its own output, a return fed by sends, or Master's inserts.
+struct BusDefinition
+{
+    juce::String name;
+    juce::String output = "Master";     // bus this one sums into; ignored for Master
+    std::vector<juce::String> inserts;  // plugin instance ids, processed in order
+    bool isReturn = false;
+};
+
+// Compiles bus definitions into processing order. Every bus comes after all of the buses
+// that feed it, and buses are grouped into levels that do not feed each other, so a level
+// can be spread across threads. Master is always the last node, alone in the last level.
+class BusGraph
+{
+public:
+    struct Node
+    {
+        juce::String name;
+        juce::String output;                // empty for Master
+        std::vector<juce::String> inserts;
+        bool isReturn = false;
+        int level = 0;
+    };
+
+    static const juce::String& masterName();
+
+    // Non-audio thread. Duplicate names keep the first definition; outputs naming an unknown
+    // bus, or closing a cycle, are sent to Master instead.
+    static std::vector<Node> compile(const std::vector<BusDefinition>& definitions);
+
+    // Index of the first node of each level in compiled order, followed by nodes.size()
+    static std::vector<int> levelStarts(const std::vector<Node>& nodes);
+};
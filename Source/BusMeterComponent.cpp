@@ -0,0 +1,97 @@
+#include "BusMeterComponent.h"
+
+namespace
+{
+    constexpr int kRefreshHz = 30;
+    constexpr float kRangeDb = 60.0f;
+    constexpr float kPeakFallDbPerSecond = 20.0f;
+    constexpr int kRowHeight = 22;
+    constexpr int kNameWidth = 70;
+    constexpr int kLoudnessWidth = 76;
+}
+
+BusMeterComponent::BusMeterComponent(const AudioRouter& routerToMeter)
+    : router(routerToMeter)
+{
+    setOpaque(false);
+    startTimerHz(kRefreshHz);
+}
+
+BusMeterComponent::~BusMeterComponent()
+{
+    stopTimer();
+}
+
+void BusMeterComponent::timerCallback()
+{
+    const auto readings = router.getMeterReadings();
+    const float fall = kPeakFallDbPerSecond / (float) kRefreshHz;
+
+    std::vector<DisplayedMeter> next;
+    next.reserve(readings.size());
+    for (const auto& reading : readings)
+    {
+        DisplayedMeter meter;
+        meter.reading = reading;
+        meter.heldPeakDb = reading.peakDb;
+
+        // Peaks fall back slowly so short transients stay visible between refreshes
+        for (const auto& previous : meters)
+        {
+            if (previous.reading.name == reading.name)
+            {
+                meter.heldPeakDb = juce::jmax(reading.peakDb, previous.heldPeakDb - fall);
+                break;
+            }
+        }
+        next.push_back(std::move(meter));
+    }
+
+    meters.swap(next);
+    repaint();
+}
+
+void BusMeterComponent::paint(juce::Graphics& g)
+{
+    auto bounds = getLocalBounds();
+    g.setFont(12.0f);
+
+    if (meters.empty())
+    {
+        g.setColour(juce::Colours::grey);
+        g.drawText("No audio", bounds, juce::Justification::centredTop);
+        return;
+    }
+
+    auto proportionOf = [](float db)
+    {
+        return juce::jlimit(0.0f, 1.0f, (db + kRangeDb) / kRangeDb);
+    };
+
+    for (const auto& meter : meters)
+    {
+        if (bounds.getHeight() < kRowHeight)
+            break;
+
+        auto row = bounds.removeFromTop(kRowHeight).reduced(0, 3);
+        g.setColour(juce::Colours::white);
+        g.drawText(meter.reading.name, row.removeFromLeft(kNameWidth), juce::Justification::centredLeft, true);
+
+        const auto loudnessText = meter.reading.shortTermLufs > BusMeters::kFloorDb
+                                      ? juce::String(meter.reading.shortTermLufs, 1) + " LUFS"
+                                      : juce::String("-inf");
+        g.drawText(loudnessText, row.removeFromRight(kLoudnessWidth), juce::Justification::centredRight, false);
+
+        auto bar = row.reduced(4, 2).toFloat();
+        g.setColour(juce::Colours::darkgrey);
+        g.fillRect(bar);
+
+        const float rmsWidth = bar.getWidth() * proportionOf(meter.reading.rmsDb);
+        g.setColour(meter.heldPeakDb >= 0.0f ? juce::Colours::red : juce::Colours::green);
+        g.fillRect(bar.withWidth(rmsWidth));
+
+        const float peakX = bar.getX() + bar.getWidth() * proportionOf(meter.heldPeakDb);
+        g.setColour(juce::Colours::yellow);
+        g.fillRect(juce::Rectangle<float>(peakX - 1.0f, bar.getY(), 2.0f, bar.getHeight()));
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include "AudioRouter.h"
+
+// One horizontal meter per bus: RMS bar, falling peak marker and short-term loudness.
+// Polls the router's meter snapshot on the message thread; never touches audio buffers.
+class BusMeterComponent : public juce::Component,
+                          private juce::Timer
+{
+public:
+    explicit BusMeterComponent(const AudioRouter& routerToMeter);
+    ~BusMeterComponent() override;
+
+    void paint(juce::Graphics& g) override;
+
+private:
+    void timerCallback() override;
+
+    struct DisplayedMeter
+    {
+        BusMeters::Reading reading;
+        float heldPeakDb = BusMeters::kFloorDb;
+    };
+
+    const AudioRouter& router;
+    std::vector<DisplayedMeter> meters;
+};
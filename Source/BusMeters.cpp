@@ -0,0 +1,241 @@
+#include "BusMeters.h"
+#include "MixKernels.h"
+#include <cmath>
+
+namespace
+{
+    constexpr double kWindowSeconds = 0.1;
+    constexpr int kMaxReadAttempts = 8;
+
+    // ITU-R BS.1770 K-weighting, prewarped for any sample rate so that at 48 kHz it gives the
+    // coefficients printed in the standard: a high shelf for the head, then a high pass
+    constexpr double kShelfFrequency = 1681.974450955533;
+    constexpr double kShelfGainDb = 3.999843853973347;
+    constexpr double kShelfQ = 0.7071752369554196;
+    constexpr double kShelfBandExponent = 0.4996667741545416;
+    constexpr double kHighPassFrequency = 38.13547087602444;
+    constexpr double kHighPassQ = 0.5003270373238773;
+}
+
+BusMeters::BusMeters()
+{
+    prepare(48000.0);
+}
+
+void BusMeters::prepare(double sampleRate)
+{
+    jassert(sampleRate > 0.0);
+
+    {
+        const double k = std::tan(juce::MathConstants<double>::pi * kShelfFrequency / sampleRate);
+        const double vh = std::pow(10.0, kShelfGainDb / 20.0);
+        const double vb = std::pow(vh, kShelfBandExponent);
+        const double a0 = 1.0 + k / kShelfQ + k * k;
+
+        highShelf.b0 = (vh + vb * k / kShelfQ + k * k) / a0;
+        highShelf.b1 = 2.0 * (k * k - vh) / a0;
+        highShelf.b2 = (vh - vb * k / kShelfQ + k * k) / a0;
+        highShelf.a1 = 2.0 * (k * k - 1.0) / a0;
+        highShelf.a2 = (1.0 - k / kShelfQ + k * k) / a0;
+    }
+
+    {
+        const double k = std::tan(juce::MathConstants<double>::pi * kHighPassFrequency / sampleRate);
+        const double a0 = 1.0 + k / kHighPassQ + k * k;
+
+        highPass.b0 = 1.0;
+        highPass.b1 = -2.0;
+        highPass.b2 = 1.0;
+        highPass.a1 = 2.0 * (k * k - 1.0) / a0;
+        highPass.a2 = (1.0 - k / kHighPassQ + k * k) / a0;
+    }
+
+    windowLength = juce::jmax<juce::int64>(1, (juce::int64) std::llround(sampleRate * kWindowSeconds));
+    windowSamples = 0;
+    for (auto& state : states)
+        state = MeterState();
+
+    for (auto& frame : frames)
+    {
+        for (auto& meter : frame)
+            meter.active.store(false, std::memory_order_relaxed);
+    }
+    sequence.fetch_add(2, std::memory_order_release);
+
+    const juce::ScopedLock sl(namesLock);
+    slotsByName.clear();
+    for (auto& name : namesBySlot)
+        name = {};
+}
+
+int BusMeters::slotFor(const juce::String& busName)
+{
+    const juce::ScopedLock sl(namesLock);
+    if (auto it = slotsByName.find(busName); it != slotsByName.end())
+        return it->second;
+
+    const int slot = (int) slotsByName.size();
+    if (slot >= kMaxMeters)
+    {
+        DBG("BusMeters: no meter left for bus " << busName);
+        return -1;
+    }
+
+    slotsByName.emplace(busName, slot);
+    namesBySlot[(size_t) slot] = busName;
+    return slot;
+}
+
+double BusMeters::kWeight(MeterState& state, int channel, double sample) const
+{
+    // Two transposed direct form II stages
+    auto& z = state.filterState[(size_t) channel];
+
+    const double shelved = highShelf.b0 * sample + z[0];
+    z[0] = highShelf.b1 * sample - highShelf.a1 * shelved + z[1];
+    z[1] = highShelf.b2 * sample - highShelf.a2 * shelved;
+
+    const double weighted = highPass.b0 * shelved + z[2];
+    z[2] = highPass.b1 * shelved - highPass.a1 * weighted + z[3];
+    z[3] = highPass.b2 * shelved - highPass.a2 * weighted;
+    return weighted;
+}
+
+void BusMeters::measure(int slot, const juce::AudioBuffer<float>& bus, int numSamples)
+{
+    if (slot < 0 || slot >= kMaxMeters || numSamples <= 0)
+        return;
+
+    auto& state = states[(size_t) slot];
+    const int numChannels = bus.getNumChannels();
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const float* samples = bus.getReadPointer(ch);
+        const auto stats = MixKernels::measure(samples, numSamples);
+        state.windowPeak = juce::jmax(state.windowPeak, stats.peak);
+        state.windowSquares += stats.sumOfSquares;
+
+        // The K-weighting filters are recursive, so this part stays scalar
+        if (ch < kMaxLoudnessChannels)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const double weighted = kWeight(state, ch, samples[i]);
+                state.windowWeightedSquares += weighted * weighted;
+            }
+        }
+    }
+
+    state.windowChannels = numChannels;
+    state.measuredThisWindow = true;
+}
+
+void BusMeters::endBlock(int numSamples)
+{
+    windowSamples += numSamples;
+    if (windowSamples >= windowLength)
+    {
+        publishWindow();
+        windowSamples = 0;
+    }
+}
+
+void BusMeters::publishWindow()
+{
+    const auto next = sequence.load(std::memory_order_relaxed) + 1;
+    auto& frame = frames[(size_t) (next & 1)];
+
+    for (int slot = 0; slot < kMaxMeters; ++slot)
+    {
+        auto& state = states[(size_t) slot];
+        auto& meter = frame[(size_t) slot];
+        if (!state.measuredThisWindow)
+        {
+            // A bus that went away starts its loudness afresh if it comes back
+            state = MeterState();
+            meter.active.store(false, std::memory_order_relaxed);
+            continue;
+        }
+
+        const double channelSamples = (double) windowSamples * (double) juce::jmax(1, state.windowChannels);
+        const float rms = (float) std::sqrt(state.windowSquares / channelSamples);
+
+        state.loudnessEnergy[(size_t) state.loudnessIndex] = state.windowWeightedSquares;
+        state.loudnessSamples[(size_t) state.loudnessIndex] = windowSamples;
+        state.loudnessIndex = (state.loudnessIndex + 1) % MeterState::kLoudnessWindows;
+
+        double energy = 0.0;
+        juce::int64 samples = 0;
+        for (int i = 0; i < MeterState::kLoudnessWindows; ++i)
+        {
+            energy += state.loudnessEnergy[(size_t) i];
+            samples += state.loudnessSamples[(size_t) i];
+        }
+        const float lufs = energy > 0.0 && samples > 0
+                               ? (float) juce::jmax((double) kFloorDb, -0.691 + 10.0 * std::log10(energy / (double) samples))
+                               : kFloorDb;
+
+        meter.peak.store(state.windowPeak, std::memory_order_relaxed);
+        meter.rms.store(rms, std::memory_order_relaxed);
+        meter.shortTermLufs.store(lufs, std::memory_order_relaxed);
+        meter.active.store(true, std::memory_order_relaxed);
+
+        state.windowPeak = 0.0f;
+        state.windowSquares = 0.0;
+        state.windowWeightedSquares = 0.0;
+        state.measuredThisWindow = false;
+    }
+
+    sequence.store(next, std::memory_order_release);
+}
+
+std::vector<BusMeters::Reading> BusMeters::getReadings() const
+{
+    std::array<juce::String, kMaxMeters> names;
+    {
+        const juce::ScopedLock sl(namesLock);
+        names = namesBySlot;
+    }
+
+    struct Values
+    {
+        float peak, rms, lufs;
+        bool active;
+    };
+    std::array<Values, kMaxMeters> values{};
+
+    // Retry if the audio thread moved on to rewriting the frame being copied
+    for (int attempt = 0; attempt < kMaxReadAttempts; ++attempt)
+    {
+        const auto before = sequence.load(std::memory_order_acquire);
+        const auto& frame = frames[(size_t) (before & 1)];
+        for (int slot = 0; slot < kMaxMeters; ++slot)
+        {
+            const auto& meter = frame[(size_t) slot];
+            values[(size_t) slot] = { meter.peak.load(std::memory_order_relaxed),
+                                      meter.rms.load(std::memory_order_relaxed),
+                                      meter.shortTermLufs.load(std::memory_order_relaxed),
+                                      meter.active.load(std::memory_order_relaxed) };
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == before)
+            break;
+    }
+
+    std::vector<Reading> readings;
+    for (int slot = 0; slot < kMaxMeters; ++slot)
+    {
+        const auto& value = values[(size_t) slot];
+        if (!value.active || names[(size_t) slot].isEmpty())
+            continue;
+
+        Reading reading;
+        reading.name = names[(size_t) slot];
+        reading.peakDb = juce::Decibels::gainToDecibels(value.peak, kFloorDb);
+        reading.rmsDb = juce::Decibels::gainToDecibels(value.rms, kFloorDb);
+        reading.shortTermLufs = value.lufs;
+        readings.push_back(std::move(reading));
+    }
+    return readings;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <map>
+#include <vector>
+
+// Peak, RMS and short-term loudness per bus, measured incrementally in the audio callback.
+// Values are gathered over windows of about 100 ms; at the end of each window the audio
+// thread writes every meter into the back half of a double buffer and flips it with one
+// atomic store. Readers copy the front half at their own rate and never touch audio buffers.
+class BusMeters
+{
+public:
+    static constexpr int kMaxMeters = 64;
+    static constexpr int kMaxLoudnessChannels = 8;
+    static constexpr float kFloorDb = -120.0f;
+
+    struct Reading
+    {
+        juce::String name;
+        float peakDb = kFloorDb;
+        float rmsDb = kFloorDb;
+        float shortTermLufs = kFloorDb;   // K-weighted, over the last 3 s or so
+    };
+
+    BusMeters();
+
+    // Non-audio thread, with the audio callback stopped: resets every meter and frees the names
+    void prepare(double sampleRate);
+
+    // Non-audio thread: meter slot for a bus name, kept until the next prepare. -1 once
+    // every slot is taken.
+    int slotFor(const juce::String& busName);
+
+    // Audio thread: measure each bus once per block, then end the block
+    void measure(int slot, const juce::AudioBuffer<float>& bus, int numSamples);
+    void endBlock(int numSamples);
+
+    // Any non-audio thread. Buses measured in the last window, in slot order.
+    std::vector<Reading> getReadings() const;
+
+private:
+    struct Biquad
+    {
+        double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+    };
+
+    // Audio thread only
+    struct MeterState
+    {
+        std::array<std::array<double, 4>, kMaxLoudnessChannels> filterState{}; // z1, z2 per K-weighting stage
+        float windowPeak = 0.0f;
+        double windowSquares = 0.0;
+        double windowWeightedSquares = 0.0;  // summed over channels, as loudness wants
+        int windowChannels = 0;
+        bool measuredThisWindow = false;
+
+        static constexpr int kLoudnessWindows = 30;
+        std::array<double, kLoudnessWindows> loudnessEnergy{};
+        std::array<juce::int64, kLoudnessWindows> loudnessSamples{};
+        int loudnessIndex = 0;
+    };
+
+    struct alignas(64) PublishedMeter
+    {
+        std::atomic<float> peak{ 0.0f };
+        std::atomic<float> rms{ 0.0f };
+        std::atomic<float> shortTermLufs{ kFloorDb };
+        std::atomic<bool> active{ false };
+    };
+
+    using Frame = std::array<PublishedMeter, kMaxMeters>;
+
+    void publishWindow();
+    double kWeight(MeterState& state, int channel, double sample) const;
+
+    Biquad highShelf, highPass;
+    juce::int64 windowLength = 4800;
+    juce::int64 windowSamples = 0;
+    std::array<MeterState, kMaxMeters> states;
+
+    // Written by the audio thread: frames[sequence & 1] is complete, the other is being written
+    std::array<Frame, 2> frames;
+    std::atomic<juce::uint64> sequence{ 0 };
+
+    mutable juce::CriticalSection namesLock;
+    std::map<juce::String, int> slotsByName;
+    std::array<juce::String, kMaxMeters> namesBySlot;
+
+    JUCE_DECLARE_NON_COPYABLE(BusMeters)
+};
@@ -1,5 +1,9 @@
 #include "Conductor.h"
 #include "MainComponent.h"
+#include "MixKernels.h"
+#include "OscCommands.h"
+#include <array>
+#include <chrono>
 #include <cstdio>
 #include <cmath>
 
@@ -20,46 +24,32 @@ namespace
 		return true;
 	}
 
-	bool ensureIntOSCArgument(const juce::OSCMessage &message, int index, const char *context)
+	// Decimal seconds ("1712345678.123456") or integer microseconds ("1712345678123456us").
+	// Whole and fractional seconds are parsed separately so epoch-sized values keep every digit.
+	juce::int64 parseTimestampStringMicros(const juce::String &text)
 	{
-		if (index >= 0 && index < message.size() && message[index].isInt32())
-			return true;
+		auto trimmed = text.trim();
+		if (trimmed.endsWithIgnoreCase("us"))
+			return trimmed.dropLastCharacters(2).trim().getLargeIntValue();
 
-#if JUCE_DEBUG
-		char buffer[256];
-		std::snprintf(buffer, sizeof(buffer), "OSC %s argument %d expected Int32", context, index);
-		std::fprintf(stderr, "%s\n", buffer);
-#endif
-		return false;
-	}
+		if (!trimmed.containsOnly("+-0123456789."))
+			return static_cast<juce::int64>(std::llround(trimmed.getDoubleValue() * 1.0e6));
 
-	bool ensureStringOSCArgument(const juce::OSCMessage &message, int index, const char *context)
-	{
-		if (index >= 0 && index < message.size() && message[index].isString())
-			return true;
+		const bool negative = trimmed.startsWithChar('-');
+		if (negative || trimmed.startsWithChar('+'))
+			trimmed = trimmed.substring(1);
 
-#if JUCE_DEBUG
-		char buffer[256];
-		std::snprintf(buffer, sizeof(buffer), "OSC %s argument %d expected String", context, index);
-		std::fprintf(stderr, "%s\n", buffer);
-#endif
-		return false;
-	}
+		const juce::int64 wholeSeconds = trimmed.upToFirstOccurrenceOf(".", false, false).getLargeIntValue();
+		const juce::String fraction = trimmed.fromFirstOccurrenceOf(".", false, false).retainCharacters("0123456789");
 
-	bool ensureTimestampOSCArgument(const juce::OSCMessage &message, int index, const char *context)
-	{
-		if (index >= 0 && index < message.size())
-		{
-			if (message[index].isString() || message[index].isInt32() || message[index].isFloat32())
-				return true;
-		}
+		juce::int64 micros = 0;
+		for (int digit = 0; digit < 6; ++digit)
+			micros = micros * 10 + (digit < fraction.length() ? fraction[digit] - '0' : 0);
+		if (fraction.length() > 6 && fraction[6] >= '5')
+			++micros;
 
-#if JUCE_DEBUG
-		char buffer[256];
-		std::snprintf(buffer, sizeof(buffer), "OSC %s argument %d expected Timestamp", context, index);
-		std::fprintf(stderr, "%s\n", buffer);
-#endif
-		return false;
+		const juce::int64 total = wholeSeconds * 1000000 + micros;
+		return negative ? -total : total;
 	}
 
 	double parseOscDoubleArgument(const juce::OSCArgument &argument)
@@ -73,16 +63,184 @@ namespace
 		return 0.0;
 	}
 
+	// Addresses the Conductor answers; messages to any other address are dropped
+	const std::array<const char *, 11> kHandledAddresses{
+		"/midi/message", "/midi/batch", "/midi/batch/resolve", "/orchestra", "/orchestra/set_tempo", "/engine/dsp_load",
+		"/engine/benchmark", "/engine/meters", "/engine/process_group", "/engine/block_size", "/engine/tempo_map"};
+
+	// The command a message carries. /midi/message and /orchestra name it in argument 0, and
+	// /midi/<name> in the address; firstArg is set to where the command's own arguments start.
+	const OscCommands::Spec *findCommand(const juce::String &address, const juce::OSCMessage &message, int &firstArg)
+	{
+		constexpr int kMidiPrefixLength = 6; // "/midi/"
+		const OscCommands::Spec *command = nullptr;
+		auto family = OscCommands::Family::Midi;
+		if (address == "/midi/message" || address == "/orchestra")
+		{
+			if (message.size() == 0 || !message[0].isString())
+				return nullptr;
+
+			command = OscCommands::find(message[0].getString());
+			family = address == "/orchestra" ? OscCommands::Family::Orchestra : OscCommands::Family::Midi;
+			firstArg = 1;
+		}
+		else if (address.startsWith("/midi/"))
+		{
+			command = OscCommands::find(address.toRawUTF8() + kMidiPrefixLength);
+			firstArg = 0;
+		}
+
+		return command != nullptr && command->family == family ? command : nullptr;
+	}
+
+	// /midi/batch record: status, data1, data2, reserved, uint32 tag id, int64 time in us, little endian
+	constexpr size_t kBatchRecordSize = 16;
+
+	// MIDI events decoded on the receiver thread, collected so they reach the engine in one batch.
+	// /midi/batch records stay in their blob, in the OSC message being decoded, and are written
+	// from there into the ingest lane, so a context is handed over before that message is gone.
+	struct BundleContext : MidiEventBatch
+	{
+		struct RecordBatch
+		{
+			const juce::uint8 *records = nullptr;
+			size_t numRecords = 0;
+			juce::int64 timestampOffset = 0;
+			size_t eventsBefore = 0; // keeps the batch in order with the other events
+		};
+
+		bool hasTime = false;
+		juce::int64 hostTimeUs = 0; // on the Time::getMillisecondCounterHiRes clock, like message timestamps
+		std::vector<MidiBatchEvent> events;
+		std::vector<RecordBatch> recordBatches;
+		// Each tag id once, resolved when its batch arrives so every pass sees the same targets
+		std::vector<std::pair<juce::uint32, InstrumentTagIndex::SharedTargets>> resolvedTags;
+
+		// Null for a tag without targets, resolved or not
+		const std::vector<InstrumentTagIndex::Target> *findTargets(juce::uint32 tagId) const
+		{
+			const auto *entry = findResolved(tagId);
+			return entry != nullptr ? entry->second.get() : nullptr;
+		}
+
+		const std::pair<juce::uint32, InstrumentTagIndex::SharedTargets> *findResolved(juce::uint32 tagId) const
+		{
+			for (const auto &entry : resolvedTags)
+			{
+				if (entry.first == tagId)
+					return &entry;
+			}
+			return nullptr;
+		}
+
+		void forEachEvent(Visitor &visitor) const override
+		{
+			size_t next = 0;
+			for (const auto &batch : recordBatches)
+			{
+				for (; next < batch.eventsBefore; ++next)
+					visitEvent(events[next], visitor);
+				visitRecords(batch, visitor);
+			}
+			for (; next < events.size(); ++next)
+				visitEvent(events[next], visitor);
+		}
+
+		// Keeps the capacity, so a receiver thread stops allocating once it has seen its largest bundle
+		void clear()
+		{
+			hasTime = false;
+			hostTimeUs = 0;
+			events.clear();
+			recordBatches.clear();
+			resolvedTags.clear();
+		}
+
+	private:
+		static void visitEvent(const MidiBatchEvent &event, Visitor &visitor)
+		{
+			visitor.visit(event.message.getRawData(), event.message.getRawDataSize(), event.target.handle,
+						  event.target.pluginId, event.timestamp);
+		}
+
+		void visitRecords(const RecordBatch &batch, Visitor &visitor) const
+		{
+			for (size_t i = 0; i < batch.numRecords; ++i)
+			{
+				const auto *record = batch.records + i * kBatchRecordSize;
+				const int status = record[0] & 0xf0;
+				if (status < 0x80 || status == 0xf0)
+					continue;
+
+				const auto *targets = findTargets(juce::ByteOrder::littleEndianInt(record + 4));
+				if (targets == nullptr)
+					continue;
+
+				const auto timeUs = static_cast<juce::int64>(juce::ByteOrder::littleEndianInt64(record + 8));
+				const auto timestamp = juce::jmax<juce::int64>(0, timeUs - batch.timestampOffset);
+				// Program change and channel pressure carry a single data byte
+				const int size = (status == 0xc0 || status == 0xd0) ? 2 : 3;
+				for (const auto &target : *targets)
+				{
+					const juce::uint8 bytes[3] = {static_cast<juce::uint8>(status | (juce::jlimit(1, 16, target.midiChannel) - 1)),
+												  static_cast<juce::uint8>(record[1] & 0x7f),
+												  static_cast<juce::uint8>(record[2] & 0x7f)};
+					visitor.visit(bytes, size, target.handle, target.pluginInstanceId, timestamp);
+				}
+			}
+		}
+	};
+	// The bundle being decoded on this thread, if any. A timed bundle stands in for each
+	// message's own timestamp.
+	thread_local BundleContext *activeBundle = nullptr;
+	// Reused by every bundle, and by /midi/batch messages outside one, on this thread
+	thread_local BundleContext receiverContext;
+
+	// OSC time tags are NTP wall-clock time. They are moved onto the host clock through the
+	// wall clock's current distance from it, so client and server clocks must agree (NTP).
+	juce::int64 timeTagToHostMicros(const juce::OSCTimeTag &timeTag)
+	{
+		constexpr juce::int64 kNtpToUnixSeconds = 2208988800;
+		const auto raw = timeTag.getRawTimeTag();
+		const auto seconds = static_cast<juce::int64>(raw >> 32) - kNtpToUnixSeconds;
+		const auto fractionUs = static_cast<juce::int64>(((raw & 0xffffffffull) * 1000000ull) >> 32);
+
+		const auto wallNowUs = std::chrono::duration_cast<std::chrono::microseconds>(
+								   std::chrono::system_clock::now().time_since_epoch())
+								   .count();
+		const auto hostNowUs = static_cast<juce::int64>(std::llround(juce::Time::getMillisecondCounterHiRes() * 1000.0));
+		return hostNowUs + (seconds * 1000000 + fractionUs - static_cast<juce::int64>(wallNowUs));
+	}
+
+	// The definition for busName, added with default routing if there is none yet
+	BusDefinition &findOrAddBusDefinition(std::vector<BusDefinition> &buses, const juce::String &busName)
+	{
+		for (auto &bus : buses)
+		{
+			if (bus.name.equalsIgnoreCase(busName))
+				return bus;
+		}
+
+		BusDefinition bus;
+		bus.name = busName;
+		buses.push_back(std::move(bus));
+		return buses.back();
+	}
+
 }
 
 // Constructor: takes a reference to PluginManager and passes it
-Conductor::Conductor(PluginManager &pm, MidiManager &mm, MainComponent *mainComponentRef)
-	: pluginManager(pm), midiManager(mm), mainComponent(mainComponentRef)
+Conductor::Conductor(PluginManager &pm, MidiManager &mm, MainComponent *mainComponentRef, bool runHeadless)
+	: juce::OSCReceiver("OSC receiver"), pluginManager(pm), midiManager(mm), mainComponent(mainComponentRef), headless(runHeadless)
 {
-	// Add this instance as an OSC listener
-	addListener(this, "/midi/message");
-	addListener(this, "/orchestra");
-	addListener(this, "/orchestra/set_tempo");
+	// Add this instance as an OSC listener; it sees bundles whole and filters addresses itself
+	addListener(this);
+
+	// Plugins load in the background, so routes pick up their handles as they arrive
+	pluginManager.setPluginHandlesChangedCallback([this]()
+												  {
+		routesStale = true;
+		triggerAsyncUpdate(); });
 
 	// initial sync of orchestra with PluginManager
 	syncOrchestraWithPluginManager();
@@ -98,10 +256,13 @@ Conductor::~Conductor()
 		delete presetLoadBatchTimer;
 		presetLoadBatchTimer = nullptr;
 	}
+	meterStreamTimer.reset();
+	pluginManager.setPluginHandlesChangedCallback({});
 	// Ensure to remove the listener and close the OSC receiver
 	removeListener(this);
 	OSCSender::disconnect();
 	OSCReceiver::disconnect();
+	cancelPendingUpdate();
 }
 
 void Conductor::processPendingPresetLoads()
@@ -112,33 +273,22 @@ void Conductor::processPendingPresetLoads()
 		presetLoadBatchTimer = nullptr;
 	}
 
-	if (pendingNewPlugins.empty())
-	{
-		// No new plugins, just load presets immediately
-		for (const auto &presetLoad : pendingPresetLoads)
-		{
-			DBG("Loading preset " << presetLoad.filename << " into existing " << presetLoad.pluginId);
-			bool success = pluginManager.loadPluginData(presetLoad.filepath, presetLoad.filename, presetLoad.pluginId);
-			if (success)
-			{
-				DBG("Successfully loaded preset into " << presetLoad.pluginId);
-			}
-			else
-			{
-				DBG("Failed to load preset into " << presetLoad.pluginId);
-			}
-		}
-		pendingPresetLoads.clear();
-		return;
-	}
-
-	// We have new plugins - show confirmation dialog
 	auto capturedNewPlugins = pendingNewPlugins;
 	auto capturedPresetLoads = pendingPresetLoads;
-
 	pendingNewPlugins.clear();
 	pendingPresetLoads.clear();
 
+	// No new plugins, just load presets immediately. Headless there is nobody to confirm that
+	// new plugins have finished loading, so the presets go straight in there too.
+	if (capturedNewPlugins.empty() || headless)
+	{
+		if (!capturedNewPlugins.empty())
+			juce::Logger::writeToLog("load_plugin_data: created " + juce::String((int)capturedNewPlugins.size()) + " plugin instance(s), loading presets");
+		loadPresets(capturedPresetLoads);
+		return;
+	}
+
+	// We have new plugins - show confirmation dialog
 	juce::MessageManager::callAsync([this, capturedNewPlugins, capturedPresetLoads]() mutable
 									{
 		juce::String message = "The following plugin instance(s) have been created:\n\n";
@@ -158,20 +308,7 @@ void Conductor::processPendingPresetLoads()
 
 		if (shouldContinue)
 		{
-			// Load all pending presets immediately
-			for (const auto &presetLoad : capturedPresetLoads)
-			{
-				DBG("Loading preset " << presetLoad.filename << " into " << presetLoad.pluginId);
-				bool success = pluginManager.loadPluginData(presetLoad.filepath, presetLoad.filename, presetLoad.pluginId);
-				if (success)
-				{
-					DBG("Successfully loaded preset into " << presetLoad.pluginId);
-				}
-				else
-				{
-					DBG("Failed to load preset into " << presetLoad.pluginId);
-				}
-			}
+			loadPresets(capturedPresetLoads);
 			DBG("All presets loaded");
 		}
 		else
@@ -180,11 +317,36 @@ void Conductor::processPendingPresetLoads()
 		} });
 }
 
+void Conductor::loadPresets(const std::vector<PendingPresetLoad> &presetLoads)
+{
+	for (const auto &presetLoad : presetLoads)
+	{
+		DBG("Loading preset " << presetLoad.filename << " into " << presetLoad.pluginId);
+		if (pluginManager.loadPluginData(presetLoad.filepath, presetLoad.filename, presetLoad.pluginId))
+		{
+			DBG("Successfully loaded preset into " << presetLoad.pluginId);
+		}
+		else if (headless)
+		{
+			juce::Logger::writeToLog("load_plugin_data: could not load " + presetLoad.filename + " into " + presetLoad.pluginId);
+		}
+		else
+		{
+			DBG("Failed to load preset into " << presetLoad.pluginId);
+		}
+	}
+}
+
 void Conductor::shutdown()
 {
+	meterStreamTimer.reset();
 	removeListener(this);
 	OSCReceiver::disconnect(); // stop OSC listening thread
 	OSCSender::disconnect();   // close socket
+
+	cancelPendingUpdate();
+	const juce::ScopedLock sl(pendingControlLock);
+	pendingControlMessages.clear();
 }
 
 // Initialise OSC Sender with a specific host and port
@@ -219,6 +381,149 @@ void Conductor::send_lastTag()
 	sendOSCMessage(lastTags);
 }
 
+// Reply to /engine/dsp_load: one summary for the whole callback, then one message per plugin, heaviest first
+void Conductor::sendDspLoadReport()
+{
+	const auto report = pluginManager.getDspLoadReport();
+
+	juce::OSCMessage summary("/engine/dsp_load/summary");
+	summary.addFloat32(static_cast<float>(report.callback.meanPercent));
+	summary.addFloat32(static_cast<float>(report.callback.p99Percent));
+	summary.addFloat32(static_cast<float>(report.callback.maxPercent));
+	summary.addInt32(static_cast<juce::int32>(report.callback.overruns));
+	summary.addInt32(report.deviceXRuns);
+	summary.addInt32(static_cast<juce::int32>(report.callback.count));
+	OSCSender::send(summary);
+
+	for (const auto &plugin : report.plugins)
+	{
+		juce::OSCMessage reply("/engine/dsp_load/plugin");
+		reply.addString(plugin.pluginId);
+		reply.addFloat32(static_cast<float>(plugin.load.meanPercent));
+		reply.addFloat32(static_cast<float>(plugin.load.p99Percent));
+		reply.addFloat32(static_cast<float>(plugin.load.maxPercent));
+		reply.addInt32(static_cast<juce::int32>(plugin.load.overruns));
+		reply.addInt32(static_cast<juce::int32>(plugin.load.count));
+		OSCSender::send(reply);
+	}
+
+	DBG("Sent DSP load report for " << (int)report.plugins.size() << " plugins");
+}
+
+// Reply to /engine/tempo_map: one message per point, in time order
+void Conductor::sendTempoMapReport()
+{
+	for (const auto &point : pluginManager.getTempoMap().getPoints())
+	{
+		juce::OSCMessage reply("/engine/tempo_map/point");
+		reply.addFloat32(static_cast<float>(point.timeSeconds));
+		reply.addFloat32(static_cast<float>(point.bpm));
+		reply.addInt32(point.numerator);
+		reply.addInt32(point.denominator);
+		OSCSender::send(reply);
+	}
+}
+
+// Reply to /engine/process_group: one message per running worker process
+void Conductor::sendProcessGroupReport()
+{
+	for (const auto &group : pluginManager.getProcessGroupSizes())
+	{
+		juce::OSCMessage reply("/engine/process_group/group");
+		reply.addString(group.first);
+		reply.addInt32(static_cast<juce::int32>(group.second));
+		OSCSender::send(reply);
+	}
+}
+
+void Conductor::sendMeterReport()
+{
+	for (const auto &reading : pluginManager.getAudioRouter().getMeterReadings())
+	{
+		juce::OSCMessage reply("/engine/meters/bus");
+		reply.addString(reading.name);
+		reply.addFloat32(reading.peakDb);
+		reply.addFloat32(reading.rmsDb);
+		reply.addFloat32(reading.shortTermLufs);
+		OSCSender::send(reply);
+	}
+}
+
+void Conductor::setMeterStreamRate(int rateHz)
+{
+	if (rateHz <= 0)
+	{
+		meterStreamTimer.reset();
+		DBG("Meter stream stopped");
+		return;
+	}
+
+	struct MeterStreamTimer : public juce::Timer
+	{
+		explicit MeterStreamTimer(Conductor &c) : conductor(c) {}
+		void timerCallback() override { conductor.sendMeterReport(); }
+		Conductor &conductor;
+	};
+
+	if (meterStreamTimer == nullptr)
+		meterStreamTimer = std::make_unique<MeterStreamTimer>(*this);
+
+	// Meters refresh every 100 ms, so faster streams mostly repeat readings
+	const int clampedRate = juce::jlimit(1, 30, rateHz);
+	meterStreamTimer->startTimerHz(clampedRate);
+	DBG("Meter stream at " << clampedRate << " Hz");
+}
+
+// Runs on the message thread, so keep the iteration count modest while the engine is playing
+void Conductor::runBenchmark(const juce::OSCMessage &message)
+{
+	const auto name = message.size() > 0 && message[0].isString() ? message[0].getString() : juce::String("mix");
+	auto intArgument = [&message](int index, int fallback)
+	{
+		return index < message.size() ? juce::roundToInt(parseOscDoubleArgument(message[index])) : fallback;
+	};
+
+	if (name == "mix")
+	{
+		// mix [channels] [destinations] [blockSize] [iterations]
+		const auto result = MixKernels::runBenchmark(intArgument(1, 2), intArgument(2, 3), intArgument(3, 512), intArgument(4, 20000));
+
+		juce::OSCMessage reply("/engine/benchmark/mix");
+		reply.addString(result.instructionSet);
+		reply.addInt32(result.numChannels);
+		reply.addInt32(result.numDestinations);
+		reply.addInt32(result.blockSize);
+		reply.addInt32(result.iterations);
+		reply.addFloat32(static_cast<float>(result.fusedNsPerBlock));
+		reply.addFloat32(static_cast<float>(result.perBusNsPerBlock));
+		reply.addFloat32(static_cast<float>(result.speedup));
+		OSCSender::send(reply);
+
+		DBG("Mix benchmark (" << result.instructionSet << "): fused " << result.fusedNsPerBlock << " ns/block, per bus "
+							  << result.perBusNsPerBlock << " ns/block, x" << result.speedup);
+		return;
+	}
+
+	if (name == "dispatch")
+	{
+		// dispatch [iterations]
+		const auto result = OscCommands::runBenchmark(intArgument(1, 200000));
+
+		juce::OSCMessage reply("/engine/benchmark/dispatch");
+		reply.addInt32(result.iterations);
+		reply.addFloat32(static_cast<float>(result.hashedMessagesPerSecond));
+		reply.addFloat32(static_cast<float>(result.linearMessagesPerSecond));
+		reply.addFloat32(static_cast<float>(result.speedup));
+		OSCSender::send(reply);
+
+		DBG("Dispatch benchmark: hashed " << result.hashedMessagesPerSecond << " msg/s, linear "
+										  << result.linearMessagesPerSecond << " msg/s, x" << result.speedup);
+		return;
+	}
+
+	DBG("Unknown benchmark: " << name);
+}
+
 // Initialize OSC Receiver with a specific port
 void Conductor::initializeOSCReceiver(int port)
 {
@@ -242,11 +547,175 @@ void Conductor::stringArrayToVector(juce::StringArray stringArray, std::vector<j
 }
 
 // Callback function for receiving OSC messages
+// Receiver thread. A note must not wait behind repaints, modal dialogs or file I/O, so MIDI
+// events and sync/stop are handled here; the rest touches the orchestra, plugins or the UI and
+// is queued for the message thread.
 void Conductor::oscMessageReceived(const juce::OSCMessage &message)
 {
 	// DBG print the message
 	// DBG("Received OSC message: " + message.getAddressPattern().toString());
 
+	raiseReceiverThreadPriority();
+	if (routeIncomingMessage(message))
+		triggerAsyncUpdate();
+}
+
+// Receiver thread. Every MIDI event in the bundle, nested bundles included, reaches the engine
+// in one ingest operation after the whole bundle is decoded, so a chord is never split.
+void Conductor::oscBundleReceived(const juce::OSCBundle &bundle)
+{
+	raiseReceiverThreadPriority();
+
+	auto &context = receiverContext;
+	activeBundle = &context;
+	const bool queuedControl = collectBundle(bundle);
+	activeBundle = nullptr;
+
+	pluginManager.addMidiMessages(context);
+	context.clear();
+	if (queuedControl)
+		triggerAsyncUpdate();
+}
+
+bool Conductor::collectBundle(const juce::OSCBundle &bundle)
+{
+	// A nested bundle keeps its own time; an immediate one takes its parent's
+	const auto enclosingHasTime = activeBundle->hasTime;
+	const auto enclosingTimeUs = activeBundle->hostTimeUs;
+	if (!bundle.getTimeTag().isImmediately())
+	{
+		activeBundle->hasTime = true;
+		activeBundle->hostTimeUs = timeTagToHostMicros(bundle.getTimeTag());
+	}
+
+	bool queuedControl = false;
+	for (const auto &element : bundle)
+	{
+		if (element.isBundle())
+			queuedControl = collectBundle(element.getBundle()) || queuedControl;
+		else if (element.isMessage())
+			queuedControl = routeIncomingMessage(element.getMessage()) || queuedControl;
+	}
+
+	activeBundle->hasTime = enclosingHasTime;
+	activeBundle->hostTimeUs = enclosingTimeUs;
+	return queuedControl;
+}
+
+// Receiver thread. A MIDI event is handled here; anything else is queued for the message
+// thread, and the caller triggers the update when this returns true.
+bool Conductor::routeIncomingMessage(const juce::OSCMessage &message)
+{
+	const auto address = message.getAddressPattern().toString();
+	if (address == "/midi/batch")
+	{
+		processMidiBatch(message);
+		return false;
+	}
+
+	int firstArg = 0;
+	if (const auto *command = findCommand(address, message, firstArg))
+	{
+		if (command->realtime)
+		{
+			processMidiCommand(*command, message, firstArg);
+			return false;
+		}
+	}
+	else if (std::none_of(kHandledAddresses.begin(), kHandledAddresses.end(), [&address](const char *handled)
+						  { return address == handled; }))
+	{
+		return false;
+	}
+
+	const juce::ScopedLock sl(pendingControlLock);
+	pendingControlMessages.push_back(message);
+	return true;
+}
+
+// Receiver thread. /midi/batch <blob>: records are read in place from the blob and written
+// straight into the ingest lane in one batch (or with the enclosing bundle's). Tag ids come
+// from /midi/batch/resolve and resolve to the index's own targets, which are not copied.
+// The status byte's channel is replaced by each target instrument's channel, and times are us
+// on the host clock, like "us" timestamps; a bundle's time tag does not override them.
+void Conductor::processMidiBatch(const juce::OSCMessage &message)
+{
+	if (message.size() < 1 || !message[0].isBlob())
+	{
+		DBG("OSC midi/batch expects a blob of event records");
+		return;
+	}
+
+	const auto &blob = message[0].getBlob();
+	if (blob.getSize() % kBatchRecordSize != 0)
+	{
+		DBG("OSC midi/batch blob of " << (int)blob.getSize() << " bytes is not a whole number of records");
+		return;
+	}
+
+	// Joins the enclosing bundle, or goes to the engine on its own
+	const bool inBundle = activeBundle != nullptr;
+	auto &context = inBundle ? *activeBundle : receiverContext;
+
+	const auto *records = static_cast<const juce::uint8 *>(blob.getData());
+	const auto numRecords = blob.getSize() / kBatchRecordSize;
+	context.recordBatches.push_back({records, numRecords, timestampOffset.load(), context.events.size()});
+
+	// A batch addresses a handful of tags, so each id is resolved once per bundle
+	for (size_t i = 0; i < numRecords; ++i)
+	{
+		const auto tagId = juce::ByteOrder::littleEndianInt(records + i * kBatchRecordSize + 4);
+		if (context.findResolved(tagId) == nullptr)
+			context.resolvedTags.emplace_back(tagId, tagIndex.resolveId(tagId));
+	}
+
+	if (!inBundle)
+	{
+		pluginManager.addMidiMessages(context);
+		context.clear();
+	}
+}
+
+// Straight to the engine, or into the batch of the bundle being decoded on this thread
+void Conductor::sendToEngine(const juce::MidiMessage &midiMessage, const PluginTarget &target, juce::int64 &timestamp)
+{
+	if (activeBundle != nullptr)
+	{
+		activeBundle->events.push_back({midiMessage, target, timestamp});
+		return;
+	}
+
+	pluginManager.addMidiMessage(midiMessage, target, timestamp);
+}
+
+// The receiver thread is started by connect, so it is raised from its first callback (and again after a reconnect)
+void Conductor::raiseReceiverThreadPriority()
+{
+	auto *thread = juce::Thread::getCurrentThread();
+	if (thread == nullptr || raisedReceiverThread.exchange(thread) == thread)
+		return;
+
+	if (!thread->setPriority(juce::Thread::Priority::highest))
+		DBG("Could not raise the OSC receiver thread priority");
+}
+
+void Conductor::handleAsyncUpdate()
+{
+	if (routesStale.exchange(false))
+		publishInstrumentRoutes();
+
+	std::vector<juce::OSCMessage> messages;
+	{
+		const juce::ScopedLock sl(pendingControlLock);
+		messages.swap(pendingControlMessages);
+	}
+
+	for (const auto &message : messages)
+		handleControlMessage(message);
+}
+
+void Conductor::handleControlMessage(const juce::OSCMessage &message)
+{
 	juce::String messageAddress = message.getAddressPattern().toString();
 
 	if (messageAddress == "/orchestra/set_tempo")
@@ -284,101 +753,289 @@ void Conductor::oscMessageReceived(const juce::OSCMessage &message)
 		return;
 	}
 
-	// Ensure the message has at least the necessary components for MIDI data and tags
-	if (message.size() > 0 && message[0].isString())
+	if (messageAddress == "/engine/dsp_load")
+	{
+		const bool resetAfterReport = message.size() > 0 && message[0].isString() && message[0].getString() == "reset";
+		sendDspLoadReport();
+		if (resetAfterReport)
+			pluginManager.resetDspLoadStats();
+		return;
+	}
+
+	if (messageAddress == "/engine/benchmark")
 	{
-		juce::String messageType = message[0].getString();
+		runBenchmark(message);
+		return;
+	}
 
-		// Handle add_instrument command by checking the message address
-		if (messageAddress == "/orchestra")
+	if (messageAddress == "/engine/process_group")
+	{
+		// <pluginInstanceId> [group]: moves the plugin into that worker process, or back into the
+		// engine without a group. Always answers with the groups now running.
+		if (message.size() > 0 && message[0].isString())
 		{
-			if (messageType == "add_instrument")
-			{
-				oscAddInstrumentCommand(message);
-			}
-			else if (messageType == "get_recorded")
-			{
-				// activate get_recorded method
-				DBG("Received get_recorded command");
-				midiManager.getRecorded();
-			}
-			else if (messageType == "select_by_tag")
-			{
-				if (message.size() >= 2 && message[1].isString())
-				{
-					juce::String tag = message[1].getString();
-					DBG("Received select_by_tag command for tag: " + tag);
-					if (!selectInstrumentByTag(tag))
-					{
-						DBG("select_by_tag: no instrument found for tag: " + tag);
-					}
-				}
-				else
-				{
-					DBG("select_by_tag command missing tag argument");
-				}
-			}
-			else if (messageType == "open_instrument")
+			const juce::String pluginId = message[0].getString();
+			const juce::String group = message.size() > 1 && message[1].isString() ? message[1].getString() : juce::String();
+			if (!pluginManager.setPluginProcessGroup(pluginId, group))
+				DBG("process_group: could not load " << pluginId << " in " << (group.isEmpty() ? juce::String("the engine") : group));
+		}
+		sendProcessGroupReport();
+		return;
+	}
+
+	if (messageAddress == "/engine/tempo_map")
+	{
+		// <seconds> <bpm> <numerator> <denominator>, repeated: replaces the map. "clear" keeps just
+		// the opening tempo. Always answers with the map now in use.
+		if (message.size() == 1 && message[0].isString() && message[0].getString() == "clear")
+		{
+			const auto first = pluginManager.getTempoMap().getPoints().front();
+			pluginManager.setTempoMap(TempoMap::constant(first.bpm, first.numerator, first.denominator));
+		}
+		else if (message.size() > 0)
+		{
+			if (message.size() % 4 != 0)
 			{
-				if (message.size() >= 2 && message[1].isString())
-				{
-					juce::String tag = message[1].getString();
-					DBG("Received open_instrument command for tag: " + tag);
-					if (!openInstrumentByTag(tag))
-					{
-						DBG("open_instrument: no instrument found for tag: " + tag);
-					}
-				}
-				else
-				{
-					DBG("open_instrument command missing tag argument");
-				}
+				DBG("OSC tempo_map expects groups of <seconds> <bpm> <numerator> <denominator>");
+				return;
 			}
-			else if (messageType == "save_project")
+
+			std::vector<TempoMap::Point> points;
+			for (int i = 0; i < message.size(); i += 4)
 			{
-				if (mainComponent != nullptr)
-				{
-					auto archive = mainComponent->getDefaultProjectArchiveFile();
-					mainComponent->saveProject({}, archive);
-					DBG("OSC save_project wrote archive " + archive.getFullPathName());
-				}
-				else
-				{
-					DBG("OSC save_project: mainComponent is null.");
-				}
+				points.push_back({ parseOscDoubleArgument(message[i]),
+								   parseOscDoubleArgument(message[i + 1]),
+								   juce::roundToInt(parseOscDoubleArgument(message[i + 2])),
+								   juce::roundToInt(parseOscDoubleArgument(message[i + 3])) });
 			}
-			else if (messageType == "restore_project")
+			pluginManager.setTempoMap(TempoMap(std::move(points)));
+		}
+
+		sendTempoMapReport();
+		return;
+	}
+
+	if (messageAddress == "/engine/block_size")
+	{
+		// [samples]: 0 goes back to the device block size. Always answers with the result.
+		if (message.size() > 0)
+			pluginManager.setInternalBlockSize(juce::roundToInt(parseOscDoubleArgument(message[0])));
+
+		const int latencySamples = pluginManager.getInternalBlockLatencySamples();
+		const double sampleRate = pluginManager.getCurrentSampleRate();
+		juce::OSCMessage reply("/engine/block_size/state");
+		reply.addInt32(pluginManager.getInternalBlockSize());
+		reply.addInt32(pluginManager.getDeviceBlockSize());
+		reply.addInt32(latencySamples);
+		reply.addFloat32(sampleRate > 0.0 ? static_cast<float>(1000.0 * latencySamples / sampleRate) : 0.0f);
+		OSCSender::send(reply);
+		return;
+	}
+
+	if (messageAddress == "/midi/batch/resolve")
+	{
+		// <tag>...: one /midi/batch/target <tag> <id> reply per tag, 0 for a tag no instrument has had.
+		// Ids stay valid until the server restarts, across orchestra edits.
+		for (const auto &tag : extractTags(message, 0))
+		{
+			juce::OSCMessage reply("/midi/batch/target");
+			reply.addString(tag);
+			reply.addInt32(static_cast<juce::int32>(tagIndex.getTagId(tag)));
+			OSCSender::send(reply);
+		}
+		return;
+	}
+
+	if (messageAddress == "/engine/meters")
+	{
+		// No argument: one report now. A rate starts or changes the stream, 0 stops it.
+		if (message.size() > 0)
+			setMeterStreamRate(juce::roundToInt(parseOscDoubleArgument(message[0])));
+		else
+			sendMeterReport();
+		return;
+	}
+
+	int firstArg = 0;
+	const auto *command = findCommand(messageAddress, message, firstArg);
+	if (command == nullptr)
+	{
+		DBG("Error: Unknown OSC message type at " << messageAddress);
+		return;
+	}
+
+	if (command->family == OscCommands::Family::Orchestra)
+		processOrchestraCommand(*command, message, firstArg);
+	else
+		processMidiCommand(*command, message, firstArg);
+}
+
+void Conductor::processOrchestraCommand(const OscCommands::Spec &command, const juce::OSCMessage &message, int firstArg)
+{
+	OscCommands::Arguments arguments;
+	if (!OscCommands::decode(message, firstArg, command, arguments))
+		return;
+
+	switch (command.command)
+	{
+	case OscCommands::Command::AddInstrument:
+		oscAddInstrumentCommand(message);
+		break;
+	case OscCommands::Command::GetRecorded:
+		// activate get_recorded method
+		DBG("Received get_recorded command");
+		midiManager.getRecorded();
+		break;
+	case OscCommands::Command::SelectByTag:
+	{
+		const juce::String &tag = arguments.strings[0];
+		DBG("Received select_by_tag command for tag: " + tag);
+		if (!selectInstrumentByTag(tag))
+		{
+			DBG("select_by_tag: no instrument found for tag: " + tag);
+		}
+		break;
+	}
+	case OscCommands::Command::OpenInstrument:
+	{
+		const juce::String &tag = arguments.strings[0];
+		DBG("Received open_instrument command for tag: " + tag);
+		if (!openInstrumentByTag(tag))
+		{
+			DBG("open_instrument: no instrument found for tag: " + tag);
+		}
+		break;
+	}
+	case OscCommands::Command::SaveProject:
+		if (mainComponent != nullptr)
+		{
+			auto archive = mainComponent->getDefaultProjectArchiveFile();
+			mainComponent->saveProject({}, archive);
+			DBG("OSC save_project wrote archive " + archive.getFullPathName());
+		}
+		else
+		{
+			DBG("OSC save_project: mainComponent is null.");
+		}
+		break;
+	case OscCommands::Command::RestoreProject:
+		if (mainComponent != nullptr)
+		{
+			mainComponent->restoreProject(false, mainComponent->getDefaultProjectArchiveFile());
+		}
+		break;
+	case OscCommands::Command::RestoreFromFile:
+		DBG("Received restore from file request for file: ");
+		mainComponent->restoreProject(false); // false means do not append, just restore
+		break;
+	case OscCommands::Command::SetPriority:
+	{
+		const int priority = juce::jlimit(CpuWatchdog::kMinPriority, CpuWatchdog::kProtectedPriority, arguments.ints[0]);
+		const std::vector<juce::String> tags = extractTags(message, arguments.next);
+		int updated = 0;
+		for (auto &instrument : orchestra)
+		{
+			for (const auto &tag : tags)
 			{
-				if (mainComponent != nullptr)
+				if (std::find(instrument.tags.begin(), instrument.tags.end(), tag) != instrument.tags.end())
 				{
-					mainComponent->restoreProject(false, mainComponent->getDefaultProjectArchiveFile());
+					instrument.priority = priority;
+					++updated;
+					break;
 				}
 			}
-			else if (messageType == "restore_from_file")
-			{
-				DBG("Received restore from file request for file: ");
-				mainComponent->restoreProject(false); // false means do not append, just restore
-			}
-			else if (messageType == "request_tags")
+		}
+
+		DBG("set_priority " << priority << " applied to " << updated << " instruments");
+		applyInstrumentPriorities();
+		if (mainComponent != nullptr)
+			mainComponent->orchestraTable.repaint();
+		break;
+	}
+	case OscCommands::Command::SetCpuWatchdog:
+	{
+		const auto degradePercent = static_cast<float>(arguments.number);
+		const auto restorePercent = message.size() > arguments.next ? static_cast<float>(parseOscDoubleArgument(message[arguments.next]))
+																	: degradePercent * 2.0f / 3.0f;
+		pluginManager.getCpuWatchdog().setThresholds(degradePercent, restorePercent);
+		break;
+	}
+	case OscCommands::Command::AddReturn:
+	case OscCommands::Command::SetInserts:
+	{
+		// Insert plugins are instance ids, processed in the order given; none clears the chain
+		const auto busName = arguments.strings[0].trim();
+		auto buses = pluginManager.getBusDefinitions();
+		auto &bus = findOrAddBusDefinition(buses, busName);
+		bus.inserts = extractTags(message, arguments.next);
+		if (command.command == OscCommands::Command::AddReturn)
+			bus.isReturn = true;
+
+		pluginManager.setBusDefinitions(buses);
+		DBG(command.name << " " << busName << " with " << (int)bus.inserts.size() << " inserts");
+		break;
+	}
+	case OscCommands::Command::RemoveReturn:
+	{
+		const auto busName = arguments.strings[0].trim();
+		auto buses = pluginManager.getBusDefinitions();
+		buses.erase(std::remove_if(buses.begin(), buses.end(),
+								   [&busName](const BusDefinition &bus)
+								   { return bus.isReturn && bus.name.equalsIgnoreCase(busName); }),
+					buses.end());
+		pluginManager.setBusDefinitions(buses);
+		break;
+	}
+	case OscCommands::Command::SetBusOutput:
+	{
+		auto buses = pluginManager.getBusDefinitions();
+		findOrAddBusDefinition(buses, arguments.strings[0].trim()).output = arguments.strings[1].trim();
+		pluginManager.setBusDefinitions(buses);
+		break;
+	}
+	case OscCommands::Command::SetSend:
+	{
+		const auto busName = arguments.strings[0].trim();
+		const auto level = static_cast<float>(arguments.number);
+		const std::vector<juce::String> tags = extractTags(message, arguments.next);
+
+		// Sends belong to the plugin, so instruments sharing one share its send
+		juce::StringArray pluginIds;
+		for (const auto &instrument : orchestra)
+		{
+			for (const auto &tag : tags)
 			{
-				DBG("Received request for tags");
-				// Get the tags of the first currently selected instrument
-				juce::String tags;
-				if (!orchestra.empty())
+				if (std::find(instrument.tags.begin(), instrument.tags.end(), tag) != instrument.tags.end())
 				{
-					tags = orchestra[0].tags.empty() ? "" : orchestra[0].tags[0];
+					pluginIds.addIfNotAlreadyThere(instrument.pluginInstanceId);
+					break;
 				}
-				DBG("Sending tags: " + tags);
-
-				// Send the tags back to the sender
-				send_lastTag();
 			}
 		}
-		// Handle MIDI messages
-		else if (messageAddress == "/midi/message")
+
+		for (const auto &pluginId : pluginIds)
+			pluginManager.setBusSend(pluginId, busName, level);
+		DBG("set_send " << busName << " " << level << " applied to " << pluginIds.size() << " plugins");
+		break;
+	}
+	case OscCommands::Command::RequestTags:
+	{
+		DBG("Received request for tags");
+		// Get the tags of the first currently selected instrument
+		juce::String tags;
+		if (!orchestra.empty())
 		{
-			oscProcessMIDIMessage(message);
+			tags = orchestra[0].tags.empty() ? "" : orchestra[0].tags[0];
 		}
+		DBG("Sending tags: " + tags);
+
+		// Send the tags back to the sender
+		send_lastTag();
+		break;
+	}
+	default:
+		DBG("OSC " << command.name << " is not an orchestra command");
+		break;
 	}
 }
 
@@ -402,10 +1059,8 @@ void Conductor::oscAddInstrumentCommand(const juce::OSCMessage &message)
 				if (instrument.pluginName != message[1].getString())
 				{
 					DBG("Error: Plugin name does not match for existing instrument with pluginInstanceId: " + pluginInstanceId);
-					// reset the pluginInstanceId
-					pluginManager.resetPlugin(pluginInstanceId);
-					// instantiate the plugin with the new plugin name
-					pluginManager.instantiatePluginByName(message[1].getString(), pluginInstanceId);
+					// swap in the new plugin; the old one keeps playing until it has faded out
+					pluginManager.replacePlugin(message[1].getString(), pluginInstanceId);
 				}
 
 				// Update the existing entry with the new instrumentName
@@ -435,233 +1090,129 @@ void Conductor::oscAddInstrumentCommand(const juce::OSCMessage &message)
 	}
 }
 
-std::vector<std::pair<juce::String, int>> Conductor::extractPluginIdsAndChannels(const juce::OSCMessage &message, int startIndex)
+std::vector<std::pair<PluginTarget, int>> Conductor::extractPluginIdsAndChannels(const juce::OSCMessage &message, int startIndex)
 {
-	std::vector<juce::String> tags = extractTags(message, startIndex);
-	std::vector<std::pair<juce::String, int>> pluginIdsAndChannels;
-
-	// Find the plugin IDs associated with the tags and store them with the MIDI channel
-	for (const auto &tag : tags)
+	// Runs on the receiver thread, so it reads the tag index rather than the orchestra
+	std::vector<std::pair<PluginTarget, int>> pluginIdsAndChannels;
+	for (const auto &target : tagIndex.resolve(extractTags(message, startIndex)))
 	{
-		for (const auto &instrument : orchestra)
-		{
-			if (std::find(instrument.tags.begin(), instrument.tags.end(), tag) != instrument.tags.end())
-			{
-				// midiChannel is 0 based in OSC messages
-				int midiChannel = instrument.midiChannel - 1;
-
-				pluginIdsAndChannels.emplace_back(instrument.pluginInstanceId, midiChannel);
-			}
-		}
+		// midiChannel is 0 based in OSC messages
+		PluginTarget pluginTarget{target.pluginInstanceId, target.handle};
+		pluginIdsAndChannels.emplace_back(std::move(pluginTarget), target.midiChannel - 1);
 	}
 	return pluginIdsAndChannels;
 }
 
-void Conductor::oscProcessMIDIMessage(const juce::OSCMessage &message)
+// The signature has been checked by decode, so each case reads its arguments straight from it
+void Conductor::processMidiCommand(const OscCommands::Spec &command, const juce::OSCMessage &message, int firstArg)
 {
-	juce::String messageType = message[0].getString();
-	if (messageType == "note_on")
-	{
-		constexpr const char *context = "note_on";
-		if (!ensureMinOSCArguments(message, 4, context) ||
-			!ensureIntOSCArgument(message, 1, context) ||
-			!ensureIntOSCArgument(message, 2, context) ||
-			!ensureTimestampOSCArgument(message, 3, context))
-		{
-			return;
-		}
-
-		int note = message[1].getInt32();
-		int velocity = message[2].getInt32();
-		juce::int64 timestamp = adjustTimestamp(message[3]);
-
-		std::vector<std::pair<juce::String, int>> pluginIdsAndChannels = extractPluginIdsAndChannels(message, 4);
+	OscCommands::Arguments arguments;
+	if (!OscCommands::decode(message, firstArg, command, arguments))
+		return;
 
-		for (const auto &[pluginId, channel] : pluginIdsAndChannels)
-		{
-			handleIncomingNote(messageType, channel, note, velocity, pluginId, timestamp);
-			DBG("Received note on for plugin: " + pluginId + " on channel: " + juce::String(channel) + " with note: " + juce::String(note) + " and velocity: " + juce::String(velocity) + " at time " + juce::String(timestamp));
-		}
-	}
-	else if (messageType == "note_off")
+	switch (command.command)
 	{
-		constexpr const char *context = "note_off";
-		if (!ensureMinOSCArguments(message, 3, context) ||
-			!ensureIntOSCArgument(message, 1, context) ||
-			!ensureTimestampOSCArgument(message, 2, context))
-		{
-			return;
-		}
-
-		int note = message[1].getInt32();
-		int velocity = 0;
-		juce::int64 timestamp = adjustTimestamp(message[2]);
-
-		std::vector<std::pair<juce::String, int>> pluginIdsAndChannels = extractPluginIdsAndChannels(message, 3);
+	case OscCommands::Command::NoteOn:
+	case OscCommands::Command::NoteOff:
+	{
+		const bool noteOn = command.command == OscCommands::Command::NoteOn;
+		int note = arguments.ints[0];
+		int velocity = noteOn ? arguments.ints[1] : 0;
+		juce::int64 timestamp = adjustTimestamp(*arguments.timestamp);
 
-		for (const auto &[pluginId, channel] : pluginIdsAndChannels)
+		for (const auto &[target, channel] : extractPluginIdsAndChannels(message, arguments.next))
 		{
-			handleIncomingNote(messageType, channel, note, velocity, pluginId, timestamp);
+			handleIncomingNote(noteOn, channel, note, velocity, target, timestamp);
+			DBG("Received " << command.name << " for plugin: " + target.pluginId + " on channel: " + juce::String(channel) + " with note: " + juce::String(note) + " and velocity: " + juce::String(velocity) + " at time " + juce::String(timestamp));
 		}
+		break;
 	}
-	else if (messageType == "controller")
+	case OscCommands::Command::Controller:
 	{
-		constexpr const char *context = "controller";
-		if (!ensureMinOSCArguments(message, 4, context) ||
-			!ensureIntOSCArgument(message, 1, context) ||
-			!ensureIntOSCArgument(message, 2, context) ||
-			!ensureTimestampOSCArgument(message, 3, context))
-		{
-			return;
-		}
+		int controllerNumber = arguments.ints[0];
+		int controllerValue = arguments.ints[1];
+		juce::int64 timestamp = adjustTimestamp(*arguments.timestamp);
 
-		int controllerNumber = message[1].getInt32();
-		int controllerValue = message[2].getInt32();
-		juce::int64 timestamp = adjustTimestamp(message[3]);
-
-		std::vector<std::pair<juce::String, int>> pluginIdsAndChannels = extractPluginIdsAndChannels(message, 4);
-
-		for (const auto &[pluginId, channel] : pluginIdsAndChannels)
+		for (const auto &[target, channel] : extractPluginIdsAndChannels(message, arguments.next))
 		{
-			handleIncomingControlChange(channel, controllerNumber, controllerValue, pluginId, timestamp);
-			DBG("Received control change for plugin: " + pluginId + " on channel: " + juce::String(channel) +
+			handleIncomingControlChange(channel, controllerNumber, controllerValue, target, timestamp);
+			DBG("Received control change for plugin: " + target.pluginId + " on channel: " + juce::String(channel) +
 				" controller: " + juce::String(controllerNumber) + " value: " + juce::String(controllerValue) + " at time " + juce::String(timestamp));
 		}
+		break;
 	}
-	else if (messageType == "controller_ramp")
+	case OscCommands::Command::ControllerRamp:
 	{
-		constexpr const char *context = "controller_ramp";
-		if (!ensureMinOSCArguments(message, 6, context) ||
-			!ensureIntOSCArgument(message, 1, context) ||
-			!ensureIntOSCArgument(message, 2, context) ||
-			!ensureIntOSCArgument(message, 3, context) ||
-			!ensureTimestampOSCArgument(message, 5, context))
-		{
-			return;
-		}
-
-		if (!(message[4].isFloat32() || message[4].isInt32() || message[4].isString()))
-		{
-			DBG("OSC controller_ramp duration argument has invalid type.");
-			return;
-		}
-
-		int controllerNumber = message[1].getInt32();
-		int startValue = message[2].getInt32();
-		int endValue = message[3].getInt32();
-		double durationSeconds = parseOscDoubleArgument(message[4]);
-		juce::int64 rampStart = adjustTimestamp(message[5]);
-
-		std::vector<std::pair<juce::String, int>> pluginIdsAndChannels = extractPluginIdsAndChannels(message, 6);
+		int controllerNumber = arguments.ints[0];
+		int startValue = arguments.ints[1];
+		int endValue = arguments.ints[2];
+		double durationSeconds = arguments.number;
+		juce::int64 rampStart = adjustTimestamp(*arguments.timestamp);
 
-		for (const auto &[pluginId, channel] : pluginIdsAndChannels)
+		for (const auto &[target, channel] : extractPluginIdsAndChannels(message, arguments.next))
 		{
-			scheduleControllerRamp(channel, controllerNumber, startValue, endValue, durationSeconds, rampStart, pluginId);
-			DBG("Received controller ramp for plugin: " + pluginId + " on channel: " + juce::String(channel) +
+			scheduleControllerRamp(channel, controllerNumber, startValue, endValue, durationSeconds, rampStart, target);
+			DBG("Received controller ramp for plugin: " + target.pluginId + " on channel: " + juce::String(channel) +
 				" controller: " + juce::String(controllerNumber) + " start: " + juce::String(startValue) +
 				" end: " + juce::String(endValue) + " duration: " + juce::String(durationSeconds) + "s starting at " + juce::String(rampStart));
 		}
+		break;
 	}
-	else if (messageType == "channel_aftertouch")
+	case OscCommands::Command::ChannelAftertouch:
 	{
-		constexpr const char *context = "channel_aftertouch";
-		if (!ensureMinOSCArguments(message, 3, context) ||
-			!ensureIntOSCArgument(message, 1, context) ||
-			!ensureTimestampOSCArgument(message, 2, context))
-		{
-			return;
-		}
+		int value = arguments.ints[0];
+		juce::int64 timestamp = adjustTimestamp(*arguments.timestamp);
 
-		int value = message[1].getInt32();
-		juce::int64 timestamp = adjustTimestamp(message[2]);
-
-		std::vector<std::pair<juce::String, int>> pluginIdsAndChannels = extractPluginIdsAndChannels(message, 3);
-
-		for (const auto &[pluginId, channel] : pluginIdsAndChannels)
+		for (const auto &[target, channel] : extractPluginIdsAndChannels(message, arguments.next))
 		{
-			handleIncomingChannelAftertouch(channel, value, pluginId, timestamp);
-			DBG("Received channel aftertouch for plugin: " + pluginId + " on channel: " + juce::String(channel) +
+			handleIncomingChannelAftertouch(channel, value, target, timestamp);
+			DBG("Received channel aftertouch for plugin: " + target.pluginId + " on channel: " + juce::String(channel) +
 				" value: " + juce::String(value) + " at time " + juce::String(timestamp));
 		}
+		break;
 	}
-	else if (messageType == "poly_aftertouch")
+	case OscCommands::Command::PolyAftertouch:
 	{
-		constexpr const char *context = "poly_aftertouch";
-		if (!ensureMinOSCArguments(message, 4, context) ||
-			!ensureIntOSCArgument(message, 1, context) ||
-			!ensureIntOSCArgument(message, 2, context) ||
-			!ensureTimestampOSCArgument(message, 3, context))
-		{
-			return;
-		}
-
-		int note = message[1].getInt32();
-		int value = message[2].getInt32();
-		juce::int64 timestamp = adjustTimestamp(message[3]);
-
-		std::vector<std::pair<juce::String, int>> pluginIdsAndChannels = extractPluginIdsAndChannels(message, 4);
+		int note = arguments.ints[0];
+		int value = arguments.ints[1];
+		juce::int64 timestamp = adjustTimestamp(*arguments.timestamp);
 
-		for (const auto &[pluginId, channel] : pluginIdsAndChannels)
+		for (const auto &[target, channel] : extractPluginIdsAndChannels(message, arguments.next))
 		{
-			handleIncomingPolyAftertouch(channel, note, value, pluginId, timestamp);
-			DBG("Received poly aftertouch for plugin: " + pluginId + " on channel: " + juce::String(channel) +
+			handleIncomingPolyAftertouch(channel, note, value, target, timestamp);
+			DBG("Received poly aftertouch for plugin: " + target.pluginId + " on channel: " + juce::String(channel) +
 				" note: " + juce::String(note) + " value: " + juce::String(value) + " at time " + juce::String(timestamp));
 		}
+		break;
 	}
-	else if (messageType == "pitchbend")
+	case OscCommands::Command::PitchBend:
 	{
-		constexpr const char *context = "pitchbend";
-		if (!ensureMinOSCArguments(message, 3, context) ||
-			!ensureIntOSCArgument(message, 1, context) ||
-			!ensureTimestampOSCArgument(message, 2, context))
-		{
-			return;
-		}
+		int pitchBendValue = arguments.ints[0];
+		juce::int64 timestamp = adjustTimestamp(*arguments.timestamp);
 
-		int pitchBendValue = message[1].getInt32();
-		juce::int64 timestamp = adjustTimestamp(message[2]);
-
-		std::vector<std::pair<juce::String, int>> pluginIdsAndChannels = extractPluginIdsAndChannels(message, 3);
-
-		for (const auto &[pluginId, channel] : pluginIdsAndChannels)
+		for (const auto &[target, channel] : extractPluginIdsAndChannels(message, arguments.next))
 		{
-			handleIncomingPitchBend(channel, pitchBendValue, pluginId, timestamp);
-			DBG("Received pitch bend for plugin: " + pluginId + " on channel: " + juce::String(channel) + " with value: " + juce::String(pitchBendValue) + " at time " + juce::String(timestamp));
+			handleIncomingPitchBend(channel, pitchBendValue, target, timestamp);
+			DBG("Received pitch bend for plugin: " + target.pluginId + " on channel: " + juce::String(channel) + " with value: " + juce::String(pitchBendValue) + " at time " + juce::String(timestamp));
 		}
+		break;
 	}
-	else if (messageType == "program_change")
+	case OscCommands::Command::ProgramChange:
 	{
-		constexpr const char *context = "program_change";
-		if (!ensureMinOSCArguments(message, 3, context) ||
-			!ensureIntOSCArgument(message, 1, context) ||
-			!ensureTimestampOSCArgument(message, 2, context))
-		{
-			return;
-		}
-
-		int programNumber = message[1].getInt32();
-		juce::int64 timestamp = adjustTimestamp(message[2]);
-		std::vector<std::pair<juce::String, int>> pluginIdsAndChannels = extractPluginIdsAndChannels(message, 3);
-		for (const auto &[pluginId, channel] : pluginIdsAndChannels)
+		int programNumber = arguments.ints[0];
+		juce::int64 timestamp = adjustTimestamp(*arguments.timestamp);
+		for (const auto &[target, channel] : extractPluginIdsAndChannels(message, arguments.next))
 		{
-			handleIncomingProgramChange(channel, programNumber, pluginId, timestamp);
-			DBG("Received program change for plugin: " + pluginId + " on channel: " + juce::String(channel) + " to program: " + juce::String(programNumber));
+			handleIncomingProgramChange(channel, programNumber, target, timestamp);
+			DBG("Received program change for plugin: " + target.pluginId + " on channel: " + juce::String(channel) + " to program: " + juce::String(programNumber));
 		}
+		break;
 	}
-	else if (messageType == "save_plugin_data")
+	case OscCommands::Command::SavePluginData:
 	{
-		constexpr const char *context = "save_plugin_data";
-		if (!ensureMinOSCArguments(message, 4, context) ||
-			!ensureStringOSCArgument(message, 1, context) ||
-			!ensureStringOSCArgument(message, 2, context) ||
-			!ensureStringOSCArgument(message, 3, context))
-		{
-			return;
-		}
-
-		juce::String filePath = message[1].getString();
-		juce::String filename = message[2].getString();
-		juce::String tag = message[3].getString();
+		const juce::String &filePath = arguments.strings[0];
+		const juce::String &filename = arguments.strings[1];
+		const juce::String &tag = arguments.strings[2];
 
 		for (const auto &instrument : orchestra)
 		{
@@ -672,18 +1223,11 @@ void Conductor::oscProcessMIDIMessage(const juce::OSCMessage &message)
 				break;
 			}
 		}
+		break;
 	}
-	else if (messageType == "request_dawServerData")
+	case OscCommands::Command::RequestDawServerData:
 	{
-		constexpr const char *context = "request_dawServerData";
-		if (!ensureMinOSCArguments(message, 2, context) ||
-			!ensureStringOSCArgument(message, 1, context))
-		{
-			return;
-		}
-
-		std::vector<juce::String> tags = extractTags(message, 1);
-		juce::String tag = tags.empty() ? "" : tags[0];
+		const juce::String &tag = arguments.strings[0];
 
 		for (const auto &instrument : orchestra)
 		{
@@ -702,63 +1246,35 @@ void Conductor::oscProcessMIDIMessage(const juce::OSCMessage &message)
 				break;
 			}
 		}
+		break;
 	}
-	else if (messageType == "sync_request")
-	{
-		constexpr const char *context = "sync_request";
-		if (!ensureMinOSCArguments(message, 2, context) ||
-			!ensureStringOSCArgument(message, 1, context))
-		{
-			return;
-		}
-
-		juce::int64 timestamp = getTimestamp(message[1]);
-		DBG("Received sync request " << timestamp);
-
-		juce::int64 currentTime = juce::Time::getMillisecondCounter();
-		DBG("Current time: " << currentTime);
-
-		timestampOffset = currentTime;
-		DBG("Timestamp offset set as current time: " << timestampOffset);
-
-		pluginManager.resetPlayback();
-	}
-	else if (messageType == "stop_request")
+	case OscCommands::Command::SyncRequest:
+	case OscCommands::Command::StopRequest:
 	{
-		constexpr const char *context = "stop_request";
-		if (!ensureMinOSCArguments(message, 1, context))
-		{
-			return;
-		}
-
-		DBG("Received stop request ");
+		if (command.command == OscCommands::Command::SyncRequest)
+			DBG("Received sync request " << getTimestamp(message[firstArg]));
+		else
+			DBG("Received stop request ");
 
-		juce::int64 currentTime = juce::Time::getMillisecondCounter();
-		DBG("Current time: " << currentTime);
+		const double currentTimeMs = juce::Time::getMillisecondCounterHiRes();
+		DBG("Current time: " << currentTimeMs);
 
-		timestampOffset = currentTime;
-		DBG("Timestamp offset set as current time: " << timestampOffset);
+		timestampOffset = static_cast<juce::int64>(std::llround(currentTimeMs * 1000.0));
+		DBG("Timestamp offset set as current time: " << timestampOffset.load());
 
-		pluginManager.resetPlayback();
+		pluginManager.resetPlayback(currentTimeMs);
+		break;
 	}
-	else if (messageType == "load_plugin_data")
+	case OscCommands::Command::LoadPluginData:
 	{
-		constexpr const char *context = "load_plugin_data";
-		// Message format: "load_plugin_data", filepath, filename, then triplets of (instrument_name, tag, channel)
-		if (!ensureMinOSCArguments(message, 6, context) ||
-			!ensureStringOSCArgument(message, 1, context) ||
-			!ensureStringOSCArgument(message, 2, context))
-		{
-			return;
-		}
-
-		juce::String filepath = message[1].getString();
-		juce::String filename = message[2].getString();
+		// Arguments: filepath, filename, then triplets of (instrument_name, tag, channel)
+		juce::String filepath = arguments.strings[0];
+		juce::String filename = arguments.strings[1];
 
-		// Parse triplets of (instrument_name, tag, channel) starting from index 3
+		// Parse triplets of (instrument_name, tag, channel) after the file
 		// Each triplet should be (string, string, int)
 		std::vector<std::tuple<juce::String, juce::String, int>> tracks;
-		for (int i = 3; i + 2 < message.size(); i += 3)
+		for (int i = arguments.next; i + 2 < message.size(); i += 3)
 		{
 			if (!message[i].isString() || !message[i + 1].isString() || !message[i + 2].isInt32())
 			{
@@ -965,30 +1481,30 @@ void Conductor::oscProcessMIDIMessage(const juce::OSCMessage &message)
 
 		presetLoadBatchTimer = new TimerCallback(this);
 		presetLoadBatchTimer->startTimer(500); // 500ms debounce
+		break;
 	}
-	else
-	{
-		DBG("Error: Unknown OSC message type");
+	default:
+		DBG("OSC " << command.name << " is not a MIDI command");
+		break;
 	}
 }
 
 juce::int64 Conductor::getTimestamp(const juce::OSCArgument timestampArg)
 {
+	// Timestamps are carried in microseconds from here to the audio thread
 	if (timestampArg.isString())
 	{
-		juce::String timestampString = timestampArg.getString();
-		double timestampInSeconds = timestampString.getDoubleValue();
-		return static_cast<juce::int64>(timestampInSeconds * 1000.0);
+		return parseTimestampStringMicros(timestampArg.getString());
 	}
 	if (timestampArg.isFloat32())
 	{
 		double timestampInSeconds = timestampArg.getFloat32();
-		return static_cast<juce::int64>(timestampInSeconds * 1000.0);
+		return static_cast<juce::int64>(std::llround(timestampInSeconds * 1.0e6));
 	}
 	if (timestampArg.isInt32())
 	{
 		// Treat integer timestamps as milliseconds
-		return static_cast<juce::int64>(timestampArg.getInt32());
+		return static_cast<juce::int64>(timestampArg.getInt32()) * 1000;
 	}
 
 	DBG("Invalid OSC argument for timestamp: unsupported type.");
@@ -997,7 +1513,9 @@ juce::int64 Conductor::getTimestamp(const juce::OSCArgument timestampArg)
 
 juce::int64 Conductor::adjustTimestamp(const juce::OSCArgument timestampArg)
 {
-	auto adjustedStamp = getTimestamp(timestampArg) - timestampOffset; // time elapsed since the sync event in milliseconds
+	// Inside a timed bundle the bundle's time tag replaces the message's own timestamp
+	const auto hostStamp = activeBundle != nullptr && activeBundle->hasTime ? activeBundle->hostTimeUs : getTimestamp(timestampArg);
+	auto adjustedStamp = hostStamp - timestampOffset.load(); // time elapsed since the sync event in microseconds
 
 	// Handle negative timestamps
 	if (adjustedStamp <= 0)
@@ -1027,39 +1545,29 @@ std::vector<juce::String> Conductor::extractTags(const juce::OSCMessage &message
 
 bool Conductor::selectInstrumentByTag(const juce::String &tag)
 {
-	for (size_t i = 0; i < orchestra.size(); ++i)
-	{
-		const auto &instrument = orchestra[i];
-		if (std::find(instrument.tags.begin(), instrument.tags.end(), tag) != instrument.tags.end())
-		{
-			auto rowIndex = static_cast<int>(i);
-			juce::MessageManager::callAsync([this, rowIndex]()
-											{
-				if (mainComponent != nullptr)
-				{
-					mainComponent->getOrchestraTableModel().selectRow(rowIndex, juce::ModifierKeys());
-				} });
-			return true;
-		}
-	}
+	const int rowIndex = tagIndex.findFirstRow(tag);
+	if (rowIndex < 0 || rowIndex >= static_cast<int>(orchestra.size()))
+		return false;
 
-	return false;
+	juce::MessageManager::callAsync([this, rowIndex]()
+									{
+		if (mainComponent != nullptr)
+		{
+			mainComponent->getOrchestraTableModel().selectRow(rowIndex, juce::ModifierKeys());
+		} });
+	return true;
 }
 
 bool Conductor::openInstrumentByTag(const juce::String &tag)
 {
-	for (const auto &instrument : orchestra)
-	{
-		if (std::find(instrument.tags.begin(), instrument.tags.end(), tag) != instrument.tags.end())
-		{
-			juce::String pluginInstanceId = instrument.pluginInstanceId;
-			juce::MessageManager::callAsync([this, pluginInstanceId]()
-											{ pluginManager.openPluginWindow(pluginInstanceId); });
-			return true;
-		}
-	}
+	const auto targets = tagIndex.resolve({tag});
+	if (targets.empty())
+		return false;
 
-	return false;
+	juce::String pluginInstanceId = targets.front().pluginInstanceId;
+	juce::MessageManager::callAsync([this, pluginInstanceId]()
+									{ pluginManager.openPluginWindow(pluginInstanceId); });
+	return true;
 }
 
 int Conductor::calculateSampleOffsetForMessage(const juce::Time &messageTime, double sampleRate)
@@ -1075,61 +1583,53 @@ int Conductor::calculateSampleOffsetForMessage(const juce::Time &messageTime, do
 }
 
 // Handles incoming OSC messages related to note_on and note_off
-void Conductor::handleIncomingNote(juce::String messageType, int channel, int note, int velocity, const juce::String &pluginId, juce::int64 &timestamp)
+void Conductor::handleIncomingNote(bool noteOn, int channel, int note, int velocity, const PluginTarget &target, juce::int64 &timestamp)
 {
-	// Create a MIDI message based on the OSC message
-	juce::MidiMessage midiMessage;
-
-	if (messageType == "note_on")
-	{
-		midiMessage = juce::MidiMessage::noteOn(channel + 1, note, (juce::uint8)velocity); // JUCE channels are 1-based
-	}
-	else if (messageType == "note_off")
-	{
-		midiMessage = juce::MidiMessage::noteOff(channel + 1, note);
-	}
+	// Create a MIDI message based on the OSC message; JUCE channels are 1-based
+	juce::MidiMessage midiMessage = noteOn ? juce::MidiMessage::noteOn(channel + 1, note, (juce::uint8)velocity)
+										   : juce::MidiMessage::noteOff(channel + 1, note);
 
 	// Pass the message and tags to PluginManager
-	pluginManager.addMidiMessage(midiMessage, pluginId, timestamp);
+	sendToEngine(midiMessage, target, timestamp);
 }
 
 // Handles incoming OSC program change messages
-void Conductor::handleIncomingProgramChange(int channel, int programNumber, const juce::String &pluginId, juce::int64 &timestamp)
+void Conductor::handleIncomingProgramChange(int channel, int programNumber, const PluginTarget &target, juce::int64 &timestamp)
 {
 	// Create a MIDI Program Change message
 	juce::MidiMessage midiMessage = juce::MidiMessage::programChange(channel + 1, programNumber);
 
 	// Pass the message and tags to PluginManager
-	pluginManager.addMidiMessage(midiMessage, pluginId, timestamp);
+	sendToEngine(midiMessage, target, timestamp);
 }
 
 // Handles CC messages
-void Conductor::handleIncomingControlChange(int channel, int controllerNumber, int controllerValue, const juce::String &pluginId, juce::int64 &timestamp)
+void Conductor::handleIncomingControlChange(int channel, int controllerNumber, int controllerValue, const PluginTarget &target, juce::int64 &timestamp)
 {
 	// Create a MIDI Control Change message
 	juce::MidiMessage midiMessage = juce::MidiMessage::controllerEvent(channel + 1, controllerNumber, controllerValue);
 
 	// Pass the message and tags to PluginManager
-	pluginManager.addMidiMessage(midiMessage, pluginId, timestamp);
+	sendToEngine(midiMessage, target, timestamp);
 }
 
-void Conductor::scheduleControllerRamp(int channel, int controllerNumber, int startValue, int endValue, double durationSeconds, juce::int64 startTimestamp, const juce::String &pluginId)
+void Conductor::scheduleControllerRamp(int channel, int controllerNumber, int startValue, int endValue, double durationSeconds, juce::int64 startTimestamp, const PluginTarget &target)
 {
 	const double clampedDurationSeconds = juce::jmax(0.0, durationSeconds);
-	const double durationMs = clampedDurationSeconds * 1000.0;
-	const juce::int64 durationMillisRounded = static_cast<juce::int64>(std::round(durationMs));
-	const juce::int64 rampEndTimestamp = startTimestamp + durationMillisRounded;
+	const double durationUs = clampedDurationSeconds * 1.0e6;
+	const juce::int64 durationMicrosRounded = static_cast<juce::int64>(std::round(durationUs));
+	const juce::int64 rampEndTimestamp = startTimestamp + durationMicrosRounded;
 
-	constexpr juce::int64 targetStepMs = 20;
+	constexpr juce::int64 targetStepUs = 20000;
 	constexpr int maxSteps = 64;
 	int steps = 2;
-	if (durationMillisRounded > 0)
+	if (durationMicrosRounded > 0)
 	{
-		steps = static_cast<int>(juce::jmin<juce::int64>(maxSteps, (durationMillisRounded / targetStepMs) + 2));
+		steps = static_cast<int>(juce::jmin<juce::int64>(maxSteps, (durationMicrosRounded / targetStepUs) + 2));
 		steps = juce::jmax(2, steps);
 	}
 
-	const double intervalMs = (steps > 1) ? durationMs / static_cast<double>(steps - 1) : 0.0;
+	const double intervalUs = (steps > 1) ? durationUs / static_cast<double>(steps - 1) : 0.0;
 
 	for (int stepIndex = 0; stepIndex < steps; ++stepIndex)
 	{
@@ -1137,44 +1637,44 @@ void Conductor::scheduleControllerRamp(int channel, int controllerNumber, int st
 		const double value = startValue + (endValue - startValue) * ratio;
 		const int controllerValue = juce::jlimit(0, 127, static_cast<int>(std::round(value)));
 
-		const double eventTimeDouble = static_cast<double>(startTimestamp) + intervalMs * stepIndex;
+		const double eventTimeDouble = static_cast<double>(startTimestamp) + intervalUs * stepIndex;
 		juce::int64 eventTimestamp = static_cast<juce::int64>(std::round(eventTimeDouble));
 		if (stepIndex == steps - 1)
 			eventTimestamp = rampEndTimestamp;
 
 		juce::int64 scheduledTimestamp = eventTimestamp;
-		handleIncomingControlChange(channel, controllerNumber, controllerValue, pluginId, scheduledTimestamp);
+		handleIncomingControlChange(channel, controllerNumber, controllerValue, target, scheduledTimestamp);
 	}
 }
 
 // Handles channel aftertouch messages
-void Conductor::handleIncomingChannelAftertouch(int channel, int value, const juce::String &pluginId, juce::int64 &timestamp)
+void Conductor::handleIncomingChannelAftertouch(int channel, int value, const PluginTarget &target, juce::int64 &timestamp)
 {
 	// Create a MIDI Channel Aftertouch message
 	juce::MidiMessage midiMessage = juce::MidiMessage::channelPressureChange(channel + 1, (juce::uint8)value);
 
 	// Pass the message to PluginManager
-	pluginManager.addMidiMessage(midiMessage, pluginId, timestamp);
+	sendToEngine(midiMessage, target, timestamp);
 }
 
 // Add this method to handle polyphonic aftertouch messages
-void Conductor::handleIncomingPolyAftertouch(int channel, int note, int value, const juce::String &pluginId, juce::int64 &timestamp)
+void Conductor::handleIncomingPolyAftertouch(int channel, int note, int value, const PluginTarget &target, juce::int64 &timestamp)
 {
 	// Create a MIDI Polyphonic Aftertouch message
 	juce::MidiMessage midiMessage = juce::MidiMessage::aftertouchChange(channel + 1, note, (juce::uint8)value);
 
 	// Pass the message to PluginManager
-	pluginManager.addMidiMessage(midiMessage, pluginId, timestamp);
+	sendToEngine(midiMessage, target, timestamp);
 }
 
 // Add this method to handle pitch bend messages
-void Conductor::handleIncomingPitchBend(int channel, int pitchBendValue, const juce::String &pluginId, juce::int64 &timestamp)
+void Conductor::handleIncomingPitchBend(int channel, int pitchBendValue, const PluginTarget &target, juce::int64 &timestamp)
 {
 	// Create a MIDI Pitch Bend message
 	juce::MidiMessage midiMessage = juce::MidiMessage::pitchWheel(channel + 1, pitchBendValue);
 
 	// Pass the message to PluginManager
-	pluginManager.addMidiMessage(midiMessage, pluginId, timestamp);
+	sendToEngine(midiMessage, target, timestamp);
 }
 // Sync the orchestra list with PluginManager
 void Conductor::syncOrchestraWithPluginManager()
@@ -1209,6 +1709,33 @@ void Conductor::syncOrchestraWithPluginManager()
 	}
 
 	pluginManager.getAudioRouter().rebuildTagIndex(orchestra);
+	publishInstrumentRoutes();
+	applyInstrumentPriorities();
+}
+
+void Conductor::publishInstrumentRoutes()
+{
+	std::vector<InstrumentTagIndex::Row> rows;
+	rows.reserve(orchestra.size());
+	for (const auto &instrument : orchestra)
+		rows.push_back({instrument.tags, instrument.pluginInstanceId, instrument.midiChannel,
+						pluginManager.getPluginHandle(instrument.pluginInstanceId)});
+
+	tagIndex.update(std::move(rows));
+}
+
+void Conductor::applyInstrumentPriorities()
+{
+	std::map<juce::String, int> priorities;
+	for (const auto &instrument : orchestra)
+	{
+		auto [it, inserted] = priorities.emplace(instrument.pluginInstanceId, instrument.priority);
+		if (!inserted)
+			it->second = juce::jmax(it->second, instrument.priority);
+	}
+
+	for (const auto &[pluginId, priority] : priorities)
+		pluginManager.setPluginPriority(pluginId, priority);
 }
 
 void Conductor::saveOrchestraData(const juce::String &dataFilePath, const std::vector<InstrumentInfo> &selectedInstruments = {})
@@ -1234,6 +1761,7 @@ void Conductor::saveOrchestraData(const juce::String &dataFilePath, const std::v
 			instrumentElement->setAttribute("pluginName", instrument.pluginName);
 			instrumentElement->setAttribute("pluginInstanceId", instrument.pluginInstanceId);
 			instrumentElement->setAttribute("midiChannel", instrument.midiChannel);
+			instrumentElement->setAttribute("priority", instrument.priority);
 
 			// Save tags as a sub-element
 			juce::XmlElement *tagsElement = instrumentElement->createNewChildElement("Tags");
@@ -1277,6 +1805,7 @@ void Conductor::importOrchestraData(const juce::String &dataFilePath)
 				newInstrument.pluginName = instrumentElement->getStringAttribute("pluginName");
 				newInstrument.pluginInstanceId = instrumentElement->getStringAttribute("pluginInstanceId");
 				newInstrument.midiChannel = instrumentElement->getIntAttribute("midiChannel");
+				newInstrument.priority = instrumentElement->getIntAttribute("priority", CpuWatchdog::kDefaultPriority);
 
 				// Read tags from the "Tags" sub-element
 				if (auto *tagsElement = instrumentElement->getChildByName("Tags"))
@@ -1300,6 +1829,8 @@ void Conductor::importOrchestraData(const juce::String &dataFilePath)
 	{
 		DBG("Failed to open or parse XML file for restoring orchestra data: " + dataFilePath);
 	}
+
+	publishInstrumentRoutes();
 }
 
 void Conductor::saveAllData(const juce::String &dataFilePath, const juce::String &pluginDescFilePath, const juce::String &orchestraFilePath, const std::vector<InstrumentInfo> &selectedInstruments)
@@ -1320,18 +1851,29 @@ void Conductor::saveAllData(const juce::String &dataFilePath, const juce::String
 	saveOrchestraData(orchestraFilePath, selectedInstruments);
 }
 
-void Conductor::upsertAllData(const juce::String &dataFilePath, const juce::String &pluginDescFilePath, const juce::String &orchestraFilePath)
+void Conductor::upsertAllData(const juce::String &dataFilePath, const juce::String &pluginDescFilePath, const juce::String &orchestraFilePath,
+							  std::function<void()> onRestored)
 {
-	pluginManager.upsertPluginDescriptionsFromFile(pluginDescFilePath);
-	pluginManager.restoreAllPluginStates(dataFilePath);
-	importOrchestraData(orchestraFilePath);
+	pluginManager.upsertPluginDescriptionsFromFile(pluginDescFilePath, [this, dataFilePath, orchestraFilePath, onRestored]()
+	{
+		pluginManager.restoreAllPluginStates(dataFilePath);
+		importOrchestraData(orchestraFilePath);
+		if (onRestored)
+			onRestored();
+	});
 }
 
-void Conductor::restoreAllData(const juce::String &dataFilePath, const juce::String &pluginDescFilePath, const juce::String &orchestraFilePath)
+void Conductor::restoreAllData(const juce::String &dataFilePath, const juce::String &pluginDescFilePath, const juce::String &orchestraFilePath,
+							   std::function<void()> onRestored)
 {
-	pluginManager.restorePluginDescriptionsFromFile(pluginDescFilePath);
-	pluginManager.restoreAllPluginStates(dataFilePath);
-	restoreOrchestraData(orchestraFilePath);
+	// States can only be restored into loaded plugins
+	pluginManager.restorePluginDescriptionsFromFile(pluginDescFilePath, [this, dataFilePath, orchestraFilePath, onRestored]()
+	{
+		pluginManager.restoreAllPluginStates(dataFilePath);
+		restoreOrchestraData(orchestraFilePath);
+		if (onRestored)
+			onRestored();
+	});
 }
 
 // Path: OrchestraTableModel.cpp
@@ -1374,11 +1916,16 @@ void OrchestraTableModel::paintCell(juce::Graphics &g, int rowNumber, int column
 			g.drawText(juce::String(instrument.midiChannel), 2, 0, width, height, juce::Justification::centredLeft, true);
 			break;
 		case 5:
+		{
 			juce::String tags = convertVectorToString(instrument.tags);
 			g.drawText(tags, 2, 0, width, height, juce::Justification::centredLeft, true);
 
 			break;
 		}
+		case 6:
+			g.drawText(juce::String(instrument.priority), 2, 0, width, height, juce::Justification::centredLeft, true);
+			break;
+		}
 	}
 }
 
@@ -1466,6 +2013,7 @@ void OrchestraTableModel::renamePluginInstance(int rowNumber)
 			}
 
 			// Refresh the table to reflect the changes
+			mainComponent->getConductor().publishInstrumentRoutes();
 			mainComponent->orchestraTable.updateContent();
 		}
 
@@ -1541,6 +2089,8 @@ juce::String OrchestraTableModel::getText(int columnNumber, int rowNumber) const
 		return juce::String(info.midiChannel);
 	case 5:
 		return convertVectorToString(info.tags);
+	case 6:
+		return juce::String(info.priority);
 	default:
 		return "Invalid column number";
 	}
@@ -1576,9 +2126,17 @@ void OrchestraTableModel::setText(int columnNumber, int rowNumber, const juce::S
 		}
 		break;
 	}
+	case 6:
+		info.priority = juce::jlimit(CpuWatchdog::kMinPriority, CpuWatchdog::kProtectedPriority, newText.getIntValue());
+		if (mainComponent != nullptr)
+			mainComponent->getConductor().applyInstrumentPriorities();
+		break;
 	default:
 		break;
 	}
+
+	if (mainComponent != nullptr)
+		mainComponent->getConductor().publishInstrumentRoutes();
 }
 
 // Refresh component for editable cells
@@ -1777,6 +2335,7 @@ void EditableTextCustomComponent::prefixInstanceName()
 			}
 		}
 		// Refresh the table to reflect the changes
+		owner.mainComponent->getConductor().publishInstrumentRoutes();
 		owner.table.updateContent();
 	}
 }
@@ -1858,6 +2417,7 @@ void EditableTextCustomComponent::renameReferencesForSelectedRows()
 		}
 
 		// Refresh the table to reflect the changes
+		owner.mainComponent->getConductor().publishInstrumentRoutes();
 		owner.table.updateContent();
 	}
 }
@@ -1884,6 +2444,7 @@ void EditableTextCustomComponent::iterate_pluginInstances()
 	}
 
 	// Update table content to reflect the changes in the UI
+	owner.mainComponent->getConductor().publishInstrumentRoutes();
 	owner.table.updateContent();
 }
 
@@ -1917,6 +2478,7 @@ void EditableTextCustomComponent::showContextMenu_midiChannels()
 		}
 		
 		// Update table content to reflect the changes in the UI
+		owner.mainComponent->getConductor().publishInstrumentRoutes();
 		owner.table.updateContent(); });
 	contextMenu.addSubMenu("Replace MIDI Channel", midiChannelsMenu);
 	// remove this channel from overdub
@@ -2015,6 +2577,7 @@ void EditableTextCustomComponent::actionContextSelection(const juce::String &tex
 	}
 
 	// Update table content to reflect the changes in the UI
+	owner.mainComponent->getConductor().publishInstrumentRoutes();
 	owner.table.updateContent();
 }
 
@@ -3,6 +3,9 @@
 #include <JuceHeader.h>
 #include "PluginManager.h"
 #include "RenamePluginDialog.h"
+#include "InstrumentTagIndex.h"
+#include "OscCommands.h"
+#include <atomic>
 
 // Define a new struct to hold instrument information
 struct InstrumentInfo
@@ -12,18 +15,21 @@ struct InstrumentInfo
     juce::String pluginInstanceId;
     int midiChannel{ 0 };
     std::vector<juce::String> tags;
+    int priority{ CpuWatchdog::kDefaultPriority }; // CPU watchdog sheds lower priorities first
 
 };
 
 
-// Conductor class
+// Conductor class. OSC arrives on the receiver thread. MIDI events go straight from there to the engine; every
+// other command is queued and handled on the message thread, in the order it arrived.
 class Conductor : public juce::OSCReceiver,
-    public juce::OSCReceiver::ListenerWithOSCAddress<juce::OSCReceiver::MessageLoopCallback>,
-    public juce::OSCSender
+    public juce::OSCReceiver::Listener<juce::OSCReceiver::RealtimeCallback>,
+    public juce::OSCSender,
+    private juce::AsyncUpdater
 {
 public:
-    // Constructor: takes a reference to PluginManager
-    Conductor(PluginManager& pm, MidiManager& mm, MainComponent* mainComponentRef);
+    // Constructor: takes a reference to PluginManager. A headless conductor never opens a dialog.
+    Conductor(PluginManager& pm, MidiManager& mm, MainComponent* mainComponentRef, bool runHeadless = false);
 
     // Destructor
     ~Conductor() override;
@@ -45,7 +51,30 @@ public:
     // Callback function for receiving OSC messages
     void oscAddInstrumentCommand(const juce::OSCMessage& message);
     void oscMessageReceived(const juce::OSCMessage& message) override;
-    void oscProcessMIDIMessage(const juce::OSCMessage& message);
+    void oscBundleReceived(const juce::OSCBundle& bundle) override;
+    // Message thread: everything that is not on the MIDI hot path
+    void handleControlMessage(const juce::OSCMessage& message);
+    // A /midi/message or /midi/<name> command; its arguments start at firstArg. Realtime commands
+    // run on the receiver thread, the rest on the message thread.
+    void processMidiCommand(const OscCommands::Spec& command, const juce::OSCMessage& message, int firstArg);
+    // Message thread: an /orchestra command
+    void processOrchestraCommand(const OscCommands::Spec& command, const juce::OSCMessage& message, int firstArg);
+
+    // Message thread: updates the tag index the receiver thread reads. Call after editing orchestra.
+    void publishInstrumentRoutes();
+
+    // Replies on /engine/dsp_load/summary and /engine/dsp_load/plugin
+    void sendDspLoadReport();
+    // /engine/benchmark <name> [args]: runs a micro-benchmark and replies on /engine/benchmark/<name>
+    void runBenchmark(const juce::OSCMessage& message);
+    // One /engine/tempo_map/point message per tempo map point
+    void sendTempoMapReport();
+    // One /engine/process_group/group message per worker process, with its plugin count
+    void sendProcessGroupReport();
+    // One /engine/meters/bus message per metered bus, from the latest meter snapshot
+    void sendMeterReport();
+    // Streams sendMeterReport at rateHz from the message thread; 0 stops
+    void setMeterStreamRate(int rateHz);
 
     juce::int64 getTimestamp(const juce::OSCArgument timestampArg);
 	juce::int64 adjustTimestamp(const juce::OSCArgument timestamp);
@@ -56,20 +85,25 @@ public:
 
     void importOrchestraData(const juce::String& dataFilePath);
 
-    void upsertAllData(const juce::String& dataFilePath, const juce::String& pluginDescFilePath, const juce::String& orchestraFilePath);
+    // Plugins load in the background; onRestored runs on the message thread once all is in place
+    void upsertAllData(const juce::String& dataFilePath, const juce::String& pluginDescFilePath, const juce::String& orchestraFilePath,
+                       std::function<void()> onRestored = {});
     void saveAllData(const juce::String& dataFilePath, const juce::String& pluginDescFilePath, const juce::String& orchestraFilePath, const std::vector<InstrumentInfo>& selectedInstruments = {});
-    void restoreAllData(const juce::String& dataFilePath, const juce::String& pluginDescFilePath, const juce::String& orchestraFilePath);
+    void restoreAllData(const juce::String& dataFilePath, const juce::String& pluginDescFilePath, const juce::String& orchestraFilePath,
+                        std::function<void()> onRestored = {});
 
     // Vector to hold instrument information
     std::vector<InstrumentInfo> orchestra;
 
-    void handleIncomingPitchBend(int channel, int pitchBendValue, const juce::String& pluginId, juce::int64& timestamp);
+    void handleIncomingPitchBend(int channel, int pitchBendValue, const PluginTarget& target, juce::int64& timestamp);
 
     // Synchronize the orchestra with the PluginManager
     void syncOrchestraWithPluginManager();
+    // Pushes instrument priorities to the engine; a plugin shared by several instruments takes the highest
+    void applyInstrumentPriorities();
 
-	// juce::int64 variable to store the timestamp offset
-	juce::int64 timestampOffset = 0;
+	// Host time of the last sync/stop request in microseconds (Time::getMillisecondCounterHiRes)
+	std::atomic<juce::int64> timestampOffset{ 0 };
 
 private:
     // Reference to the PluginManager
@@ -80,19 +114,39 @@ private:
     // Helper function to extract tags from the OSC message
     std::vector<juce::String> extractTags(const juce::OSCMessage& message, int startIndex);
     int calculateSampleOffsetForMessage(const juce::Time& messageTime, double sampleRate);
-    std::vector<std::pair<juce::String, int>> extractPluginIdsAndChannels(const juce::OSCMessage& message, int startIndex);
+    // Resolves tags to plugin handles once per message, off the audio thread
+    std::vector<std::pair<PluginTarget, int>> extractPluginIdsAndChannels(const juce::OSCMessage& message, int startIndex);
     bool selectInstrumentByTag(const juce::String& tag);
     bool openInstrumentByTag(const juce::String& tag);
 
+    // The orchestra's tags as the receiver thread sees them, updated by publishInstrumentRoutes
+    InstrumentTagIndex tagIndex;
+    // Set when plugin handles change; the next async update republishes the routes with them
+    std::atomic<bool> routesStale{ false };
+
+    // Receiver thread: note, controller and sync traffic that never waits for the message thread
+    bool routeIncomingMessage(const juce::OSCMessage& message);
+    bool collectBundle(const juce::OSCBundle& bundle);
+    void processMidiBatch(const juce::OSCMessage& message);
+    void sendToEngine(const juce::MidiMessage& midiMessage, const PluginTarget& target, juce::int64& timestamp);
+    void raiseReceiverThreadPriority();
+    std::atomic<juce::Thread*> raisedReceiverThread{ nullptr };
+
+    // Control messages waiting for the message thread, and stale routes
+    void handleAsyncUpdate() override;
+    juce::CriticalSection pendingControlLock;
+    std::vector<juce::OSCMessage> pendingControlMessages;
+
     std::vector<juce::String> lastTags = {};
     // Handles incoming OSC messages
-    void handleIncomingNote(juce::String messageType, int channel, int note, int velocity, const juce::String& pluginId, juce::int64& timestamp);
-    void handleIncomingProgramChange(int channel, int programNumber, const juce::String& pluginId, juce::int64& timestamp);
-    void handleIncomingControlChange(int channel, int controllerNumber, int controllerValue, const juce::String& pluginId, juce::int64& timestamp);
-    void scheduleControllerRamp(int channel, int controllerNumber, int startValue, int endValue, double durationSeconds, juce::int64 startTimestamp, const juce::String& pluginId);
-    void handleIncomingChannelAftertouch(int channel, int value, const juce::String& pluginId, juce::int64& timestamp);
-    void handleIncomingPolyAftertouch(int channel, int note, int value, const juce::String& pluginId, juce::int64& timestamp);
+    void handleIncomingNote(bool noteOn, int channel, int note, int velocity, const PluginTarget& target, juce::int64& timestamp);
+    void handleIncomingProgramChange(int channel, int programNumber, const PluginTarget& target, juce::int64& timestamp);
+    void handleIncomingControlChange(int channel, int controllerNumber, int controllerValue, const PluginTarget& target, juce::int64& timestamp);
+    void scheduleControllerRamp(int channel, int controllerNumber, int startValue, int endValue, double durationSeconds, juce::int64 startTimestamp, const PluginTarget& target);
+    void handleIncomingChannelAftertouch(int channel, int value, const PluginTarget& target, juce::int64& timestamp);
+    void handleIncomingPolyAftertouch(int channel, int note, int value, const PluginTarget& target, juce::int64& timestamp);
     MainComponent* mainComponent;  // Reference to the MainComponent object
+    const bool headless;
 
     // Preset loading batch management
     struct PendingPresetLoad {
@@ -104,6 +158,9 @@ private:
     std::vector<PendingPresetLoad> pendingPresetLoads;
     juce::Timer* presetLoadBatchTimer = nullptr;
     void processPendingPresetLoads();
+    void loadPresets(const std::vector<PendingPresetLoad>& presetLoads);
+
+    std::unique_ptr<juce::Timer> meterStreamTimer;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Conductor)
 };
@@ -0,0 +1,167 @@
+#include "CpuWatchdog.h"
+
+namespace
+{
+    constexpr double kLoadSmoothing = 0.1;     // per callback
+    constexpr double kDegradeStepMs = 50.0;    // at most one plugin shed per interval
+    constexpr double kRestoreHoldMs = 2000.0;  // headroom needed before each restore
+    constexpr int kWriteIntervalMs = 250;
+    constexpr size_t kRecentLogLines = 200;
+}
+
+class CpuWatchdog::LogWriter : public juce::Thread
+{
+public:
+    explicit LogWriter(CpuWatchdog& ownerRef)
+        : juce::Thread("CPU watchdog log"),
+          owner(ownerRef)
+    {
+    }
+
+    ~LogWriter() override
+    {
+        signalThreadShouldExit();
+        notify();
+        stopThread(2000);
+    }
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            wait(kWriteIntervalMs);
+            owner.writePendingSteps();
+        }
+    }
+
+private:
+    CpuWatchdog& owner;
+};
+
+CpuWatchdog::CpuWatchdog()
+{
+    auto logFile = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+                       .getChildFile("OSCDawServer")
+                       .getChildFile("cpu_watchdog.log");
+    logFile.getParentDirectory().createDirectory();
+    fileLogger = std::make_unique<juce::FileLogger>(logFile, "OSCDawServer CPU watchdog", 1024 * 1024);
+
+    writer = std::make_unique<LogWriter>(*this);
+    writer->startThread(juce::Thread::Priority::low);
+}
+
+CpuWatchdog::~CpuWatchdog()
+{
+    writer.reset();
+    writePendingSteps();
+}
+
+void CpuWatchdog::setThresholds(float degradePercent, float restorePercent)
+{
+    degradeThreshold.store(degradePercent);
+    restoreThreshold.store(juce::jmin(restorePercent, degradePercent));
+    DBG("CPU watchdog: degrade at " << degradePercent << "%, restore below " << restorePercent << "%");
+}
+
+CpuWatchdog::Action CpuWatchdog::update(double loadPercent, double blockMs, bool anyShed)
+{
+    smoothedLoad += (loadPercent - smoothedLoad) * kLoadSmoothing;
+    msSinceStep += blockMs;
+
+    const auto degrade = degradeThreshold.load(std::memory_order_relaxed);
+    if (degrade <= 0.0f)
+        return anyShed ? Action::Restore : Action::None;
+
+    // Overloads react to the single callback; restores wait for sustained smoothed headroom
+    if (loadPercent >= degrade)
+    {
+        headroomMs = 0.0;
+        if (msSinceStep < kDegradeStepMs)
+            return Action::None;
+
+        msSinceStep = 0.0;
+        return Action::Degrade;
+    }
+
+    if (!anyShed)
+        return Action::None;
+
+    if (smoothedLoad < restoreThreshold.load(std::memory_order_relaxed))
+        headroomMs += blockMs;
+    else
+        headroomMs = 0.0;
+
+    if (headroomMs < kRestoreHoldMs)
+        return Action::None;
+
+    headroomMs = 0.0;
+    msSinceStep = 0.0;
+    return Action::Restore;
+}
+
+void CpuWatchdog::logStep(Action action, const juce::String& pluginId, int priority, double loadPercent, int numShed)
+{
+    const auto scope = stepFifo.write(1);
+    if (scope.blockSize1 + scope.blockSize2 == 0)
+    {
+        droppedSteps.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto& step = steps[(size_t) (scope.blockSize1 > 0 ? scope.startIndex1 : scope.startIndex2)];
+    step.hostMs = juce::Time::getMillisecondCounterHiRes();
+    step.action = action;
+    step.pluginId = pluginId;
+    step.priority = priority;
+    step.loadPercent = (float) loadPercent;
+    step.numShed = numShed;
+}
+
+juce::StringArray CpuWatchdog::getRecentLog() const
+{
+    const juce::ScopedLock sl(logLock);
+    juce::StringArray lines;
+    for (const auto& line : recentLog)
+        lines.add(line);
+    return lines;
+}
+
+void CpuWatchdog::writePendingSteps()
+{
+    const juce::ScopedLock sl(logLock);
+
+    juce::StringArray lines;
+    if (const auto dropped = droppedSteps.exchange(0, std::memory_order_relaxed); dropped > 0)
+        lines.add("CPU watchdog: " + juce::String((int) dropped) + " steps not logged (queue full)");
+
+    auto describe = [&lines](Step& step)
+    {
+        juce::String line;
+        line << "CPU watchdog @" << juce::String(step.hostMs / 1000.0, 3) << "s: "
+             << (step.action == Action::Degrade ? "shed " : "restored ")
+             << step.pluginId << " (priority " << step.priority << ")"
+             << " at " << juce::String(step.loadPercent, 1) << "% load, "
+             << step.numShed << " plugin(s) now shed";
+        lines.add(line);
+        step.pluginId = {};
+    };
+
+    {
+        const auto scope = stepFifo.read(stepFifo.getNumReady());
+        for (int i = 0; i < scope.blockSize1; ++i)
+            describe(steps[(size_t) (scope.startIndex1 + i)]);
+        for (int i = 0; i < scope.blockSize2; ++i)
+            describe(steps[(size_t) (scope.startIndex2 + i)]);
+    }
+
+    for (const auto& line : lines)
+    {
+        DBG(line);
+        if (fileLogger != nullptr)
+            fileLogger->logMessage(line);
+        recentLog.push_back(line);
+    }
+
+    while (recentLog.size() > kRecentLogLines)
+        recentLog.pop_front();
+}
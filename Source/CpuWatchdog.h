@@ -0,0 +1,80 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <memory>
+
+// Decides when the live engine should shed or restore a plugin to keep the audio callback
+// inside its deadline. Shedding is one plugin per step, lowest priority first; plugins at
+// kProtectedPriority are never shed. update() runs on the audio thread and never blocks:
+// each step it approves is queued and written to the degradation log by a background thread.
+class CpuWatchdog
+{
+public:
+    static constexpr int kMinPriority = 0;
+    static constexpr int kProtectedPriority = 10;
+    static constexpr int kDefaultPriority = 5;
+
+    enum class Action
+    {
+        None,
+        Degrade,
+        Restore
+    };
+
+    CpuWatchdog();
+    ~CpuWatchdog();
+
+    // Any thread. A degrade threshold <= 0 disables shedding; already shed plugins are restored.
+    void setThresholds(float degradePercent, float restorePercent);
+    float getDegradeThreshold() const { return degradeThreshold.load(); }
+    float getRestoreThreshold() const { return restoreThreshold.load(); }
+
+    // Audio thread, once per callback with its load as a percentage of the buffer period.
+    // anyShed tells the watchdog whether there is anything left to restore.
+    Action update(double loadPercent, double blockMs, bool anyShed);
+
+    // Audio thread: records the step the engine actually took. Copying the id only bumps its
+    // reference count; the logging thread releases it.
+    void logStep(Action action, const juce::String& pluginId, int priority, double loadPercent, int numShed);
+
+    // Most recent log lines, oldest first
+    juce::StringArray getRecentLog() const;
+
+private:
+    class LogWriter;
+
+    struct Step
+    {
+        double hostMs = 0.0;
+        Action action = Action::None;
+        juce::String pluginId;
+        int priority = 0;
+        float loadPercent = 0.0f;
+        int numShed = 0;
+    };
+
+    void writePendingSteps();
+
+    std::atomic<float> degradeThreshold{ 90.0f };
+    std::atomic<float> restoreThreshold{ 60.0f };
+
+    // Audio thread only
+    double smoothedLoad = 0.0;
+    double msSinceStep = 0.0;
+    double headroomMs = 0.0;
+
+    static constexpr int kStepQueueSize = 256;
+    juce::AbstractFifo stepFifo{ kStepQueueSize };
+    std::array<Step, kStepQueueSize> steps;
+    std::atomic<juce::uint32> droppedSteps{ 0 };
+
+    mutable juce::CriticalSection logLock;
+    std::deque<juce::String> recentLog;
+    std::unique_ptr<juce::FileLogger> fileLogger;
+    std::unique_ptr<LogWriter> writer;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CpuWatchdog)
+};
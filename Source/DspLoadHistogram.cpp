@@ -0,0 +1,81 @@
+#include "DspLoadHistogram.h"
+#include <cmath>
+#include <limits>
+
+DspLoadHistogram::DspLoadHistogram()
+{
+    reset();
+}
+
+void DspLoadHistogram::record(double loadPercent)
+{
+    const double load = juce::jmax(0.0, loadPercent);
+    const int bin = juce::jmin(kNumBins - 1, (int) (load / kBinWidthPercent));
+    const auto hundredths = (juce::uint32) juce::jmin(load * 100.0, (double) std::numeric_limits<juce::uint32>::max());
+
+    bins[(size_t) bin].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sumHundredths.fetch_add(hundredths, std::memory_order_relaxed);
+    if (load >= 100.0)
+        overruns.fetch_add(1, std::memory_order_relaxed);
+
+    auto previousMax = maxHundredths.load(std::memory_order_relaxed);
+    while (hundredths > previousMax
+           && !maxHundredths.compare_exchange_weak(previousMax, hundredths, std::memory_order_relaxed))
+    {
+    }
+}
+
+void DspLoadHistogram::recordTicks(juce::int64 elapsedTicks, double budgetTicks)
+{
+    if (budgetTicks > 0.0)
+        record(100.0 * (double) elapsedTicks / budgetTicks);
+}
+
+DspLoadHistogram::Summary DspLoadHistogram::getSummary() const
+{
+    // Fields are read one by one while the audio thread may still be recording, so a
+    // summary can be off by the block in flight
+    Summary summary;
+    summary.count = count.load(std::memory_order_relaxed);
+    summary.overruns = overruns.load(std::memory_order_relaxed);
+    summary.maxPercent = maxHundredths.load(std::memory_order_relaxed) / 100.0;
+    if (summary.count == 0)
+        return summary;
+
+    summary.meanPercent = (double) sumHundredths.load(std::memory_order_relaxed) / 100.0 / (double) summary.count;
+
+    // Upper edge of the bin holding the 99th percentile, capped by the exact maximum
+    const auto target = (juce::uint64) std::ceil((double) summary.count * 0.99);
+    juce::uint64 seen = 0;
+    for (int i = 0; i < kNumBins; ++i)
+    {
+        seen += bins[(size_t) i].load(std::memory_order_relaxed);
+        if (seen >= target)
+        {
+            summary.p99Percent = juce::jmin((i + 1) * kBinWidthPercent, summary.maxPercent);
+            break;
+        }
+    }
+
+    return summary;
+}
+
+void DspLoadHistogram::reset()
+{
+    for (auto& bin : bins)
+        bin.store(0, std::memory_order_relaxed);
+    count.store(0, std::memory_order_relaxed);
+    sumHundredths.store(0, std::memory_order_relaxed);
+    maxHundredths.store(0, std::memory_order_relaxed);
+    overruns.store(0, std::memory_order_relaxed);
+}
+
+double DspLoadHistogram::budgetTicksFor(int numSamples, double sampleRate)
+{
+    if (numSamples <= 0 || sampleRate <= 0.0)
+        return 0.0;
+
+    static const double ticksPerSecond = (double) juce::Time::getHighResolutionTicksPerSecond();
+    return (double) numSamples / sampleRate * ticksPerSecond;
+}
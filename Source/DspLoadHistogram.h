@@ -0,0 +1,44 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+// Distribution of processing time as a share of the block budget (the buffer period).
+// Recording is lock free and allocation free, so it runs inside the audio callback; any
+// thread may summarise or reset. Loads at or above 100% count as overruns.
+class DspLoadHistogram
+{
+public:
+    static constexpr int kNumBins = 512;
+    static constexpr double kBinWidthPercent = 0.5; // bins cover 0-256%, the last also holds anything above
+
+    struct Summary
+    {
+        juce::uint64 count = 0;
+        double meanPercent = 0.0;
+        double p99Percent = 0.0;
+        double maxPercent = 0.0;
+        juce::uint64 overruns = 0;
+    };
+
+    DspLoadHistogram();
+
+    void record(double loadPercent);
+    // Time measured with juce::Time::getHighResolutionTicks against budgetTicksFor()
+    void recordTicks(juce::int64 elapsedTicks, double budgetTicks);
+    Summary getSummary() const;
+    void reset();
+
+    // High-resolution ticks in one block of numSamples at sampleRate
+    static double budgetTicksFor(int numSamples, double sampleRate);
+
+private:
+    std::array<std::atomic<juce::uint32>, kNumBins> bins;
+    std::atomic<juce::uint64> count{ 0 };
+    std::atomic<juce::uint64> sumHundredths{ 0 }; // load summed in 0.01% units
+    std::atomic<juce::uint32> maxHundredths{ 0 };
+    std::atomic<juce::uint64> overruns{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE(DspLoadHistogram)
+};
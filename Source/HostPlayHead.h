@@ -10,16 +10,32 @@
 
 #pragma once
 #include <JuceHeader.h>
+#include <array>
+#include <atomic>
 
+// Transport position for the block being processed. The engine publishes a complete copy
+// before each block, and before each piece of a block split at a tempo change; plugins read
+// whichever copy is current, so one running on a worker thread never sees a half-written one.
 struct HostPlayHead : public juce::AudioPlayHead
 {
-    PositionInfo positionInfo;
+    // One writer at a time: the audio callback, or a render while the callback is locked out
+    void publish(const PositionInfo& info)
+    {
+        const int next = (published.load(std::memory_order_relaxed) + 1) % kNumPositions;
+        positions[(size_t) next] = info;
+        published.store(next, std::memory_order_release);
+    }
 
     // JUCE 6+ / JUCE 8 callback must be const
     juce::Optional<PositionInfo> getPosition() const override
     {
-        return positionInfo;
+        return positions[(size_t) published.load(std::memory_order_acquire)];
     }
+
+private:
+    static constexpr int kNumPositions = 4;
+    std::array<PositionInfo, kNumPositions> positions{};
+    std::atomic<int> published{ 0 };
 };
 
 // declare the global  every .cpp that includes this sees the name
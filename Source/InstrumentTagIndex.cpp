@@ -0,0 +1,169 @@
+#include "InstrumentTagIndex.h"
+#include <algorithm>
+
+InstrumentTagIndex::InstrumentTagIndex()
+    : idsByTag(std::make_shared<TagIds>()),
+      bucketsById(1, nullptr)
+{
+    published.publish(std::make_unique<Version>(Version{ idsByTag, bucketsById }));
+}
+
+void InstrumentTagIndex::update(std::vector<Row> newRows)
+{
+    // Rows are compared by position: editing a row touches its tags alone, while an insert
+    // or removal re-indexes the rows that moved
+    std::set<juce::String> touchedTags;
+    const size_t numRows = juce::jmax(rows.size(), newRows.size());
+    for (size_t i = 0; i < numRows; ++i)
+    {
+        const bool hadRow = i < rows.size();
+        const bool hasRow = i < newRows.size();
+        if (hadRow && hasRow && rows[i] == newRows[i])
+            continue;
+
+        if (hadRow)
+            unindexRow((int)i, rows[i], touchedTags);
+        if (hasRow)
+            indexRow((int)i, newRows[i], touchedTags);
+    }
+
+    rows = std::move(newRows);
+    if (touchedTags.empty())
+        return;
+
+    // The id map is copied only when a tag is seen for the first time
+    std::shared_ptr<TagIds> grownIds;
+    for (const auto& tag : touchedTags)
+    {
+        auto it = rowsByTag.find(tag);
+        const auto& ids = grownIds != nullptr ? *grownIds : *idsByTag;
+        auto idIt = ids.find(tag);
+        if (it == rowsByTag.end() || it->second.empty())
+        {
+            if (it != rowsByTag.end())
+                rowsByTag.erase(it);
+            if (idIt != ids.end())
+                bucketsById[idIt->second] = nullptr;
+            continue;
+        }
+
+        juce::uint32 id;
+        if (idIt != ids.end())
+        {
+            id = idIt->second;
+        }
+        else
+        {
+            if (grownIds == nullptr)
+                grownIds = std::make_shared<TagIds>(*idsByTag);
+            id = (juce::uint32)bucketsById.size();
+            grownIds->emplace(tag, id);
+            bucketsById.push_back(nullptr);
+        }
+        bucketsById[id] = buildBucket(it->second);
+    }
+
+    if (grownIds != nullptr)
+        idsByTag = std::move(grownIds);
+    published.publish(std::make_unique<Version>(Version{ idsByTag, bucketsById }));
+}
+
+void InstrumentTagIndex::indexRow(int rowIndex, const Row& row, std::set<juce::String>& touchedTags)
+{
+    for (const auto& tag : row.tags)
+    {
+        if (tag.isEmpty())
+            continue;
+
+        rowsByTag[tag].insert(rowIndex);
+        touchedTags.insert(tag);
+    }
+}
+
+void InstrumentTagIndex::unindexRow(int rowIndex, const Row& row, std::set<juce::String>& touchedTags)
+{
+    for (const auto& tag : row.tags)
+    {
+        auto it = rowsByTag.find(tag);
+        if (it == rowsByTag.end())
+            continue;
+
+        it->second.erase(rowIndex);
+        touchedTags.insert(tag);
+    }
+}
+
+std::shared_ptr<const InstrumentTagIndex::Bucket> InstrumentTagIndex::buildBucket(const std::set<int>& rowIndices) const
+{
+    auto bucket = std::make_shared<Bucket>();
+    bucket->firstRow = *rowIndices.begin();
+
+    // Several rows can share a plugin and channel; they play it once
+    std::set<std::pair<juce::String, int>> seen;
+    for (const int rowIndex : rowIndices)
+    {
+        const auto& row = rows[(size_t)rowIndex];
+        if (seen.emplace(row.pluginInstanceId, row.midiChannel).second)
+            bucket->targets.push_back({ row.pluginInstanceId, row.midiChannel, row.handle });
+    }
+    return bucket;
+}
+
+std::vector<InstrumentTagIndex::Target> InstrumentTagIndex::resolve(const std::vector<juce::String>& tags) const
+{
+    std::vector<Target> targets;
+    const RcuDomain::ReadScope readScope(domain);
+    const auto& version = *published.get();
+
+    for (const auto& tag : tags)
+    {
+        const auto* bucket = findBucket(version, tag);
+        if (bucket == nullptr)
+            continue;
+
+        // A bucket is already distinct, so only a second tag can repeat a target
+        const bool checkRepeats = !targets.empty();
+        for (const auto& target : bucket->targets)
+        {
+            if (checkRepeats && std::any_of(targets.begin(), targets.end(), [&target](const Target& existing)
+                                            { return existing.midiChannel == target.midiChannel && existing.pluginInstanceId == target.pluginInstanceId; }))
+                continue;
+
+            targets.push_back(target);
+        }
+    }
+    return targets;
+}
+
+int InstrumentTagIndex::findFirstRow(const juce::String& tag) const
+{
+    const RcuDomain::ReadScope readScope(domain);
+    const auto* bucket = findBucket(*published.get(), tag);
+    return bucket != nullptr ? bucket->firstRow : -1;
+}
+
+juce::uint32 InstrumentTagIndex::getTagId(const juce::String& tag) const
+{
+    const RcuDomain::ReadScope readScope(domain);
+    const auto& ids = *published.get()->idsByTag;
+    auto it = ids.find(tag);
+    return it != ids.end() ? it->second : 0;
+}
+
+InstrumentTagIndex::SharedTargets InstrumentTagIndex::resolveId(juce::uint32 tagId) const
+{
+    const RcuDomain::ReadScope readScope(domain);
+    const auto& bucketsById = published.get()->bucketsById;
+    if (tagId == 0 || tagId >= bucketsById.size() || bucketsById[tagId] == nullptr)
+        return nullptr;
+
+    // Buckets are immutable once published, so holding one keeps its targets as they were
+    const auto& bucket = bucketsById[tagId];
+    return SharedTargets(bucket, &bucket->targets);
+}
+
+const InstrumentTagIndex::Bucket* InstrumentTagIndex::findBucket(const Version& version, const juce::String& tag)
+{
+    auto it = version.idsByTag->find(tag);
+    return it != version.idsByTag->end() ? version.bucketsById[it->second].get() : nullptr;
+}
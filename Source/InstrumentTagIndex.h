@@ -0,0 +1,93 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginHandle.h"
+#include "RcuDomain.h"
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+// Tag to instrument lookup for OSC routing. Tags match exactly, as OSC routing always has.
+// Each tag maps to its distinct (plugin, channel) targets in orchestra order, with the
+// plugin's handle, so resolving a note costs a hash lookup however large the orchestra is.
+// The message thread updates the index after orchestra edits and whenever plugin handles
+// change; any thread resolves against the published version without locking. Every tag also
+// gets a numeric id, kept for as long as the index lives, so binary clients can address a
+// tag without sending its name.
+class InstrumentTagIndex
+{
+public:
+    struct Row
+    {
+        std::vector<juce::String> tags;
+        juce::String pluginInstanceId;
+        int midiChannel = 0;   // 1 based, as in the orchestra
+        PluginHandle handle = kInvalidPluginHandle;   // as the plugin manager has it now
+
+        bool operator==(const Row& other) const
+        {
+            return midiChannel == other.midiChannel && handle == other.handle
+                && pluginInstanceId == other.pluginInstanceId && tags == other.tags;
+        }
+    };
+
+    struct Target
+    {
+        juce::String pluginInstanceId;
+        int midiChannel = 0;   // 1 based
+        PluginHandle handle = kInvalidPluginHandle;
+    };
+    // Targets as published, shared with the index rather than copied
+    using SharedTargets = std::shared_ptr<const std::vector<Target>>;
+
+    InstrumentTagIndex();
+
+    // One writer at a time. Only rows that differ from the previous update are re-indexed,
+    // and only the tags they carry (or carried) are rebuilt before the new index is published.
+    void update(std::vector<Row> rows);
+
+    // Any thread. Targets of all the tags, each (plugin, channel) once however many tags hit it.
+    std::vector<Target> resolve(const std::vector<juce::String>& tags) const;
+    // Any thread. The first orchestra row carrying the tag, or -1
+    int findFirstRow(const juce::String& tag) const;
+
+    // Any thread. The tag's id, or 0 for a tag the orchestra has never carried
+    juce::uint32 getTagId(const juce::String& tag) const;
+    // Any thread. Targets of the tag with that id, shared rather than copied and valid for as
+    // long as they are held; null for 0, unknown ids or tags no row carries now
+    SharedTargets resolveId(juce::uint32 tagId) const;
+
+private:
+    struct Bucket
+    {
+        int firstRow = -1;
+        std::vector<Target> targets;
+    };
+    // Every tag ever indexed. Only grows, so versions share it until a new tag arrives.
+    using TagIds = std::unordered_map<juce::String, juce::uint32>;
+    // Buckets are shared between versions too, so publishing copies pointers, not targets
+    struct Version
+    {
+        std::shared_ptr<const TagIds> idsByTag;
+        std::vector<std::shared_ptr<const Bucket>> bucketsById;     // id 0 unused; null while no row has the tag
+    };
+
+    static const Bucket* findBucket(const Version& version, const juce::String& tag);
+
+    void indexRow(int rowIndex, const Row& row, std::set<juce::String>& touchedTags);
+    void unindexRow(int rowIndex, const Row& row, std::set<juce::String>& touchedTags);
+    std::shared_ptr<const Bucket> buildBucket(const std::set<int>& rowIndices) const;
+
+    mutable RcuDomain domain;
+    RcuSnapshot<Version> published{ domain };
+
+    // Writer side: the rows as of the last update, which of them carry each tag, and what
+    // the next version starts from
+    std::vector<Row> rows;
+    std::unordered_map<juce::String, std::set<int>> rowsByTag;
+    std::shared_ptr<const TagIds> idsByTag;
+    std::vector<std::shared_ptr<const Bucket>> bucketsById;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(InstrumentTagIndex)
+};
@@ -9,6 +9,8 @@
 #include <JuceHeader.h>
 #include <functional>
 #include "MainComponent.h"
+#include "PluginWorkerProcess.h"
+#include "NullAudioDevice.h"
 
 namespace
 {
@@ -101,12 +103,25 @@ public:
 
     const juce::String getApplicationName() override       { return ProjectInfo::projectName; }
     const juce::String getApplicationVersion() override    { return ProjectInfo::versionString; }
-    bool moreThanOneInstanceAllowed() override             { return false; }
+    bool moreThanOneInstanceAllowed() override             { return PluginWorkerProcess::isWorkerCommandLine (getCommandLineParameters()); }
 
     //==============================================================================
     void initialise (const juce::String& commandLine) override
     {
-        juce::ignoreUnused(commandLine);
+        // Started by the engine to host plugins out of process: no window, no tray icon
+        if (PluginWorkerProcess::isWorkerCommandLine (commandLine))
+        {
+            pluginWorker = std::make_unique<PluginWorkerProcess>();
+            if (!pluginWorker->initialiseFromCommandLine (commandLine, PluginWorkerProtocol::kProcessUid))
+                quit();
+            return;
+        }
+
+        if (isHeadlessCommandLine (commandLine))
+        {
+            startHeadless (commandLine);
+            return;
+        }
 
         splashScreen = std::make_unique<SplashComponent>();
 
@@ -122,12 +137,60 @@ public:
     void shutdown() override
     {
         // Add your application's shutdown code here..
+        pluginWorker = nullptr;
+        headlessServer = nullptr;
         trayIconComponent = nullptr;
         mainWindow = nullptr; // (deletes our window)
         splashScreen = nullptr;
     }
 
     //==============================================================================
+    //==============================================================================
+    // Console launch: DAWSERVER --headless [--project <file.oscdaw>] [--audio-driver <type>] [--null-audio]
+    // Headless builds (OSCDAW_HEADLESS) always start this way.
+    static bool isHeadlessCommandLine (const juce::String& commandLine)
+    {
+       #if OSCDAW_HEADLESS
+        juce::ignoreUnused (commandLine);
+        return true;
+       #else
+        return juce::ArgumentList ("DAWSERVER", commandLine).containsOption ("--headless");
+       #endif
+    }
+
+    void startHeadless (const juce::String& commandLine)
+    {
+        const auto startMs = juce::Time::getMillisecondCounterHiRes();
+        const juce::ArgumentList args ("DAWSERVER", commandLine);
+
+        // The server's components are built but never put on screen, so nothing paints
+        headlessServer = std::make_unique<MainComponent> (true);
+
+        const auto driver = args.containsOption ("--null-audio") ? juce::String (NullAudioIODevice::kTypeName)
+                                                                   : args.getValueForOption ("--audio-driver");
+        if (driver.isNotEmpty())
+            headlessServer->setSelectedAudioDriver (driver);
+
+        auto& deviceManager = headlessServer->getPluginManager().getDeviceManager();
+        if (auto* device = deviceManager.getCurrentAudioDevice())
+            juce::Logger::writeToLog ("Audio device: " + deviceManager.getCurrentAudioDeviceType() + " / " + device->getName());
+        else
+            juce::Logger::writeToLog ("No audio device open; pass --null-audio to run without one");
+
+        const auto project = args.getValueForOption ("--project").unquoted();
+        if (project.isNotEmpty())
+        {
+            const auto projectFile = juce::File::getCurrentWorkingDirectory().getChildFile (project);
+            if (projectFile.existsAsFile())
+                headlessServer->restoreProject (false, projectFile);
+            else
+                juce::Logger::writeToLog ("Project not found: " + projectFile.getFullPathName());
+        }
+
+        juce::Logger::writeToLog ("OSCDawServer running headless, started in "
+                                  + juce::String (juce::Time::getMillisecondCounterHiRes() - startMs, 0) + " ms");
+    }
+
     void systemRequestedQuit() override
     {
         // This is called when the app is being asked to quit: you can ignore this
@@ -293,6 +356,8 @@ private:
     std::unique_ptr<MainWindow> mainWindow;
     std::unique_ptr<TrayIconComponent> trayIconComponent;
     std::unique_ptr<SplashComponent> splashScreen;
+    std::unique_ptr<PluginWorkerProcess> pluginWorker;
+    std::unique_ptr<MainComponent> headlessServer;
 };
 
 //==============================================================================
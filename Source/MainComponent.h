@@ -19,9 +19,13 @@ public:
         std::function<void()> close;
     };
 
-    MainComponent();
+    // A headless MainComponent is never put on screen: it runs the server for a console
+    // launch, with no dialogs, and saves and restores the default project archive
+    explicit MainComponent(bool runHeadless = false);
     ~MainComponent() override;
 
+    bool isHeadless() const { return headless; }
+
 	std::function<void()> onInitialised;
 
 	void moveSelectedRowsToEnd();
@@ -109,6 +113,7 @@ public:
 	void applyPluginReplacement(int row, const juce::String& pluginName);
 
 private:
+    const bool headless;
     juce::File pluginFolder; // Use a juce::File object instead of a pointer
 
     LayoutMetrics getLayoutMetrics() const;
@@ -160,8 +165,7 @@ private:
 	juce::TextButton restoreButton{ "Restore" }; // Button to restore plugin states
 
 	juce::CriticalSection midiCriticalSection; // Critical section to protect the MIDI buffer
-	juce::MidiBuffer midiBuffer; // MIDI buffer to store incoming MIDI messages
-	MidiManager midiManager{this, midiCriticalSection, midiBuffer }; // Create an instance of the MidiManager class
+	MidiManager midiManager{this, midiCriticalSection, headless }; // Create an instance of the MidiManager class
 
     // Label for the Project Name
     juce::Label projectNameLabel{ "Project Name", "Project Name" }; // Label for the project name
@@ -186,8 +190,8 @@ private:
 
     juce::TooltipWindow tooltipWindow;
 
-	PluginManager pluginManager { this, midiCriticalSection, midiBuffer }; // Create an instance of the PluginManager class
-	Conductor conductor{ pluginManager, midiManager, this }; // Create an instance of the Conductor class
+	PluginManager pluginManager { this, midiCriticalSection }; // Create an instance of the PluginManager class
+	Conductor conductor{ pluginManager, midiManager, this, headless }; // Create an instance of the Conductor class
 
 	OrchestraTableModel orchestraTableModel{ conductor.orchestra, orchestraTable, this }; // Create an instance of the OrchestraTableModel class
 	// create a similar instance of the PluginTableModel class here and initialize it with pluginManager.pluginList
@@ -0,0 +1,368 @@
+#include "MidiEventScheduler.h"
+#include <cstring>
+#include <limits>
+
+namespace
+{
+    // Share of the memory budget given to the SysEx byte pool; the rest goes to nodes
+    constexpr std::size_t kByteBudgetShare = 16;
+}
+
+void MidiEventScheduler::reserve(std::size_t memoryBudgetBytes)
+{
+    const auto byteBudget = memoryBudgetBytes / kByteBudgetShare;
+    const auto perBlock = (std::size_t) kSysExBlockBytes + sizeof(int);
+    const auto wantedBlocks = (int) juce::jlimit<std::size_t>((std::size_t) (kMaxSysExBytes / kSysExBlockBytes),
+                                                              (std::size_t) std::numeric_limits<int>::max() / kSysExBlockBytes,
+                                                              byteBudget / perBlock);
+    assembled.resize((size_t) kMaxSysExBytes);
+
+    if (numPending == 0 || wantedBlocks > (int) blockNext.size())
+    {
+        // Pending events keep their chains, so with any pending the pool only ever grows
+        const int oldBlocks = numPending == 0 ? 0 : (int) blockNext.size();
+        if (numPending == 0)
+        {
+            freeBlockHead = -1;
+            numFreeBlocks = 0;
+        }
+        blockBytes.resize((size_t) wantedBlocks * kSysExBlockBytes);
+        blockNext.resize((size_t) wantedBlocks, -1);
+        for (int i = wantedBlocks - 1; i >= oldBlocks; --i)
+        {
+            blockNext[(size_t) i] = freeBlockHead;
+            freeBlockHead = i;
+            ++numFreeBlocks;
+        }
+    }
+
+    const auto perEvent = sizeof(Node) + sizeof(int);
+    const auto wanted = (int) juce::jlimit<std::size_t>(1024,
+                                                        (std::size_t) std::numeric_limits<int>::max() / 2,
+                                                        (memoryBudgetBytes - byteBudget) / perEvent);
+
+    if (wanted == (int) nodes.size())
+        return;
+
+    if (numPending == 0)
+    {
+        nodes.clear();
+        nodes.resize((size_t) wanted);
+        scratch.assign((size_t) wanted, -1);
+        heads = makeEmptyHeads();
+        numInWheel = 0;
+
+        freeHead = -1;
+        for (int i = wanted - 1; i >= 0; --i)
+        {
+            nodes[(size_t) i].next = freeHead;
+            freeHead = i;
+        }
+        return;
+    }
+
+    // Events are pending: node indices must stay valid, so only ever grow
+    const int oldSize = (int) nodes.size();
+    if (wanted <= oldSize)
+        return;
+
+    nodes.resize((size_t) wanted);
+    scratch.resize((size_t) wanted, -1);
+    for (int i = wanted - 1; i >= oldSize; --i)
+    {
+        nodes[(size_t) i].next = freeHead;
+        freeHead = i;
+    }
+}
+
+bool MidiEventScheduler::insert(const Event& event, const juce::uint8* data, int size)
+{
+    const int n = allocateNode();
+    if (n < 0)
+    {
+        ++dropped;
+        return false;
+    }
+
+    auto& node = nodes[(size_t) n];
+    if (!storeBytes(node, data, size))
+    {
+        freeNode(n);
+        ++dropped;
+        return false;
+    }
+
+    node.event = event;
+    placeNode(n);
+    return true;
+}
+
+bool MidiEventScheduler::storeBytes(Node& node, const juce::uint8* data, int size)
+{
+    node.size = size;
+    node.firstBlock = -1;
+    if (size <= kInlineBytes)
+    {
+        std::memcpy(node.bytes.data(), data, (size_t) juce::jmax(0, size));
+        return true;
+    }
+
+    const int blocksNeeded = (size + kSysExBlockBytes - 1) / kSysExBlockBytes;
+    if (size > kMaxSysExBytes || blocksNeeded > numFreeBlocks)
+        return false;
+
+    // Taken off the free list in order, so the chain reads back front to back
+    int* link = &node.firstBlock;
+    for (int copied = 0; copied < size; copied += kSysExBlockBytes)
+    {
+        const int block = freeBlockHead;
+        freeBlockHead = blockNext[(size_t) block];
+        --numFreeBlocks;
+
+        std::memcpy(blockBytes.data() + (size_t) block * kSysExBlockBytes,
+                    data + copied,
+                    (size_t) juce::jmin(kSysExBlockBytes, size - copied));
+        blockNext[(size_t) block] = -1;
+        *link = block;
+        link = &blockNext[(size_t) block];
+    }
+    return true;
+}
+
+const juce::uint8* MidiEventScheduler::dataOf(const Node& node)
+{
+    if (node.firstBlock < 0)
+        return node.bytes.data();
+
+    int copied = 0;
+    for (int block = node.firstBlock; block >= 0; block = blockNext[(size_t) block])
+    {
+        const int length = juce::jmin(kSysExBlockBytes, node.size - copied);
+        std::memcpy(assembled.data() + copied, blockBytes.data() + (size_t) block * kSysExBlockBytes, (size_t) length);
+        copied += length;
+    }
+    return assembled.data();
+}
+
+void MidiEventScheduler::freeBlocks(Node& node)
+{
+    int block = node.firstBlock;
+    while (block >= 0)
+    {
+        const int next = blockNext[(size_t) block];
+        blockNext[(size_t) block] = freeBlockHead;
+        freeBlockHead = block;
+        ++numFreeBlocks;
+        block = next;
+    }
+    node.firstBlock = -1;
+}
+
+void MidiEventScheduler::removeOlderThan(juce::uint64 sequence)
+{
+    for (int list = 0; list < kNumLists; ++list)
+    {
+        int prev = -1;
+        int n = heads[(size_t) list];
+        while (n >= 0)
+        {
+            const int next = nodes[(size_t) n].next;
+            if (nodes[(size_t) n].event.sequence < sequence)
+            {
+                if (prev < 0)
+                    heads[(size_t) list] = next;
+                else
+                    nodes[(size_t) prev].next = next;
+
+                if (list != kDueList)
+                    --numInWheel;
+                freeNode(n);
+            }
+            else
+            {
+                prev = n;
+            }
+            n = next;
+        }
+    }
+}
+
+void MidiEventScheduler::clear()
+{
+    removeOlderThan(std::numeric_limits<juce::uint64>::max());
+}
+
+void MidiEventScheduler::setPosition(juce::int64 samplePosition)
+{
+    currentTick = juce::jmax<juce::int64>(0, samplePosition) >> kTickShift;
+    reinsertAll([](Event&) {});
+}
+
+int MidiEventScheduler::allocateNode()
+{
+    if (freeHead < 0)
+        return -1;
+
+    const int n = freeHead;
+    freeHead = nodes[(size_t) n].next;
+    nodes[(size_t) n].next = -1;
+    ++numPending;
+    return n;
+}
+
+void MidiEventScheduler::freeNode(int nodeIndex)
+{
+    auto& node = nodes[(size_t) nodeIndex];
+    freeBlocks(node);
+    node.next = freeHead;
+    freeHead = nodeIndex;
+    --numPending;
+}
+
+void MidiEventScheduler::pushToList(int listIndex, int nodeIndex)
+{
+    nodes[(size_t) nodeIndex].next = heads[(size_t) listIndex];
+    heads[(size_t) listIndex] = nodeIndex;
+}
+
+void MidiEventScheduler::placeNode(int nodeIndex)
+{
+    const auto& event = nodes[(size_t) nodeIndex].event;
+    const auto tick = event.samplePosition >> kTickShift;
+
+    if (event.immediate || tick < currentTick)
+    {
+        pushToList(kDueList, nodeIndex);
+        return;
+    }
+
+    const auto delta = tick - currentTick;
+    int list;
+    if (delta < kLevel0Size)
+        list = (int) (tick & (kLevel0Size - 1));
+    else if (delta < (juce::int64) 1 << (kLevel0Bits + kLevelBits))
+        list = upperListIndex(1, (int) ((tick >> kLevel0Bits) & (kLevelSize - 1)));
+    else if (delta < (juce::int64) 1 << (kLevel0Bits + 2 * kLevelBits))
+        list = upperListIndex(2, (int) ((tick >> (kLevel0Bits + kLevelBits)) & (kLevelSize - 1)));
+    else if (delta < (juce::int64) 1 << (kLevel0Bits + 3 * kLevelBits))
+        list = upperListIndex(3, (int) ((tick >> (kLevel0Bits + 2 * kLevelBits)) & (kLevelSize - 1)));
+    else
+        list = kOverflowList;
+
+    pushToList(list, nodeIndex);
+    ++numInWheel;
+}
+
+int MidiEventScheduler::cascade(int level, int slot)
+{
+    auto& head = heads[(size_t) upperListIndex(level, slot)];
+    int n = head;
+    head = -1;
+
+    while (n >= 0)
+    {
+        const int next = nodes[(size_t) n].next;
+        --numInWheel;
+        placeNode(n);
+        n = next;
+    }
+
+    return slot;
+}
+
+void MidiEventScheduler::advanceTick()
+{
+    ++currentTick;
+    if ((currentTick & (kLevel0Size - 1)) != 0)
+        return;
+
+    auto slotFor = [this](int level)
+    {
+        return (int) ((currentTick >> (kLevel0Bits + (level - 1) * kLevelBits)) & (kLevelSize - 1));
+    };
+
+    // Pull the next coarse slot down into the fine wheel; each level only cascades when the one
+    // below it has wrapped, and the overflow list is revisited once the top level wraps.
+    if (cascade(1, slotFor(1)) == 0 && cascade(2, slotFor(2)) == 0 && cascade(3, slotFor(3)) == 0)
+    {
+        int n = heads[(size_t) kOverflowList];
+        heads[(size_t) kOverflowList] = -1;
+        while (n >= 0)
+        {
+            const int next = nodes[(size_t) n].next;
+            --numInWheel;
+            placeNode(n);
+            n = next;
+        }
+    }
+}
+
+int MidiEventScheduler::gatherDue(juce::int64 blockEnd)
+{
+    const auto endTick = juce::jmax<juce::int64>(0, blockEnd) >> kTickShift;
+
+    // Whole ticks that finish inside this block go to the due list
+    while (numInWheel > 0 && currentTick < endTick)
+    {
+        auto& head = heads[(size_t) (currentTick & (kLevel0Size - 1))];
+        int n = head;
+        head = -1;
+        while (n >= 0)
+        {
+            const int next = nodes[(size_t) n].next;
+            pushToList(kDueList, n);
+            --numInWheel;
+            n = next;
+        }
+        advanceTick();
+    }
+
+    // Nothing left in the wheel, so the clock can jump without visiting empty slots
+    if (numInWheel == 0 && currentTick < endTick)
+        currentTick = endTick;
+
+    // The tick straddling the block end only gives up the events before blockEnd
+    if (numInWheel > 0 && (currentTick << kTickShift) < blockEnd)
+    {
+        const int list = (int) (currentTick & (kLevel0Size - 1));
+        int prev = -1;
+        int n = heads[(size_t) list];
+        while (n >= 0)
+        {
+            const int next = nodes[(size_t) n].next;
+            if (nodes[(size_t) n].event.samplePosition < blockEnd)
+            {
+                if (prev < 0)
+                    heads[(size_t) list] = next;
+                else
+                    nodes[(size_t) prev].next = next;
+
+                pushToList(kDueList, n);
+                --numInWheel;
+            }
+            else
+            {
+                prev = n;
+            }
+            n = next;
+        }
+    }
+
+    int count = 0;
+    for (int n = heads[(size_t) kDueList]; n >= 0; n = nodes[(size_t) n].next)
+        scratch[(size_t) count++] = n;
+    heads[(size_t) kDueList] = -1;
+
+    std::sort(scratch.begin(), scratch.begin() + count, [this](int a, int b)
+              {
+                  const auto& ea = nodes[(size_t) a].event;
+                  const auto& eb = nodes[(size_t) b].event;
+                  const auto ka = ea.immediate ? std::numeric_limits<juce::int64>::min() : ea.samplePosition;
+                  const auto kb = eb.immediate ? std::numeric_limits<juce::int64>::min() : eb.samplePosition;
+                  if (ka != kb)
+                      return ka < kb;
+                  return ea.sequence < eb.sequence;
+              });
+
+    return count;
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "PluginHandle.h"
+
+// Hierarchical timing wheel for future MIDI events, keyed in samples on the playback clock.
+// Insert is O(1); extracting a block costs O(ticks in block + events due). Slots are laid
+// out like the classic kernel timer wheel: 256 fine slots of 1 << kTickShift samples each, then three
+// coarser levels of 64 slots that cascade down as the clock passes them, and an overflow
+// list for anything further out. Nodes come from a pool sized once from a memory budget,
+// so nothing is allocated on the audio thread. A message's bytes live in its node; longer
+// ones (SysEx) are chained through fixed-size blocks of a byte pool carved from the same budget.
+// All methods except reserve() are audio-thread only.
+class MidiEventScheduler
+{
+public:
+    struct Event
+    {
+        PluginHandle target = kInvalidPluginHandle;
+        juce::int64 timestamp = 0;      // us as queued, kept so events can be re-keyed
+        juce::uint64 sequence = 0;      // ingest order, breaks ties between equal positions
+        juce::int64 samplePosition = 0; // playback sample the event is due at
+        bool immediate = false;         // play at the start of the next block regardless of position
+    };
+
+    static constexpr int kTickShift = 5; // 32-sample ticks
+    static constexpr std::size_t kDefaultMemoryBudgetBytes = 64 * 1024 * 1024; // comfortably holds a full master capture
+    static constexpr int kInlineBytes = 8;           // channel messages never touch the byte pool
+    static constexpr int kSysExBlockBytes = 64;
+    static constexpr int kMaxSysExBytes = 64 * 1024; // longer messages are dropped
+
+    MidiEventScheduler() = default;
+
+    // Not realtime safe: sizes the node pool. Pending events are kept if the pool still fits them.
+    void reserve(std::size_t memoryBudgetBytes);
+    int getCapacity() const { return (int) nodes.size(); }
+    int getNumPending() const { return numPending; }
+    juce::uint64 getDroppedCount() const { return dropped; }
+
+    // Copies size bytes of data with the event. Returns false (and counts a drop) if the
+    // memory budget is exhausted or the message is longer than kMaxSysExBytes.
+    bool insert(const Event& event, const juce::uint8* data, int size);
+
+    // Discards every pending event queued before the given ingest sequence
+    void removeOlderThan(juce::uint64 sequence);
+    void clear();
+
+    // Moves the wheel to a new playback position (e.g. after a transport reset)
+    void setPosition(juce::int64 samplePosition);
+
+    // Recomputes every pending event's sample position, e.g. after a sample-rate change
+    template <typename KeyFn>
+    void rekey(KeyFn&& samplePositionFor)
+    {
+        reinsertAll([&samplePositionFor](Event& e) { e.samplePosition = samplePositionFor(e); });
+    }
+
+    // Emits every event due before blockStart + numSamples, ordered by (position, sequence).
+    // fn(const Event&, const juce::uint8* data, int size, int sampleOffset); data is only valid
+    // during the call. Late and immediate events land at offset 0.
+    template <typename Fn>
+    void collectDue(juce::int64 blockStart, int numSamples, Fn&& fn)
+    {
+        const int numDue = gatherDue(blockStart + numSamples);
+        for (int i = 0; i < numDue; ++i)
+        {
+            const auto nodeIndex = scratch[(size_t) i];
+            const auto& node = nodes[(size_t) nodeIndex];
+            const auto& event = node.event;
+
+            int offset = 0;
+            if (!event.immediate)
+                offset = (int) juce::jlimit<juce::int64>(0, numSamples - 1, event.samplePosition - blockStart);
+
+            fn(event, dataOf(node), node.size, offset);
+            freeNode(nodeIndex);
+        }
+    }
+
+private:
+    static constexpr int kLevel0Bits = 8;
+    static constexpr int kLevelBits = 6;
+    static constexpr int kLevel0Size = 1 << kLevel0Bits;
+    static constexpr int kLevelSize = 1 << kLevelBits;
+    static constexpr int kNumUpperLevels = 3;
+    static constexpr int kOverflowList = kLevel0Size + kNumUpperLevels * kLevelSize;
+    static constexpr int kDueList = kOverflowList + 1;
+    static constexpr int kNumLists = kDueList + 1;
+
+    struct Node
+    {
+        Event event;
+        std::array<juce::uint8, kInlineBytes> bytes{};
+        int size = 0;
+        int firstBlock = -1; // byte pool chain for messages longer than kInlineBytes
+        int next = -1;
+    };
+
+    // Inline bytes, or the block chain copied into assembled
+    const juce::uint8* dataOf(const Node& node);
+    bool storeBytes(Node& node, const juce::uint8* data, int size);
+    void freeBlocks(Node& node);
+
+    int allocateNode();
+    void freeNode(int nodeIndex);
+    void pushToList(int listIndex, int nodeIndex);
+    void placeNode(int nodeIndex);
+    void advanceTick();
+    int cascade(int level, int slot);
+    int gatherDue(juce::int64 blockEnd);
+
+    template <typename Fn>
+    void reinsertAll(Fn&& update)
+    {
+        int count = 0;
+        for (auto& head : heads)
+        {
+            for (int n = head; n >= 0; n = nodes[(size_t) n].next)
+                scratch[(size_t) count++] = n;
+            head = -1;
+        }
+        numInWheel = 0;
+
+        for (int i = 0; i < count; ++i)
+        {
+            const auto n = scratch[(size_t) i];
+            update(nodes[(size_t) n].event);
+            placeNode(n);
+        }
+    }
+
+    static constexpr int upperListIndex(int level, int slot)
+    {
+        return kLevel0Size + (level - 1) * kLevelSize + slot;
+    }
+
+    std::vector<Node> nodes;
+    std::vector<int> scratch;
+    std::vector<juce::uint8> blockBytes;
+    std::vector<int> blockNext;
+    std::vector<juce::uint8> assembled;
+    int freeBlockHead = -1;
+    int numFreeBlocks = 0;
+    std::array<int, kNumLists> heads = makeEmptyHeads();
+    int freeHead = -1;
+    int numPending = 0;
+    int numInWheel = 0; // pending events not on the due list
+    juce::int64 currentTick = 0;
+    juce::uint64 dropped = 0;
+
+    static std::array<int, kNumLists> makeEmptyHeads()
+    {
+        std::array<int, kNumLists> empty{};
+        empty.fill(-1);
+        return empty;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiEventScheduler)
+};
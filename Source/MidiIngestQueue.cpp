@@ -0,0 +1,278 @@
+#include "MidiIngestQueue.h"
+#include <cstring>
+
+MidiIngestLane::MidiIngestLane(int capacity, int arenaCapacity)
+    : slots((size_t) juce::nextPowerOfTwo(juce::jmax(2, capacity))),
+      arena((size_t) juce::jmax(1024, arenaCapacity)),
+      mask((juce::uint64) slots.size() - 1)
+{
+}
+
+bool MidiIngestLane::push(const juce::MidiMessage& message,
+                          PluginHandle target,
+                          juce::int64 timestamp,
+                          std::atomic<juce::uint64>& sequenceCounter,
+                          int timeoutMs)
+{
+    auto arenaPosition = arenaWritten.load(std::memory_order_relaxed);
+    const int arenaBytes = arenaBytesFor(message.getRawDataSize(), arenaPosition);
+    if (arenaBytes < 0 || !waitForSpace(1, arenaBytes, timeoutMs))
+    {
+        countDropped(1);
+        return false;
+    }
+
+    const auto index = writeIndex.load(std::memory_order_relaxed);
+    auto& slot = slots[(size_t) (index & mask)];
+    write(slot, message.getRawData(), message.getRawDataSize(), arenaPosition);
+    slot.target = target;
+    slot.timestamp = timestamp;
+    slot.sequence = sequenceCounter.fetch_add(1, std::memory_order_acq_rel);
+
+    arenaWritten.store(arenaPosition, std::memory_order_release);
+    writeIndex.store(index + 1, std::memory_order_release);
+    return true;
+}
+
+bool MidiIngestLane::pushBatch(const MidiEventBatch& batch,
+                               std::atomic<juce::uint64>& sequenceCounter,
+                               int timeoutMs)
+{
+    // Sized first, so the batch is queued whole or not at all
+    struct Sizer : MidiEventBatch::Visitor
+    {
+        Sizer(const MidiIngestLane& l, juce::uint64 start) : lane(l), arenaStart(start) {}
+
+        void visit(const juce::uint8*, int size, PluginHandle target, const juce::String&, juce::int64) override
+        {
+            if (target == kInvalidPluginHandle)
+                return;
+
+            const int bytes = lane.arenaBytesFor(size, arenaStart + (juce::uint64) arenaBytes);
+            if (bytes < 0)
+                arenaBytes = (int) lane.arena.size() + 1; // can never fit
+            else
+                arenaBytes += bytes;
+            ++numEvents;
+        }
+
+        const MidiIngestLane& lane;
+        const juce::uint64 arenaStart;
+        int numEvents = 0;
+        int arenaBytes = 0;
+    };
+
+    struct Writer : MidiEventBatch::Visitor
+    {
+        Writer(MidiIngestLane& l, juce::uint64 index, juce::uint64 firstSequence, juce::uint64 position)
+            : lane(l), nextIndex(index), sequence(firstSequence), arenaPosition(position) {}
+
+        void visit(const juce::uint8* data, int size, PluginHandle target, const juce::String&, juce::int64 timestamp) override
+        {
+            if (target == kInvalidPluginHandle)
+                return;
+
+            auto& slot = lane.slots[(size_t) (nextIndex++ & lane.mask)];
+            lane.write(slot, data, size, arenaPosition);
+            slot.target = target;
+            slot.timestamp = timestamp;
+            slot.sequence = sequence++;
+        }
+
+        MidiIngestLane& lane;
+        juce::uint64 nextIndex;
+        juce::uint64 sequence;
+        juce::uint64 arenaPosition;
+    };
+
+    Sizer sizer(*this, arenaWritten.load(std::memory_order_relaxed));
+    batch.forEachEvent(sizer);
+    if (sizer.numEvents == 0)
+        return true;
+
+    if (!waitForSpace(sizer.numEvents, sizer.arenaBytes, timeoutMs))
+    {
+        countDropped(sizer.numEvents);
+        return false;
+    }
+
+    // The write index moves once, so the audio thread only ever sees the whole batch
+    Writer writer(*this,
+                  writeIndex.load(std::memory_order_relaxed),
+                  sequenceCounter.fetch_add((juce::uint64) sizer.numEvents, std::memory_order_acq_rel),
+                  sizer.arenaStart);
+    batch.forEachEvent(writer);
+    jassert(writer.nextIndex - writeIndex.load(std::memory_order_relaxed) == (juce::uint64) sizer.numEvents);
+
+    arenaWritten.store(writer.arenaPosition, std::memory_order_release);
+    writeIndex.store(writer.nextIndex, std::memory_order_release);
+    return true;
+}
+
+int MidiIngestLane::arenaBytesFor(int size, juce::uint64 arenaPosition) const
+{
+    if (size <= IngestedMidiEvent::kInlineBytes)
+        return 0;
+
+    // Messages are stored contiguously, so one that would wrap starts over at the front and the
+    // tail it skips is released with it. Capped at half the arena so it always fits once drained.
+    if (size > (int) arena.size() / 2)
+        return -1;
+
+    const auto offset = (int) (arenaPosition % arena.size());
+    return offset + size > (int) arena.size() ? (int) arena.size() - offset + size : size;
+}
+
+void MidiIngestLane::write(IngestedMidiEvent& slot, const juce::uint8* data, int size, juce::uint64& arenaPosition)
+{
+    slot.size = size;
+
+    if (size <= IngestedMidiEvent::kInlineBytes)
+    {
+        std::memcpy(slot.bytes.data(), data, (size_t) size);
+        slot.external = nullptr;
+        slot.arenaBytes = 0;
+        return;
+    }
+
+    const int arenaBytes = arenaBytesFor(size, arenaPosition);
+    const auto offset = arenaBytes > size ? (size_t) 0 : (size_t) (arenaPosition % arena.size());
+    std::memcpy(arena.data() + offset, data, (size_t) size);
+    slot.external = arena.data() + offset;
+    slot.arenaBytes = arenaBytes;
+    arenaPosition += (juce::uint64) arenaBytes;
+}
+
+bool MidiIngestLane::hasSpace(int numEvents, int arenaBytes) const
+{
+    const auto queued = writeIndex.load(std::memory_order_relaxed) - readIndex.load(std::memory_order_acquire);
+    const auto arenaUsed = arenaWritten.load(std::memory_order_relaxed) - arenaRead.load(std::memory_order_acquire);
+    return queued + (juce::uint64) numEvents <= (juce::uint64) slots.size()
+           && arenaUsed + (juce::uint64) arenaBytes <= (juce::uint64) arena.size();
+}
+
+bool MidiIngestLane::waitForSpace(int numEvents, int arenaBytes, int timeoutMs) const
+{
+    if (numEvents > (int) slots.size() || arenaBytes > (int) arena.size())
+        return false;
+
+    const auto deadline = juce::Time::getMillisecondCounter() + (juce::uint32) juce::jmax(0, timeoutMs);
+    while (!hasSpace(numEvents, arenaBytes))
+    {
+        if (timeoutMs <= 0 || juce::Time::getMillisecondCounter() >= deadline)
+            return false;
+        juce::Thread::sleep(1);
+    }
+    return true;
+}
+
+int MidiIngestLane::getNumReady() const
+{
+    return (int) (writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_relaxed));
+}
+
+const IngestedMidiEvent& MidiIngestLane::peek(int index) const
+{
+    return slots[(size_t) ((readIndex.load(std::memory_order_relaxed) + (juce::uint64) index) & mask)];
+}
+
+void MidiIngestLane::pop(int numEvents)
+{
+    if (numEvents <= 0)
+        return;
+
+    const auto start = readIndex.load(std::memory_order_relaxed);
+    juce::uint64 arenaBytes = 0;
+    for (int i = 0; i < numEvents; ++i)
+        arenaBytes += (juce::uint64) slots[(size_t) ((start + (juce::uint64) i) & mask)].arenaBytes;
+
+    arenaRead.store(arenaRead.load(std::memory_order_relaxed) + arenaBytes, std::memory_order_release);
+    readIndex.store(start + (juce::uint64) numEvents, std::memory_order_release);
+}
+
+MidiIngestQueue::MidiIngestQueue(int laneCapacity, int laneArenaBytes)
+    : drainScratch((size_t) kDrainBatch, nullptr)
+{
+    for (auto& lane : lanes)
+        lane = std::make_unique<MidiIngestLane>(laneCapacity, laneArenaBytes);
+}
+
+MidiIngestLane* MidiIngestQueue::claimLane(MidiIngestSource source)
+{
+    jassert(source != MidiIngestSource::NumSources);
+    const int first = (int) source * kLanesPerSource;
+    for (int i = 0; i < kNumLanes; ++i)
+    {
+        auto& lane = *lanes[(size_t) ((first + i) % kNumLanes)];
+        if (lane.tryClaim())
+            return &lane;
+    }
+    return nullptr;
+}
+
+bool MidiIngestQueue::push(MidiIngestSource source,
+                           const juce::MidiMessage& message,
+                           PluginHandle target,
+                           juce::int64 timestamp,
+                           int timeoutMs)
+{
+    auto* lane = claimLane(source);
+    if (lane == nullptr)
+    {
+        unclaimedDrops.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    const bool pushed = lane->push(message, target, timestamp, nextSequence, timeoutMs);
+    lane->release();
+    return pushed;
+}
+
+bool MidiIngestQueue::pushBatch(MidiIngestSource source,
+                                const MidiEventBatch& batch,
+                                int timeoutMs)
+{
+    auto* lane = claimLane(source);
+    if (lane == nullptr)
+    {
+        struct Counter : MidiEventBatch::Visitor
+        {
+            void visit(const juce::uint8*, int, PluginHandle, const juce::String&, juce::int64) override { ++numEvents; }
+            juce::uint64 numEvents = 0;
+        } counter;
+        batch.forEachEvent(counter);
+        unclaimedDrops.fetch_add(counter.numEvents, std::memory_order_relaxed);
+        return false;
+    }
+
+    const bool pushed = lane->pushBatch(batch, nextSequence, timeoutMs);
+    lane->release();
+    return pushed;
+}
+
+void MidiIngestQueue::requestClear(bool resetPlayhead)
+{
+    // Everything that already holds a sequence number is older than this request
+    const auto cutoff = nextSequence.fetch_add(1, std::memory_order_acq_rel) + 1;
+
+    auto raiseTo = [cutoff](std::atomic<juce::uint64>& target)
+    {
+        auto current = target.load(std::memory_order_relaxed);
+        while (current < cutoff
+               && !target.compare_exchange_weak(current, cutoff, std::memory_order_acq_rel))
+        {
+        }
+    };
+
+    if (resetPlayhead)
+        raiseTo(resetBeforeSequence);
+    raiseTo(clearBeforeSequence);
+}
+
+juce::uint64 MidiIngestQueue::getDroppedCount() const
+{
+    juce::uint64 total = unclaimedDrops.load(std::memory_order_relaxed);
+    for (const auto& lane : lanes)
+        total += lane->getDroppedCount();
+    return total;
+}
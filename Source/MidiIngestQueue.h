@@ -0,0 +1,213 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "PluginHandle.h"
+
+// Producers that feed MIDI into the audio engine. Each source starts looking for a free lane
+// at its own, so a burst on one source never waits behind another.
+enum class MidiIngestSource
+{
+    Osc = 0,
+    MidiInput,
+    Overdub,
+    Control,
+    NumSources
+};
+
+// Timestamped MIDI event as carried from a producer thread to the audio thread. The bytes
+// are copied in by the producer: short messages inline, longer ones (SysEx) into the lane's
+// byte arena, so the audio thread reads them without copying a juce::MidiMessage.
+struct IngestedMidiEvent
+{
+    static constexpr int kInlineBytes = 8;
+
+    const juce::uint8* getData() const { return external != nullptr ? external : bytes.data(); }
+
+    std::array<juce::uint8, kInlineBytes> bytes{};
+    const juce::uint8* external = nullptr; // into the lane's arena, or nullptr if inline
+    int size = 0;
+    int arenaBytes = 0;         // arena bytes released when the event is popped, padding included
+    PluginHandle target = kInvalidPluginHandle;
+    juce::int64 timestamp = 0;  // us since the playback reset, 0 = play immediately
+    juce::uint64 sequence = 0;  // global push order, breaks timestamp ties
+};
+
+// One event of a batch that producers hand over in a single push
+struct MidiBatchEvent
+{
+    juce::MidiMessage message;
+    PluginTarget target;
+    juce::int64 timestamp = 0;  // as IngestedMidiEvent::timestamp
+};
+
+// Events that a producer hands over in a single push. The bytes are written into the lane
+// straight from the producer's own buffers. forEachEvent runs more than once per push (to
+// size the batch, to write it and, while capturing, to capture it), so it has to visit the
+// same events every time.
+class MidiEventBatch
+{
+public:
+    class Visitor
+    {
+    public:
+        virtual ~Visitor() = default;
+        virtual void visit(const juce::uint8* data, int size, PluginHandle target,
+                           const juce::String& pluginId, juce::int64 timestamp) = 0;
+    };
+
+    virtual ~MidiEventBatch() = default;
+    virtual void forEachEvent(Visitor& visitor) const = 0;
+};
+
+// Single-producer, single-consumer ring of events plus a ring of SysEx bytes. One producer at
+// a time owns the lane (MidiIngestQueue claims it with a flag, never a lock); the audio thread
+// is the only consumer. Both sides only publish their own index, so neither ever waits.
+class MidiIngestLane
+{
+public:
+    MidiIngestLane(int capacity, int arenaCapacity);
+
+    // Producer side, owner only. timeoutMs == 0 drops immediately when full; bulk producers
+    // may pass a timeout and sleep until the audio thread has made room in this lane.
+    bool push(const juce::MidiMessage& message,
+              PluginHandle target,
+              juce::int64 timestamp,
+              std::atomic<juce::uint64>& sequenceCounter,
+              int timeoutMs);
+    // Producer side, owner only. All events with a valid target become visible to the audio
+    // thread together, with consecutive sequence numbers; if they do not fit, none are queued.
+    bool pushBatch(const MidiEventBatch& batch,
+                   std::atomic<juce::uint64>& sequenceCounter,
+                   int timeoutMs);
+
+    // Consumer side (audio thread)
+    int getNumReady() const;
+    const IngestedMidiEvent& peek(int index) const;
+    void pop(int numEvents);
+
+    // Claimed by one producer at a time; false if another producer holds it
+    bool tryClaim() { return !claimed.exchange(true, std::memory_order_acquire); }
+    void release() { claimed.store(false, std::memory_order_release); }
+
+    void countDropped(int numEvents) { dropped.fetch_add((juce::uint64) numEvents, std::memory_order_relaxed); }
+    juce::uint64 getDroppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    // Producer side: room for numEvents more events and arenaBytes more SysEx bytes
+    bool hasSpace(int numEvents, int arenaBytes) const;
+    bool waitForSpace(int numEvents, int arenaBytes, int timeoutMs) const;
+    // Arena bytes a message of this size takes at the current write position, padding included
+    int arenaBytesFor(int size, juce::uint64 arenaPosition) const;
+    void write(IngestedMidiEvent& slot, const juce::uint8* data, int size, juce::uint64& arenaPosition);
+
+    std::vector<IngestedMidiEvent> slots;
+    std::vector<juce::uint8> arena;
+    const juce::uint64 mask;
+    std::atomic<juce::uint64> writeIndex{ 0 };  // producer owned
+    std::atomic<juce::uint64> readIndex{ 0 };   // consumer owned
+    std::atomic<juce::uint64> arenaWritten{ 0 }; // producer owned
+    std::atomic<juce::uint64> arenaRead{ 0 };   // consumer owned
+    std::atomic<bool> claimed{ false };
+    std::atomic<juce::uint64> dropped{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiIngestLane)
+};
+
+// All producer lanes plus the clear requests that travel alongside them
+class MidiIngestQueue
+{
+public:
+    static constexpr int kLanesPerSource = 2;
+    static constexpr int kNumLanes = kLanesPerSource * (int) MidiIngestSource::NumSources;
+    static constexpr int kDrainBatch = 4096;
+
+    explicit MidiIngestQueue(int laneCapacity = 16384, int laneArenaBytes = 256 * 1024);
+
+    // Any thread, wait-free unless a timeout is given. The producer claims the first free lane
+    // from its source's own, so concurrent producers never share a lane; if every lane is
+    // claimed at once the event is dropped.
+    bool push(MidiIngestSource source,
+              const juce::MidiMessage& message,
+              PluginHandle target,
+              juce::int64 timestamp,
+              int timeoutMs = 0);
+    bool pushBatch(MidiIngestSource source,
+                   const MidiEventBatch& batch,
+                   int timeoutMs = 0);
+
+    // Any thread: everything pushed before this call is discarded by the audio thread,
+    // both still in the lanes and already merged into its pending queue. With resetPlayhead
+    // the playback clock also restarts from zero before any later event is scheduled.
+    void requestClear(bool resetPlayhead = false);
+    juce::uint64 getClearBeforeSequence() const { return clearBeforeSequence.load(std::memory_order_acquire); }
+    // Read after getClearBeforeSequence(): a reset is always published before its clear
+    juce::uint64 getResetBeforeSequence() const { return resetBeforeSequence.load(std::memory_order_acquire); }
+
+    juce::uint64 getDroppedCount() const;
+
+    // Audio thread: pops everything currently in the lanes and hands each surviving event to fn,
+    // sorted by (timestamp, sequence) across lanes within each batch of up to kDrainBatch events.
+    // Events older than clearBefore are skipped. Draining stops before a batch if a newer clear
+    // has arrived, so events queued after it wait for the next block (when the clear, and any
+    // playhead reset, has been applied).
+    template <typename Fn>
+    void drain(juce::uint64 clearBefore, Fn&& fn)
+    {
+        for (;;)
+        {
+            int numGathered = 0;
+            for (size_t i = 0; i < lanes.size(); ++i)
+            {
+                const int take = juce::jmin(lanes[i]->getNumReady(), kDrainBatch - numGathered);
+                for (int e = 0; e < take; ++e)
+                    drainScratch[(size_t) numGathered++] = &lanes[i]->peek(e);
+                gathered[i] = take;
+            }
+
+            if (numGathered == 0)
+                return;
+
+            if (clearBeforeSequence.load(std::memory_order_acquire) != clearBefore)
+                return;
+
+            // Each lane is in push order, not time order, so the batch is sorted as a whole
+            std::sort(drainScratch.begin(), drainScratch.begin() + numGathered,
+                      [](const IngestedMidiEvent* a, const IngestedMidiEvent* b)
+                      {
+                          if (a->timestamp != b->timestamp)
+                              return a->timestamp < b->timestamp;
+                          return a->sequence < b->sequence;
+                      });
+
+            for (int i = 0; i < numGathered; ++i)
+                if (drainScratch[(size_t) i]->sequence >= clearBefore)
+                    fn(*drainScratch[(size_t) i]);
+
+            for (size_t i = 0; i < lanes.size(); ++i)
+                lanes[i]->pop(gathered[i]);
+
+            if (numGathered < kDrainBatch)
+                return;
+        }
+    }
+
+private:
+    // Claims a free lane, starting at the source's own; nullptr if every lane is claimed
+    MidiIngestLane* claimLane(MidiIngestSource source);
+
+    std::array<std::unique_ptr<MidiIngestLane>, (size_t) kNumLanes> lanes;
+    std::vector<const IngestedMidiEvent*> drainScratch;
+    std::array<int, (size_t) kNumLanes> gathered{};
+    std::atomic<juce::uint64> unclaimedDrops{ 0 };
+    std::atomic<juce::uint64> nextSequence{ 1 };
+    std::atomic<juce::uint64> clearBeforeSequence{ 0 };
+    std::atomic<juce::uint64> resetBeforeSequence{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiIngestQueue)
+};
@@ -16,6 +16,7 @@
 #include <map>
 #include <utility>
 #include <algorithm>
+#include <cmath>
 
 
 void MidiManager::handleIncomingMidiMessage(juce::MidiInput* source, const juce::MidiMessage& message)
@@ -56,7 +57,8 @@ void MidiManager::handleIncomingMidiMessage(juce::MidiInput* source, const juce:
 		juce::MidiMessage messageWithChannel = message;
 		messageWithChannel.setChannel(midiChannel);
 		messageWithChannel.setTimeStamp(static_cast<double>(currentTimeTicks));
-		incomingMidi.addEvent(messageWithChannel, 0);
+		// Live input is routed to the selected plugin as it arrives; the audio thread picks it up from its ingest lane
+		mainComponent->getPluginManager().addLiveInputMidi(messageWithChannel, mainComponent->getOrchestraTableModel().getSelectedPluginId());
 
 
 		// Stamp the MIDI message with high-resolution ticks directly
@@ -631,6 +633,12 @@ void MidiManager::exportRecordBufferToMidiFile()
                 bufferCopy = recordBuffer;
         }
 
+        if (headless)
+        {
+                juce::Logger::writeToLog("Export dub file needs a file chooser; not available headless");
+                return;
+        }
+
         juce::FileChooser fileChooser("Export dub File", juce::File::getSpecialLocation(juce::File::userDocumentsDirectory), "*.mid");
         if (!fileChooser.browseForFileToSave(true))
                 return;
@@ -672,6 +680,12 @@ void MidiManager::exportRecordBufferToMidiFile()
 
 void MidiManager::importMidiFileToRecordBuffer()
 {
+        if (headless)
+        {
+                juce::Logger::writeToLog("Import dub file needs a file chooser; not available headless");
+                return;
+        }
+
         juce::FileChooser fileChooser("Import dub File", juce::File::getSpecialLocation(juce::File::userDocumentsDirectory), "*.mid");
         if (!fileChooser.browseForFileToOpen())
                 return;
@@ -840,6 +854,7 @@ bool MidiManager::ensurePluginChannelEntry(const juce::String& pluginId, int cha
                         tags.clear();
                         tags.push_back(trimmedName);
                         instrument.instrumentName = trimmedName;
+                        conductor.publishInstrumentRoutes();
                         mainComponent->getOrchestraTableModel().table.updateContent();
                         return true;
                 }
@@ -929,12 +944,12 @@ void MidiManager::republishRecordedEvents(const juce::MidiBuffer& bufferCopy)
                 if (ticks < 0)
                         ticks = 0;
 
-                juce::int64 timestampMs = 0;
+                juce::int64 timestampUs = 0;
                 if (ticksPerSecond > 0)
-                        timestampMs = static_cast<juce::int64>((static_cast<double>(ticks) * 1000.0) / static_cast<double>(ticksPerSecond));
+                        timestampUs = static_cast<juce::int64>(std::llround((static_cast<double>(ticks) * 1.0e6) / static_cast<double>(ticksPerSecond)));
 
                 juce::MidiMessage messageCopy = metadata.getMessage();
-                pluginManager.addMidiMessage(messageCopy, pluginId, timestampMs);
+                pluginManager.addMidiMessage(messageCopy, pluginId, timestampUs, MidiIngestSource::Overdub);
         }
 
         pluginManager.printTaggedMidiBuffer();
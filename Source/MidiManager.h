@@ -19,7 +19,8 @@ class MainComponent; // Forward declaration
 class MidiManager : public juce::MidiInputCallback
 {
 public:
-	MidiManager(MainComponent * mainComponent, juce::CriticalSection& criticalSection, juce::MidiBuffer& midiBuffer) : mainComponent(mainComponent), midiCriticalSection(criticalSection), incomingMidi(midiBuffer), recordStartTime(juce::Time::getHighResolutionTicks()) {};
+	// A headless manager never opens a file chooser
+	MidiManager(MainComponent * mainComponent, juce::CriticalSection& criticalSection, bool runHeadless = false) : mainComponent(mainComponent), midiCriticalSection(criticalSection), recordStartTime(juce::Time::getHighResolutionTicks()), headless(runHeadless) {};
 	~MidiManager() { closeMidiInput(); };
 
 	// MIDI Input Callback
@@ -50,9 +51,6 @@ public:
 	bool isStripped = false;
     bool playOverdubOnTriggerArmed = false;
 
-	// Access to the MIDI buffer
-	juce::MidiBuffer& getMidiBuffer() { return incomingMidi; }
-
 	// Lock access for thread safety
 	juce::CriticalSection& getCriticalSection() { return midiCriticalSection; }
 
@@ -77,9 +75,9 @@ private:
         juce::int64 recordStartTime; // Start time for recording MIDI messages
 
 	juce::CriticalSection& midiCriticalSection; // Critical section to protect the MIDI buffer
-	juce::MidiBuffer& incomingMidi; // MIDI Buffer to store incoming MIDI messages
 
 	MainComponent* mainComponent; // Pointer to the MainComponent
+	const bool headless;
 
         std::vector<juce::MidiBuffer> overdubHistory;
 
@@ -0,0 +1,382 @@
+#include "MixKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+ #include <immintrin.h>
+ #define OSCDAW_MIX_X86 1
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+ #include <arm_neon.h>
+ #define OSCDAW_MIX_NEON 1
+#endif
+
+// The AVX kernels are compiled for AVX while the rest of the file keeps the baseline target.
+// flatten pulls the shared kernel body and its Ops into the AVX entry points, so they are
+// generated with AVX encodings there and nowhere else. MSVC needs neither.
+#if defined(__GNUC__) || defined(__clang__)
+ #define OSCDAW_AVX_FUNCTION __attribute__((target("avx")))
+ #define OSCDAW_AVX_ENTRY __attribute__((target("avx"), flatten))
+ #if defined(__GNUC__) && !defined(__clang__)
+  #pragma GCC diagnostic ignored "-Wpsabi"
+ #endif
+#else
+ #define OSCDAW_AVX_FUNCTION
+ #define OSCDAW_AVX_ENTRY
+#endif
+
+namespace
+{
+    // Destinations handled per pass; more than this (never in practice) take further passes
+    constexpr int kMaxDestinationsPerPass = 16;
+
+    struct ScalarOps
+    {
+        using Vec = float;
+        static constexpr int width = 1;
+        static inline Vec load(const float* p) { return *p; }
+        static inline void store(float* p, Vec v) { *p = v; }
+        static inline Vec broadcast(float g) { return g; }
+        static inline Vec addScaled(Vec acc, Vec x, Vec g) { return acc + x * g; }
+        static inline Vec absMax(Vec acc, Vec x) { return std::max(acc, std::abs(x)); }
+    };
+
+   #if OSCDAW_MIX_X86
+    struct SseOps
+    {
+        using Vec = __m128;
+        static constexpr int width = 4;
+        static inline Vec load(const float* p) { return _mm_loadu_ps(p); }
+        static inline void store(float* p, Vec v) { _mm_storeu_ps(p, v); }
+        static inline Vec broadcast(float g) { return _mm_set1_ps(g); }
+        static inline Vec addScaled(Vec acc, Vec x, Vec g) { return _mm_add_ps(acc, _mm_mul_ps(x, g)); }
+        static inline Vec absMax(Vec acc, Vec x) { return _mm_max_ps(acc, _mm_andnot_ps(_mm_set1_ps(-0.0f), x)); }
+    };
+
+    struct AvxOps
+    {
+        using Vec = __m256;
+        static constexpr int width = 8;
+        OSCDAW_AVX_FUNCTION static inline Vec load(const float* p) { return _mm256_loadu_ps(p); }
+        OSCDAW_AVX_FUNCTION static inline void store(float* p, Vec v) { _mm256_storeu_ps(p, v); }
+        OSCDAW_AVX_FUNCTION static inline Vec broadcast(float g) { return _mm256_set1_ps(g); }
+        OSCDAW_AVX_FUNCTION static inline Vec addScaled(Vec acc, Vec x, Vec g) { return _mm256_add_ps(acc, _mm256_mul_ps(x, g)); }
+        OSCDAW_AVX_FUNCTION static inline Vec absMax(Vec acc, Vec x) { return _mm256_max_ps(acc, _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x)); }
+    };
+   #elif OSCDAW_MIX_NEON
+    struct NeonOps
+    {
+        using Vec = float32x4_t;
+        static constexpr int width = 4;
+        static inline Vec load(const float* p) { return vld1q_f32(p); }
+        static inline void store(float* p, Vec v) { vst1q_f32(p, v); }
+        static inline Vec broadcast(float g) { return vdupq_n_f32(g); }
+        static inline Vec addScaled(Vec acc, Vec x, Vec g) { return vmlaq_f32(acc, x, g); }
+        static inline Vec absMax(Vec acc, Vec x) { return vmaxq_f32(acc, vabsq_f32(x)); }
+    };
+   #endif
+
+    using MixDestination = MixKernels::Destination;
+
+    // SourceChannels is 1, 2, or 0 for any other count. One pass over the source: every
+    // vector is loaded once and added into each destination channel that takes it.
+    template <typename Ops, int SourceChannels>
+    inline void mixPass(const float* const* source, int numSourceChannels,
+                        const MixDestination* destinations, int numDestinations, int numSamples)
+    {
+        using Vec = typename Ops::Vec;
+        Vec gains[kMaxDestinationsPerPass];
+        for (int d = 0; d < numDestinations; ++d)
+            gains[d] = Ops::broadcast(destinations[d].gain);
+
+        const int vectorEnd = numSamples - numSamples % Ops::width;
+
+        if constexpr (SourceChannels == 1)
+        {
+            const float* mono = source[0];
+            for (int i = 0; i < vectorEnd; i += Ops::width)
+            {
+                const Vec x = Ops::load(mono + i);
+                for (int d = 0; d < numDestinations; ++d)
+                {
+                    const auto& dst = destinations[d];
+                    Ops::store(dst.channels[0] + i, Ops::addScaled(Ops::load(dst.channels[0] + i), x, gains[d]));
+                    if (dst.numChannels > 1)
+                        Ops::store(dst.channels[1] + i, Ops::addScaled(Ops::load(dst.channels[1] + i), x, gains[d]));
+                }
+            }
+
+            for (int i = vectorEnd; i < numSamples; ++i)
+            {
+                for (int d = 0; d < numDestinations; ++d)
+                {
+                    const auto& dst = destinations[d];
+                    dst.channels[0][i] += mono[i] * dst.gain;
+                    if (dst.numChannels > 1)
+                        dst.channels[1][i] += mono[i] * dst.gain;
+                }
+            }
+        }
+        else if constexpr (SourceChannels == 2)
+        {
+            const float* left = source[0];
+            const float* right = source[1];
+            for (int i = 0; i < vectorEnd; i += Ops::width)
+            {
+                const Vec l = Ops::load(left + i);
+                const Vec r = Ops::load(right + i);
+                for (int d = 0; d < numDestinations; ++d)
+                {
+                    const auto& dst = destinations[d];
+                    Ops::store(dst.channels[0] + i, Ops::addScaled(Ops::load(dst.channels[0] + i), l, gains[d]));
+                    if (dst.numChannels > 1)
+                        Ops::store(dst.channels[1] + i, Ops::addScaled(Ops::load(dst.channels[1] + i), r, gains[d]));
+                }
+            }
+
+            for (int i = vectorEnd; i < numSamples; ++i)
+            {
+                for (int d = 0; d < numDestinations; ++d)
+                {
+                    const auto& dst = destinations[d];
+                    dst.channels[0][i] += left[i] * dst.gain;
+                    if (dst.numChannels > 1)
+                        dst.channels[1][i] += right[i] * dst.gain;
+                }
+            }
+        }
+        else
+        {
+            for (int ch = 0; ch < numSourceChannels; ++ch)
+            {
+                const float* src = source[ch];
+                for (int i = 0; i < vectorEnd; i += Ops::width)
+                {
+                    const Vec x = Ops::load(src + i);
+                    for (int d = 0; d < numDestinations; ++d)
+                    {
+                        const auto& dst = destinations[d];
+                        if (ch < dst.numChannels)
+                            Ops::store(dst.channels[ch] + i, Ops::addScaled(Ops::load(dst.channels[ch] + i), x, gains[d]));
+                    }
+                }
+
+                for (int i = vectorEnd; i < numSamples; ++i)
+                {
+                    for (int d = 0; d < numDestinations; ++d)
+                    {
+                        const auto& dst = destinations[d];
+                        if (ch < dst.numChannels)
+                            dst.channels[ch][i] += src[i] * dst.gain;
+                    }
+                }
+            }
+        }
+    }
+
+    template <typename Ops>
+    inline void mixAll(const float* const* source, int numSourceChannels,
+                       const MixDestination* destinations, int numDestinations, int numSamples)
+    {
+        for (int first = 0; first < numDestinations; first += kMaxDestinationsPerPass)
+        {
+            const int count = std::min(kMaxDestinationsPerPass, numDestinations - first);
+            if (numSourceChannels == 1)
+                mixPass<Ops, 1>(source, numSourceChannels, destinations + first, count, numSamples);
+            else if (numSourceChannels == 2)
+                mixPass<Ops, 2>(source, numSourceChannels, destinations + first, count, numSamples);
+            else
+                mixPass<Ops, 0>(source, numSourceChannels, destinations + first, count, numSamples);
+        }
+    }
+
+    // Partial sums stay in float lanes for one channel's block and are summed in double at the end
+    template <typename Ops>
+    inline MixKernels::ChannelStats measureChannel(const float* samples, int numSamples)
+    {
+        using Vec = typename Ops::Vec;
+        Vec peaks = Ops::broadcast(0.0f);
+        Vec squares = Ops::broadcast(0.0f);
+
+        const int vectorEnd = numSamples - numSamples % Ops::width;
+        for (int i = 0; i < vectorEnd; i += Ops::width)
+        {
+            const Vec x = Ops::load(samples + i);
+            peaks = Ops::absMax(peaks, x);
+            squares = Ops::addScaled(squares, x, x);
+        }
+
+        float peakLanes[Ops::width];
+        float squareLanes[Ops::width];
+        Ops::store(peakLanes, peaks);
+        Ops::store(squareLanes, squares);
+
+        MixKernels::ChannelStats stats;
+        for (int lane = 0; lane < Ops::width; ++lane)
+        {
+            stats.peak = std::max(stats.peak, peakLanes[lane]);
+            stats.sumOfSquares += (double) squareLanes[lane];
+        }
+
+        for (int i = vectorEnd; i < numSamples; ++i)
+        {
+            stats.peak = std::max(stats.peak, std::abs(samples[i]));
+            stats.sumOfSquares += (double) samples[i] * (double) samples[i];
+        }
+        return stats;
+    }
+
+    using KernelFunction = void (*)(const float* const*, int, const MixDestination*, int, int);
+    using MeasureFunction = MixKernels::ChannelStats (*)(const float*, int);
+
+    void mixScalar(const float* const* source, int numSourceChannels,
+                   const MixDestination* destinations, int numDestinations, int numSamples)
+    {
+        mixAll<ScalarOps>(source, numSourceChannels, destinations, numDestinations, numSamples);
+    }
+
+    MixKernels::ChannelStats measureScalar(const float* samples, int numSamples)
+    {
+        return measureChannel<ScalarOps>(samples, numSamples);
+    }
+
+   #if OSCDAW_MIX_X86
+    void mixSse(const float* const* source, int numSourceChannels,
+                const MixDestination* destinations, int numDestinations, int numSamples)
+    {
+        mixAll<SseOps>(source, numSourceChannels, destinations, numDestinations, numSamples);
+    }
+
+    MixKernels::ChannelStats measureSse(const float* samples, int numSamples)
+    {
+        return measureChannel<SseOps>(samples, numSamples);
+    }
+
+    OSCDAW_AVX_ENTRY void mixAvx(const float* const* source, int numSourceChannels,
+                                 const MixDestination* destinations, int numDestinations, int numSamples)
+    {
+        mixAll<AvxOps>(source, numSourceChannels, destinations, numDestinations, numSamples);
+    }
+
+    OSCDAW_AVX_ENTRY MixKernels::ChannelStats measureAvx(const float* samples, int numSamples)
+    {
+        return measureChannel<AvxOps>(samples, numSamples);
+    }
+   #elif OSCDAW_MIX_NEON
+    void mixNeon(const float* const* source, int numSourceChannels,
+                 const MixDestination* destinations, int numDestinations, int numSamples)
+    {
+        mixAll<NeonOps>(source, numSourceChannels, destinations, numDestinations, numSamples);
+    }
+
+    MixKernels::ChannelStats measureNeon(const float* samples, int numSamples)
+    {
+        return measureChannel<NeonOps>(samples, numSamples);
+    }
+   #endif
+
+    struct Kernel
+    {
+        KernelFunction function = mixScalar;
+        MeasureFunction measure = measureScalar;
+        const char* name = "Scalar";
+    };
+
+    const Kernel& getKernel()
+    {
+        static const Kernel kernel = []
+        {
+            Kernel k;
+           #if OSCDAW_MIX_X86
+            if (juce::SystemStats::hasAVX())
+                k = { mixAvx, measureAvx, "AVX" };
+            else
+                k = { mixSse, measureSse, "SSE" };
+           #elif OSCDAW_MIX_NEON
+            k = { mixNeon, measureNeon, "NEON" };
+           #endif
+            return k;
+        }();
+        return kernel;
+    }
+}
+
+namespace MixKernels
+{
+    void accumulate(const float* const* source, int numSourceChannels,
+                    const Destination* destinations, int numDestinations, int numSamples)
+    {
+        if (numSourceChannels <= 0 || numDestinations <= 0 || numSamples <= 0)
+            return;
+
+        getKernel().function(source, numSourceChannels, destinations, numDestinations, numSamples);
+    }
+
+    ChannelStats measure(const float* samples, int numSamples)
+    {
+        if (numSamples <= 0)
+            return {};
+
+        return getKernel().measure(samples, numSamples);
+    }
+
+    const char* getInstructionSetName()
+    {
+        return getKernel().name;
+    }
+
+    BenchmarkResult runBenchmark(int numChannels, int numDestinations, int blockSize, int iterations)
+    {
+        BenchmarkResult result;
+        result.instructionSet = getInstructionSetName();
+        result.numChannels = juce::jlimit(1, 64, numChannels);
+        result.numDestinations = juce::jlimit(1, 64, numDestinations);
+        result.blockSize = juce::jlimit(16, 8192, blockSize);
+        result.iterations = juce::jlimit(1, 1000000, iterations);
+
+        juce::AudioBuffer<float> source(result.numChannels, result.blockSize);
+        juce::Random random;
+        for (int ch = 0; ch < source.getNumChannels(); ++ch)
+            for (int i = 0; i < result.blockSize; ++i)
+                source.setSample(ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+        std::vector<juce::AudioBuffer<float>> buses((size_t) result.numDestinations,
+                                                    juce::AudioBuffer<float>(result.numChannels, result.blockSize));
+        std::vector<Destination> destinations;
+        for (auto& bus : buses)
+        {
+            bus.clear();
+            destinations.push_back({ bus.getArrayOfWritePointers(), bus.getNumChannels(), 0.5f });
+        }
+
+        // Per-bus baseline: what AudioRouter did before, one addFrom pass per destination
+        auto timePerBus = [&]
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+            for (int it = 0; it < result.iterations; ++it)
+                for (auto& bus : buses)
+                    for (int ch = 0; ch < result.numChannels; ++ch)
+                        bus.addFrom(ch, 0, source, ch, 0, result.blockSize, 0.5f);
+            return juce::Time::getHighResolutionTicks() - start;
+        };
+
+        auto timeFused = [&]
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+            for (int it = 0; it < result.iterations; ++it)
+                accumulate(source.getArrayOfReadPointers(), result.numChannels,
+                           destinations.data(), (int) destinations.size(), result.blockSize);
+            return juce::Time::getHighResolutionTicks() - start;
+        };
+
+        // Warm the caches and the kernel selection before timing
+        timePerBus();
+        timeFused();
+
+        const double nsPerTick = 1.0e9 / (double) juce::Time::getHighResolutionTicksPerSecond();
+        result.perBusNsPerBlock = (double) timePerBus() * nsPerTick / result.iterations;
+        result.fusedNsPerBlock = (double) timeFused() * nsPerTick / result.iterations;
+        result.speedup = result.fusedNsPerBlock > 0.0 ? result.perBusNsPerBlock / result.fusedNsPerBlock : 0.0;
+        return result;
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Fused accumulate for routing one block of audio into several buses at once. Each source
+// sample is loaded once and added to every destination while it is still in a register,
+// rather than one full pass over the source per destination. The instruction set (AVX, SSE,
+// NEON or plain C++) is picked once, on first use; mono, stereo and N-channel sources each
+// have their own kernel.
+namespace MixKernels
+{
+    struct Destination
+    {
+        float* const* channels = nullptr;
+        int numChannels = 0;
+        float gain = 1.0f;
+    };
+
+    // Realtime safe. destination[ch] += gain * source[ch] for every channel both have; a mono
+    // source also feeds channel 1 of a wider destination, as AudioRouter has always done.
+    void accumulate(const float* const* source, int numSourceChannels,
+                    const Destination* destinations, int numDestinations, int numSamples);
+
+    struct ChannelStats
+    {
+        float peak = 0.0f;          // largest absolute sample
+        double sumOfSquares = 0.0;
+    };
+
+    // Realtime safe. One pass over one channel, with the same instruction set as accumulate.
+    ChannelStats measure(const float* samples, int numSamples);
+
+    // "AVX", "SSE", "NEON" or "Scalar"
+    const char* getInstructionSetName();
+
+    struct BenchmarkResult
+    {
+        juce::String instructionSet;
+        int numChannels = 0;
+        int numDestinations = 0;
+        int blockSize = 0;
+        int iterations = 0;
+        double fusedNsPerBlock = 0.0;
+        double perBusNsPerBlock = 0.0;   // one AudioBuffer::addFrom pass per destination
+        double speedup = 0.0;
+    };
+
+    // Message thread only: allocates, and takes as long as the iterations need
+    BenchmarkResult runBenchmark(int numChannels, int numDestinations, int blockSize, int iterations);
+}
@@ -0,0 +1,111 @@
+#include "NullAudioDevice.h"
+
+namespace
+{
+    constexpr int kStopTimeoutMs = 2000;
+    constexpr int kMaxBlocksBehind = 8;   // further behind than this, the clock skips ahead
+}
+
+NullAudioIODevice::NullAudioIODevice()
+    : juce::AudioIODevice(kDeviceName, kTypeName),
+      juce::Thread("Null audio device")
+{
+}
+
+NullAudioIODevice::~NullAudioIODevice()
+{
+    close();
+}
+
+juce::String NullAudioIODevice::open(const juce::BigInteger&, const juce::BigInteger& outputChannels,
+                                     double newSampleRate, int bufferSizeSamples)
+{
+    close();
+
+    sampleRate = newSampleRate > 0.0 ? newSampleRate : 48000.0;
+    bufferSize = bufferSizeSamples > 0 ? bufferSizeSamples : getDefaultBufferSize();
+    activeOutputs = outputChannels;
+    activeOutputs.setRange(2, juce::jmax(0, activeOutputs.getHighestBit() - 1), false);
+    if (activeOutputs.isZero())
+        activeOutputs.setRange(0, 2, true);
+    opened = true;
+    return {};
+}
+
+void NullAudioIODevice::close()
+{
+    stop();
+    opened = false;
+}
+
+void NullAudioIODevice::start(juce::AudioIODeviceCallback* newCallback)
+{
+    if (!opened || newCallback == nullptr)
+        return;
+
+    stop();
+    newCallback->audioDeviceAboutToStart(this);
+    {
+        const juce::ScopedLock sl(callbackLock);
+        callback = newCallback;
+    }
+    startThread(juce::Thread::Priority::highest);
+}
+
+void NullAudioIODevice::stop()
+{
+    stopThread(kStopTimeoutMs);
+
+    juce::AudioIODeviceCallback* oldCallback = nullptr;
+    {
+        const juce::ScopedLock sl(callbackLock);
+        std::swap(oldCallback, callback);
+    }
+
+    if (oldCallback != nullptr)
+        oldCallback->audioDeviceStopped();
+}
+
+void NullAudioIODevice::run()
+{
+    const int numChannels = juce::jmax(1, activeOutputs.countNumberOfSetBits());
+    juce::AudioBuffer<float> output(numChannels, bufferSize);
+    const double blockMs = 1000.0 * bufferSize / sampleRate;
+    double nextBlockMs = juce::Time::getMillisecondCounterHiRes();
+
+    while (!threadShouldExit())
+    {
+        {
+            const juce::ScopedLock sl(callbackLock);
+            if (callback != nullptr)
+                callback->audioDeviceIOCallbackWithContext(nullptr, 0, output.getArrayOfWritePointers(), numChannels,
+                                                           bufferSize, {});
+        }
+
+        // Keep to the sample rate on average; a block that ran long is made up by the next wait
+        nextBlockMs += blockMs;
+        const double nowMs = juce::Time::getMillisecondCounterHiRes();
+        if (nextBlockMs < nowMs - kMaxBlocksBehind * blockMs)
+            nextBlockMs = nowMs;
+        else if (nextBlockMs > nowMs + 1.0)
+            wait(juce::roundToInt(nextBlockMs - nowMs));
+    }
+}
+
+juce::StringArray NullAudioIODeviceType::getDeviceNames(bool wantInputNames) const
+{
+    if (wantInputNames)
+        return {};
+
+    return { NullAudioIODevice::kDeviceName };
+}
+
+int NullAudioIODeviceType::getIndexOfDevice(juce::AudioIODevice* device, bool asInput) const
+{
+    return !asInput && dynamic_cast<NullAudioIODevice*>(device) != nullptr ? 0 : -1;
+}
+
+juce::AudioIODevice* NullAudioIODeviceType::createDevice(const juce::String& outputDeviceName, const juce::String&)
+{
+    return outputDeviceName == NullAudioIODevice::kDeviceName ? new NullAudioIODevice() : nullptr;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// An output-only audio device with no hardware behind it: a thread calls the audio callback
+// at the pace the sample rate and block size imply, and the output goes nowhere. Lets the
+// server run, take MIDI and render on machines with no sound card or no driver.
+class NullAudioIODevice : public juce::AudioIODevice,
+                          private juce::Thread
+{
+public:
+    static constexpr const char* kTypeName = "Null";
+    static constexpr const char* kDeviceName = "Null Output";
+
+    NullAudioIODevice();
+    ~NullAudioIODevice() override;
+
+    juce::StringArray getOutputChannelNames() override { return { "Left", "Right" }; }
+    juce::StringArray getInputChannelNames() override { return {}; }
+    juce::Array<double> getAvailableSampleRates() override { return { 44100.0, 48000.0, 88200.0, 96000.0 }; }
+    juce::Array<int> getAvailableBufferSizes() override { return { 64, 128, 256, 512, 1024, 2048, 4096 }; }
+    int getDefaultBufferSize() override { return 512; }
+
+    juce::String open(const juce::BigInteger& inputChannels, const juce::BigInteger& outputChannels,
+                      double sampleRate, int bufferSizeSamples) override;
+    void close() override;
+    bool isOpen() override { return opened; }
+    void start(juce::AudioIODeviceCallback* callback) override;
+    void stop() override;
+    bool isPlaying() override { return isThreadRunning(); }
+    juce::String getLastError() override { return {}; }
+
+    int getCurrentBufferSizeSamples() override { return bufferSize; }
+    double getCurrentSampleRate() override { return sampleRate; }
+    int getCurrentBitDepth() override { return 32; }
+    juce::BigInteger getActiveOutputChannels() const override { return activeOutputs; }
+    juce::BigInteger getActiveInputChannels() const override { return {}; }
+    int getOutputLatencyInSamples() override { return 0; }
+    int getInputLatencyInSamples() override { return 0; }
+
+private:
+    void run() override;
+
+    juce::CriticalSection callbackLock;
+    juce::AudioIODeviceCallback* callback = nullptr;
+    juce::BigInteger activeOutputs;
+    double sampleRate = 48000.0;
+    int bufferSize = 512;
+    bool opened = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NullAudioIODevice)
+};
+
+class NullAudioIODeviceType : public juce::AudioIODeviceType
+{
+public:
+    NullAudioIODeviceType() : juce::AudioIODeviceType(NullAudioIODevice::kTypeName) {}
+
+    void scanForDevices() override {}
+    juce::StringArray getDeviceNames(bool wantInputNames) const override;
+    int getDefaultDeviceIndex(bool forInput) const override { return forInput ? -1 : 0; }
+    int getIndexOfDevice(juce::AudioIODevice* device, bool asInput) const override;
+    bool hasSeparateInputsAndOutputs() const override { return true; }
+    juce::AudioIODevice* createDevice(const juce::String& outputDeviceName, const juce::String& inputDeviceName) override;
+
+private:
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(NullAudioIODeviceType)
+};
@@ -0,0 +1,227 @@
+#include "OscCommands.h"
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+namespace OscCommands
+{
+    namespace
+    {
+        constexpr Spec kSpecs[] = {
+            { "note_on", Command::NoteOn, Family::Midi, "iit", true },
+            { "note_off", Command::NoteOff, Family::Midi, "it", true },
+            { "controller", Command::Controller, Family::Midi, "iit", true },
+            { "controller_ramp", Command::ControllerRamp, Family::Midi, "iiint", true },
+            { "channel_aftertouch", Command::ChannelAftertouch, Family::Midi, "it", true },
+            { "poly_aftertouch", Command::PolyAftertouch, Family::Midi, "iit", true },
+            { "pitchbend", Command::PitchBend, Family::Midi, "it", true },
+            { "program_change", Command::ProgramChange, Family::Midi, "it", true },
+            { "sync_request", Command::SyncRequest, Family::Midi, "s", true },
+            { "stop_request", Command::StopRequest, Family::Midi, "", true },
+            { "save_plugin_data", Command::SavePluginData, Family::Midi, "sss", false },
+            { "request_dawServerData", Command::RequestDawServerData, Family::Midi, "s", false },
+            { "load_plugin_data", Command::LoadPluginData, Family::Midi, "ss", false },
+            { "add_instrument", Command::AddInstrument, Family::Orchestra, "", false },
+            { "get_recorded", Command::GetRecorded, Family::Orchestra, "", false },
+            { "select_by_tag", Command::SelectByTag, Family::Orchestra, "s", false },
+            { "open_instrument", Command::OpenInstrument, Family::Orchestra, "s", false },
+            { "save_project", Command::SaveProject, Family::Orchestra, "", false },
+            { "restore_project", Command::RestoreProject, Family::Orchestra, "", false },
+            { "restore_from_file", Command::RestoreFromFile, Family::Orchestra, "", false },
+            { "set_priority", Command::SetPriority, Family::Orchestra, "i", false },
+            { "set_cpu_watchdog", Command::SetCpuWatchdog, Family::Orchestra, "n", false },
+            { "add_return", Command::AddReturn, Family::Orchestra, "s", false },
+            { "set_inserts", Command::SetInserts, Family::Orchestra, "s", false },
+            { "remove_return", Command::RemoveReturn, Family::Orchestra, "s", false },
+            { "set_bus_output", Command::SetBusOutput, Family::Orchestra, "ss", false },
+            { "set_send", Command::SetSend, Family::Orchestra, "sn", false },
+            { "request_tags", Command::RequestTags, Family::Orchestra, "", false },
+        };
+        constexpr size_t kNumSpecs = std::size(kSpecs);
+
+        // FNV-1a of the name, folded to a slot. The seed is the first one that gives every
+        // command its own slot; add a command and the static_assert says whether it still does.
+        constexpr size_t kTableSize = 64;
+        constexpr juce::uint32 kSeed = 1477;
+
+        constexpr size_t slotOf(const char* name)
+        {
+            juce::uint32 hash = 2166136261u ^ kSeed;
+            for (; *name != 0; ++name)
+                hash = (hash ^ static_cast<juce::uint8>(*name)) * 16777619u;
+            return (hash ^ (hash >> 16)) & (kTableSize - 1);
+        }
+
+        constexpr bool hashIsPerfect()
+        {
+            for (size_t i = 0; i < kNumSpecs; ++i)
+                for (size_t j = i + 1; j < kNumSpecs; ++j)
+                    if (slotOf(kSpecs[i].name) == slotOf(kSpecs[j].name))
+                        return false;
+            return true;
+        }
+        static_assert(kNumSpecs < kTableSize, "Grow kTableSize");
+        static_assert(hashIsPerfect(), "Two commands share a slot; pick another kSeed");
+
+        // Index into kSpecs per slot, -1 for an empty slot
+        constexpr auto kSlots = []
+        {
+            std::array<juce::int8, kTableSize> slots{};
+            for (auto& slot : slots)
+                slot = -1;
+            for (size_t i = 0; i < kNumSpecs; ++i)
+                slots[slotOf(kSpecs[i].name)] = static_cast<juce::int8>(i);
+            return slots;
+        }();
+
+        double numberOf(const juce::OSCArgument& argument)
+        {
+            if (argument.isFloat32())
+                return argument.getFloat32();
+            if (argument.isInt32())
+                return static_cast<double>(argument.getInt32());
+            return argument.getString().getDoubleValue();
+        }
+
+        void reportBadArgument(const Spec& spec, int index, char type, int numArguments)
+        {
+#if JUCE_DEBUG
+            if (index >= numArguments)
+                std::fprintf(stderr, "OSC %s is missing argument %d\n", spec.name, index);
+            else
+                std::fprintf(stderr, "OSC %s argument %d expected '%c'\n", spec.name, index, type);
+#else
+            juce::ignoreUnused(spec, index, type, numArguments);
+#endif
+        }
+    }
+
+    const Spec* find(const char* name)
+    {
+        const auto index = kSlots[slotOf(name)];
+        if (index < 0 || std::strcmp(kSpecs[index].name, name) != 0)
+            return nullptr;
+
+        return &kSpecs[index];
+    }
+
+    bool decode(const juce::OSCMessage& message, int firstArg, const Spec& spec, Arguments& arguments)
+    {
+        Arguments decoded;
+        size_t numInts = 0;
+        size_t numStrings = 0;
+        int index = firstArg;
+        for (const char* type = spec.signature; *type != 0; ++type, ++index)
+        {
+            if (index >= message.size())
+            {
+                reportBadArgument(spec, index, *type, message.size());
+                return false;
+            }
+
+            const auto& argument = message[index];
+            bool valid = true;
+            switch (*type)
+            {
+                case 'i':
+                    valid = argument.isInt32();
+                    if (valid)
+                        decoded.ints[numInts++] = argument.getInt32();
+                    break;
+                case 'n':
+                    valid = argument.isInt32() || argument.isFloat32() || argument.isString();
+                    if (valid)
+                        decoded.number = numberOf(argument);
+                    break;
+                case 's':
+                    valid = argument.isString();
+                    if (valid)
+                        decoded.strings[numStrings++] = argument.getString();
+                    break;
+                case 't':
+                    valid = argument.isString() || argument.isInt32() || argument.isFloat32();
+                    decoded.timestamp = &argument;
+                    break;
+                default:
+                    break;
+            }
+
+            if (!valid)
+            {
+                reportBadArgument(spec, index, *type, message.size());
+                return false;
+            }
+        }
+
+        decoded.next = index;
+        arguments = std::move(decoded);
+        return true;
+    }
+
+    BenchmarkResult runBenchmark(int iterations)
+    {
+        BenchmarkResult result;
+        result.iterations = juce::jlimit(1, 10000000, iterations);
+
+        // Live traffic is mostly notes, with some controllers and the odd sync
+        std::vector<juce::OSCMessage> messages;
+        auto add = [&messages](std::initializer_list<juce::OSCArgument> arguments)
+        {
+            juce::OSCMessage message("/midi/message");
+            for (const auto& argument : arguments)
+                message.addArgument(argument);
+            messages.push_back(std::move(message));
+        };
+        const juce::String time("1712345678.123456");
+        const juce::String tag("strings");
+        add({ juce::String("note_on"), 60, 100, time, tag });
+        add({ juce::String("note_off"), 60, time, tag });
+        add({ juce::String("note_on"), 64, 90, time, tag });
+        add({ juce::String("note_off"), 64, time, tag });
+        add({ juce::String("controller"), 1, 64, time, tag });
+        add({ juce::String("pitchbend"), 8192, time, tag });
+        add({ juce::String("poly_aftertouch"), 60, 30, time, tag });
+        add({ juce::String("sync_request"), time });
+
+        volatile int sink = 0;
+        auto dispatch = [&](auto&& lookup)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+            for (int it = 0; it < result.iterations; ++it)
+            {
+                for (const auto& message : messages)
+                {
+                    Arguments arguments;
+                    if (const auto* spec = lookup(message[0].getString()))
+                        if (decode(message, 1, *spec, arguments))
+                            sink = sink + arguments.next + static_cast<int>(spec->command);
+                }
+            }
+            return juce::Time::getHighResolutionTicks() - start;
+        };
+
+        auto hashed = [](const juce::String& name) { return find(name); };
+        // What dispatch did before: compare the name against each command in turn
+        auto linear = [](const juce::String& name) -> const Spec*
+        {
+            for (const auto& spec : kSpecs)
+                if (name == spec.name)
+                    return &spec;
+            return nullptr;
+        };
+
+        // Warm the caches before timing
+        dispatch(hashed);
+        dispatch(linear);
+
+        const double ticksPerSecond = static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+        const double numMessages = static_cast<double>(result.iterations) * static_cast<double>(messages.size());
+        const auto hashedTicks = juce::jmax<juce::int64>(1, dispatch(hashed));
+        const auto linearTicks = juce::jmax<juce::int64>(1, dispatch(linear));
+        result.hashedMessagesPerSecond = numMessages * ticksPerSecond / static_cast<double>(hashedTicks);
+        result.linearMessagesPerSecond = numMessages * ticksPerSecond / static_cast<double>(linearTicks);
+        result.speedup = result.hashedMessagesPerSecond / result.linearMessagesPerSecond;
+        return result;
+    }
+}
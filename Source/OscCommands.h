@@ -0,0 +1,94 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+// The commands named in /midi/message and /orchestra messages, found through a perfect hash
+// built at compile time: one hash of the name and one string compare, whatever the command.
+// Each command carries the signature of the arguments that follow its name, and decode checks
+// and reads them in a single pass. MIDI commands can also be sent to /midi/<name> directly, with
+// their arguments from index 0.
+namespace OscCommands
+{
+    enum class Command
+    {
+        // /midi/message
+        NoteOn,
+        NoteOff,
+        Controller,
+        ControllerRamp,
+        ChannelAftertouch,
+        PolyAftertouch,
+        PitchBend,
+        ProgramChange,
+        SyncRequest,
+        StopRequest,
+        SavePluginData,
+        RequestDawServerData,
+        LoadPluginData,
+        // /orchestra
+        AddInstrument,
+        GetRecorded,
+        SelectByTag,
+        OpenInstrument,
+        SaveProject,
+        RestoreProject,
+        RestoreFromFile,
+        SetPriority,
+        SetCpuWatchdog,
+        AddReturn,
+        SetInserts,
+        RemoveReturn,
+        SetBusOutput,
+        SetSend,
+        RequestTags
+    };
+
+    enum class Family
+    {
+        Midi,
+        Orchestra
+    };
+
+    struct Spec
+    {
+        const char* name;
+        Command command;
+        Family family;
+        // One character per required argument after the name: 'i' Int32, 'n' number (Int32,
+        // Float32 or numeric string), 's' String, 't' timestamp (String, Int32 or Float32).
+        // Arguments past the signature (tags, mostly) are the command's own business.
+        const char* signature;
+        bool realtime;   // handled on the receiver thread, without waiting for the message thread
+    };
+
+    // The name's command, or nullptr
+    const Spec* find(const char* name);
+    inline const Spec* find(const juce::String& name) { return find(name.toRawUTF8()); }
+
+    // A command's arguments, read by its signature
+    struct Arguments
+    {
+        std::array<int, 4> ints{};                      // 'i' arguments, in order
+        double number = 0.0;                            // the 'n' argument
+        std::array<juce::String, 3> strings;            // 's' arguments, in order
+        const juce::OSCArgument* timestamp = nullptr;   // the 't' argument
+        int next = 0;                                   // message index after the signature
+    };
+
+    // Realtime safe (no allocation). Checks the arguments from firstArg against the signature
+    // and reads them into arguments; false, and nothing read, if one is missing or mistyped.
+    bool decode(const juce::OSCMessage& message, int firstArg, const Spec& spec, Arguments& arguments);
+
+    struct BenchmarkResult
+    {
+        int iterations = 0;
+        double hashedMessagesPerSecond = 0.0;   // find and decode
+        double linearMessagesPerSecond = 0.0;   // the String compare chain this replaced, then decode
+        double speedup = 0.0;
+    };
+
+    // Message thread only. Looks up and decodes a mix of note, controller and sync messages,
+    // iterations times each way; no command is run.
+    BenchmarkResult runBenchmark(int iterations);
+}
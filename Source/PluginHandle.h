@@ -0,0 +1,34 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Interned reference to a plugin slot: slot index in the low bits, slot generation above.
+// Handles are issued when a plugin id is first instantiated and go stale when the slot is
+// released, so the audio thread can validate a target with two integer compares.
+using PluginHandle = juce::uint32;
+
+constexpr PluginHandle kInvalidPluginHandle = 0;
+
+namespace PluginHandles
+{
+    constexpr int kIndexBits = 16;
+    constexpr juce::uint32 kIndexMask = (1u << kIndexBits) - 1u;
+    constexpr int kMaxSlots = (int) kIndexMask + 1;
+    constexpr juce::uint32 kMaxGeneration = 0xffffu;
+
+    // Generations start at 1, so a valid handle is never 0
+    constexpr PluginHandle make(int slotIndex, juce::uint32 generation)
+    {
+        return (generation << kIndexBits) | ((juce::uint32) slotIndex & kIndexMask);
+    }
+
+    constexpr int slotIndexOf(PluginHandle handle) { return (int) (handle & kIndexMask); }
+    constexpr juce::uint32 generationOf(PluginHandle handle) { return handle >> kIndexBits; }
+}
+
+// A plugin id resolved to its handle once, off the audio thread
+struct PluginTarget
+{
+    juce::String pluginId;
+    PluginHandle handle = kInvalidPluginHandle;
+};
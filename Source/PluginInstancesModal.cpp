@@ -1,6 +1,7 @@
 #include "PluginInstancesModal.h"
 #include "PluginManager.h"
 #include "RenamePluginDialog.h"
+#include <algorithm>
 
 PluginInstancesModal::PluginInstancesModal(PluginManager& managerRef,
 	std::function<void(const juce::String&, const juce::String&)> renameCallback)
@@ -44,7 +45,15 @@ PluginInstancesModal::PluginInstancesModal(PluginManager& managerRef,
 void PluginInstancesModal::refreshInstances()
 {
 	instances = pluginManager.getPluginInstanceInfos();
-	countLabel.setText("Active: " + juce::String((int)instances.size()), juce::dontSendNotification);
+	const auto asleep = std::count_if(instances.begin(), instances.end(),
+		[](const PluginManager::PluginInstanceInfo& info) { return info.sleeping; });
+	const auto shed = std::count_if(instances.begin(), instances.end(),
+		[](const PluginManager::PluginInstanceInfo& info) { return info.shed; });
+	const auto callbackLoad = pluginManager.getDspLoadReport().callback;
+	countLabel.setText("Active: " + juce::String((int)instances.size()) + "  Asleep: " + juce::String((int)asleep)
+		+ "  Shed: " + juce::String((int)shed)
+		+ "  Overruns: " + juce::String((int)callbackLoad.overruns),
+		juce::dontSendNotification);
 	instanceList.updateContent();
 	repaint();
 }
@@ -70,9 +79,28 @@ void PluginInstancesModal::paintListBoxItem(int rowNumber, juce::Graphics& g, in
 	g.setFont(14.0f);
 	g.drawFittedText(info.pluginId, 8, 2, width - 16, height / 2, juce::Justification::centredLeft, 1);
 
+	// Share of blocks skipped while idle, i.e. the processing time sleep saved for this plugin
+	juce::String detail = info.pluginName + " - priority " + juce::String(info.priority);
+	if (info.shed)
+		detail << " (shed)";
+	const auto totalBlocks = info.blocksProcessed + info.blocksSlept;
+	if (totalBlocks > 0)
+	{
+		const auto sleptPercent = juce::roundToInt(100.0 * (double)info.blocksSlept / (double)totalBlocks);
+		detail << " - " << (info.sleeping ? "asleep" : "awake") << ", slept " << sleptPercent << "% of blocks";
+	}
+	if (info.dspLoad.count > 0)
+	{
+		// processBlock time as a share of the buffer period
+		detail << " - DSP mean " << juce::String(info.dspLoad.meanPercent, 1) << "%, p99 "
+			<< juce::String(info.dspLoad.p99Percent, 1) << "%, max " << juce::String(info.dspLoad.maxPercent, 1) << "%";
+		if (info.dspLoad.overruns > 0)
+			detail << ", " << (int)info.dspLoad.overruns << " over budget";
+	}
+
 	g.setFont(12.0f);
 	g.setColour(juce::Colours::lightgrey);
-	g.drawFittedText(info.pluginName, 8, height / 2, width - 16, height / 2, juce::Justification::centredLeft, 1);
+	g.drawFittedText(detail, 8, height / 2, width - 16, height / 2, juce::Justification::centredLeft, 1);
 }
 
 void PluginInstancesModal::listBoxItemClicked(int row, const juce::MouseEvent& event)
@@ -91,7 +119,7 @@ void PluginInstancesModal::resized()
 {
 	auto bounds = getLocalBounds().reduced(12);
 	auto header = bounds.removeFromTop(30);
-	titleLabel.setBounds(header.removeFromLeft(bounds.getWidth() * 2 / 3));
+	titleLabel.setBounds(header.removeFromLeft(bounds.getWidth() / 3));
 	countLabel.setBounds(header);
 
 	bounds.removeFromTop(4);
@@ -0,0 +1,195 @@
+#include "PluginLoader.h"
+
+namespace
+{
+    constexpr int kShutdownTimeoutMs = 10000;
+
+    int poolSizeFor(int numThreads)
+    {
+        return numThreads > 0 ? numThreads : juce::jmax(1, juce::SystemStats::getNumCpus());
+    }
+}
+
+PluginLoader::PluginLoader(juce::AudioPluginFormatManager& formatManagerToUse, AdmitFunction admitFunction, int numThreads)
+    : formatManager(formatManagerToUse),
+      admit(std::move(admitFunction)),
+      pool(poolSizeFor(numThreads))
+{
+}
+
+PluginLoader::~PluginLoader()
+{
+    alive->store(false);
+    queue.clear();
+
+    // Jobs already running finish their plugin; the rest are deleted along with their instances
+    pool.removeAllJobs(true, kShutdownTimeoutMs);
+}
+
+std::shared_future<PluginLoader::Result> PluginLoader::load(const juce::PluginDescription& description,
+                                                           const juce::String& pluginId,
+                                                           double sampleRate, int blockSize,
+                                                           FinishedFunction onFinished)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    Request request;
+    request.description = description;
+    request.pluginId = pluginId;
+    request.sampleRate = sampleRate;
+    request.blockSize = blockSize;
+    request.promise = std::make_shared<std::promise<Result>>();
+    request.onFinished = std::move(onFinished);
+
+    std::shared_future<Result> future = request.promise->get_future().share();
+    queue.push_back(std::move(request));
+    ++pending;
+
+    if (!creating)
+        scheduleNextCreation();
+
+    return future;
+}
+
+std::shared_future<PluginLoader::Result> PluginLoader::loadWith(const juce::String& pluginId,
+                                                               double sampleRate, int blockSize,
+                                                               CreateFunction create,
+                                                               FinishedFunction onFinished)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    Request request;
+    request.pluginId = pluginId;
+    request.sampleRate = sampleRate;
+    request.blockSize = blockSize;
+    request.promise = std::make_shared<std::promise<Result>>();
+    request.onFinished = std::move(onFinished);
+
+    std::shared_future<Result> future = request.promise->get_future().share();
+    ++pending;
+
+    pool.addJob([this, request, create = std::move(create)]
+                {
+                    juce::String error;
+                    std::unique_ptr<juce::AudioPluginInstance> instance;
+                    try
+                    {
+                        instance = create(error);
+                    }
+                    catch (const std::exception& e)
+                    {
+                        error = e.what();
+                    }
+                    catch (...)
+                    {
+                        error = "unknown exception";
+                    }
+
+                    if (instance == nullptr)
+                    {
+                        DBG("PluginLoader: could not create " << request.pluginId << ": " << error);
+                        finish(request, { request.pluginId, false, error });
+                        return;
+                    }
+
+                    prepareAndAdmit(request, instance);
+                });
+
+    return future;
+}
+
+void PluginLoader::scheduleNextCreation()
+{
+    // A turn of the message loop between plugins keeps the UI, and admissions, moving
+    creating = true;
+    juce::MessageManager::callAsync([this, alive = alive]
+                                    {
+                                        if (alive->load())
+                                            createNext();
+                                    });
+}
+
+void PluginLoader::createNext()
+{
+    if (queue.empty())
+    {
+        creating = false;
+        return;
+    }
+
+    auto request = std::move(queue.front());
+    queue.pop_front();
+
+    formatManager.createPluginInstanceAsync(
+        request.description, request.sampleRate, request.blockSize,
+        [this, alive = alive, request](std::unique_ptr<juce::AudioPluginInstance> instance, const juce::String& error)
+        {
+            if (!alive->load())
+                return;
+
+            if (instance == nullptr)
+            {
+                DBG("PluginLoader: could not create " << request.pluginId << ": " << error);
+                finish(request, { request.pluginId, false, error });
+            }
+            else
+            {
+                // Shared, so a job deleted before it runs still destroys its instance
+                auto holder = std::make_shared<std::unique_ptr<juce::AudioPluginInstance>>(std::move(instance));
+                pool.addJob([this, request, holder] { prepareAndAdmit(request, *holder); });
+            }
+
+            scheduleNextCreation();
+        });
+}
+
+void PluginLoader::prepareAndAdmit(const Request& request, std::unique_ptr<juce::AudioPluginInstance>& instance)
+{
+    // Pool thread
+    Result result{ request.pluginId, false, {} };
+    try
+    {
+        instance->prepareToPlay(request.sampleRate, request.blockSize);
+        result.loaded = admit(request.pluginId, instance);
+        if (!result.loaded)
+            result.error = "not admitted";
+    }
+    catch (const std::exception& e)
+    {
+        result.error = e.what();
+    }
+    catch (...)
+    {
+        result.error = "unknown exception";
+    }
+
+    if (instance != nullptr)
+    {
+        // Plugins are torn down on the message thread, as VST3 expects
+        DBG("PluginLoader: " << request.pluginId << " not loaded: " << result.error);
+        auto* unused = instance.release();
+        juce::MessageManager::callAsync([unused]
+                                        {
+                                            unused->releaseResources();
+                                            delete unused;
+                                        });
+    }
+
+    finish(request, std::move(result));
+}
+
+void PluginLoader::finish(const Request& request, Result result)
+{
+    // Any thread
+    request.promise->set_value(result);
+    --pending;
+
+    if (request.onFinished)
+    {
+        juce::MessageManager::callAsync([alive = alive, onFinished = request.onFinished, result]
+                                        {
+                                            if (alive->load())
+                                                onFinished(result);
+                                        });
+    }
+}
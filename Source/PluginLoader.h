@@ -0,0 +1,82 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+
+// Loads plugin instances without holding up the caller, so a project restore can bring in
+// dozens of plugins at once. JUCE constructs every plugin format on the message thread, so
+// construction is queued there and runs one plugin per message loop turn. prepareToPlay and
+// admission into the engine then run on a thread pool, overlapping with the construction of
+// the plugins behind it. Plugins that are not built on the message thread (those hosted in a
+// worker process) are created on the pool as well, through loadWith. A load's future is ready
+// once its instance was admitted, or failed.
+class PluginLoader
+{
+public:
+    struct Result
+    {
+        juce::String pluginId;
+        bool loaded = false;
+        juce::String error;
+    };
+
+    // Pool thread, with a prepared instance: take it and return true, or leave it and return
+    // false to have it destroyed on the message thread
+    using AdmitFunction = std::function<bool(const juce::String& pluginId, std::unique_ptr<juce::AudioPluginInstance>& instance)>;
+    using FinishedFunction = std::function<void(const Result&)>;
+    // Pool thread: builds the instance, or returns nullptr and sets error
+    using CreateFunction = std::function<std::unique_ptr<juce::AudioPluginInstance>(juce::String& error)>;
+
+    // numThreads < 0 picks one per CPU core
+    PluginLoader(juce::AudioPluginFormatManager& formatManager, AdmitFunction admit, int numThreads = -1);
+
+    // Message thread: loads not admitted yet are dropped and their instances destroyed
+    ~PluginLoader();
+
+    // Message thread. onFinished is called on the message thread once the load has succeeded
+    // or failed, unless the loader is gone by then.
+    std::shared_future<Result> load(const juce::PluginDescription& description, const juce::String& pluginId,
+                                    double sampleRate, int blockSize, FinishedFunction onFinished = {});
+
+    // Message thread. As load, but the instance is built by create on the pool, so a slow
+    // build never holds up the message thread.
+    std::shared_future<Result> loadWith(const juce::String& pluginId, double sampleRate, int blockSize,
+                                        CreateFunction create, FinishedFunction onFinished = {});
+
+    // Loads queued, being built or being prepared
+    int getNumPending() const { return pending.load(); }
+
+private:
+    struct Request
+    {
+        juce::PluginDescription description;
+        juce::String pluginId;
+        double sampleRate = 44100.0;
+        int blockSize = 512;
+        std::shared_ptr<std::promise<Result>> promise;
+        FinishedFunction onFinished;
+    };
+
+    void scheduleNextCreation();
+    void createNext();
+    void prepareAndAdmit(const Request& request, std::unique_ptr<juce::AudioPluginInstance>& instance);
+    void finish(const Request& request, Result result);
+
+    juce::AudioPluginFormatManager& formatManager;
+    AdmitFunction admit;
+    juce::ThreadPool pool;
+
+    // Message thread only
+    std::deque<Request> queue;
+    bool creating = false;
+
+    // Cleared by the destructor; message thread callbacks check it before touching the loader
+    std::shared_ptr<std::atomic<bool>> alive = std::make_shared<std::atomic<bool>>(true);
+    std::atomic<int> pending{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginLoader)
+};
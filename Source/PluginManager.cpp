@@ -17,12 +17,24 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <algorithm>
 #include <limits>
+#include <cmath>
 #include "RenderTimeline.h"
+#include "AudioThreadAllocationGuard.h"
+#include "NullAudioDevice.h"
 
 namespace
 {
-    constexpr std::size_t kMaxTaggedMidiEvents = 50000;
     constexpr juce::uint32 kMidiOverflowLogIntervalMs = 2000;
+    constexpr int kBulkIngestTimeoutMs = 1000;
+    constexpr int kSlotMidiBufferBytes = 16384;
+    constexpr float kIdleSilenceThreshold = 3.1623e-5f; // -90 dBFS
+    constexpr double kIdleSilenceHoldSeconds = 1.0;
+    constexpr double kHotSwapPreRollSeconds = 0.1;
+    constexpr double kHotSwapCrossfadeSeconds = 0.02;
+    constexpr int kHotSwapFinishDelayMs = 100;
+    constexpr int kHotSwapFinishAttempts = 20;
+    constexpr double kRemoteDeadlineShare = 0.8; // of a block's period; the rest is left for buses and mixing
+    constexpr int kInternalBlockIdleWaitMs = 20;
 
     std::vector<juce::String> sanitiseTags(const std::vector<juce::String> &tags)
     {
@@ -123,6 +135,60 @@ namespace
     }
 }
 
+// Renders internal blocks ahead of the device, so the callback only copies them out. Sleeps
+// between blocks; the callback wakes it each time it hands a buffer back.
+class PluginManager::InternalBlockThread : public juce::Thread
+{
+public:
+    explicit InternalBlockThread(PluginManager &ownerRef)
+        : juce::Thread("Internal block renderer"),
+          owner(ownerRef)
+    {
+    }
+
+    ~InternalBlockThread() override
+    {
+        shutdown();
+    }
+
+    // Audio thread, after raising requestedInternalBlocks
+    void wake()
+    {
+        if (sleeping.exchange(false))
+            wakeEvent.signal();
+    }
+
+    void shutdown()
+    {
+        signalThreadShouldExit();
+        wakeEvent.signal();
+        stopThread(2000);
+    }
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            const auto next = owner.renderedInternalBlocks.load(std::memory_order_relaxed);
+            if (next < owner.requestedInternalBlocks.load())
+            {
+                owner.renderInternalBlock(next);
+                continue;
+            }
+
+            sleeping.store(true);
+            if (owner.requestedInternalBlocks.load() == next && !threadShouldExit())
+                wakeEvent.wait(kInternalBlockIdleWaitMs);
+            sleeping.store(false);
+        }
+    }
+
+private:
+    PluginManager &owner;
+    juce::WaitableEvent wakeEvent;
+    std::atomic<bool> sleeping{ false };
+};
+
 HostPlayHead hostPlayHead;
 bool PluginManager::playStartIssued = false;
 bool PluginManager::midiStartSent = false;
@@ -158,21 +224,55 @@ void printParameterNames(const juce::AudioPluginInstance *pluginInstance)
     }
 }
 
-PluginManager::PluginManager(MainComponent *mainComponent, juce::CriticalSection &criticalSection, juce::MidiBuffer &midiBuffer)
-    : mainComponent(mainComponent), midiCriticalSection(criticalSection), incomingMidi(midiBuffer)
+PluginManager::PluginManager(MainComponent *mainComponent, juce::CriticalSection &criticalSection)
+    : mainComponent(mainComponent), midiCriticalSection(criticalSection)
 {
+    for (int channel = 1; channel <= 16; ++channel)
+    {
+        allNotesOffMessages.addEvent(juce::MidiMessage::allNotesOff(channel), 0);
+        allNotesOffMessages.addEvent(juce::MidiMessage::allSoundOff(channel), 0);
+    }
+
+    {
+        // Publishes the first graph, holding just the Master bus
+        const juce::ScopedLock pluginLock(pluginInstanceLock);
+        rebuildBusGraph();
+    }
+    setTempoMap(TempoMap::constant(kDefaultBpm));
+
     formatManager.addFormat(new juce::VST3PluginFormat()); // Adds only VST3 format to the format manager
+    pluginLoader = std::make_unique<PluginLoader>(formatManager,
+                                                  [this](const juce::String &pluginId, std::unique_ptr<juce::AudioPluginInstance> &instance)
+                                                  { return admitPluginInstance(pluginId, instance); });
+    // Machines without a sound card still get a device to run on. The platform's own types are
+    // created first so that one of them stays the default when it has devices.
+    deviceManager.getAvailableDeviceTypes();
+    deviceManager.addAudioDeviceType(std::make_unique<NullAudioIODeviceType>());
     // Remove: deviceManager.initialise(4, 32, nullptr, true); // Remove this duplicate initialization
     setAudioChannels(4, 32); // Keep only this - it properly initializes the inherited AudioDeviceManager
 }
 
 PluginManager::~PluginManager()
 {
+    // Stop loads first: they publish into the graph from the loader's threads
+    pluginLoader.reset();
     shutdownAudio();
+
+    // The callback has stopped, so everything retired can go now, on this (message) thread
+    pluginGraphDomain.reclaimAll();
+    fadingInstances.clear();
 }
 
 void PluginManager::prepareToPlay(int samplesPerBlockExpected, double sampleRate)
 {
+    stopInternalBlockThread();
+
+    // Everything past the device callback runs at the internal block size, when one is set
+    deviceBlockSize = samplesPerBlockExpected;
+    internalBlockSizeInUse = internalBlockSize.load();
+    if (internalBlockSizeInUse > 0)
+        samplesPerBlockExpected = internalBlockSizeInUse;
+
     currentSampleRate = sampleRate;
     currentBlockSize = samplesPerBlockExpected;
     liveSampleRateBackup = sampleRate;
@@ -186,10 +286,14 @@ void PluginManager::prepareToPlay(int samplesPerBlockExpected, double sampleRate
             outputChannels = activeOutputs;
     }
 
-    rmsDebugIntervalSamples = static_cast<juce::int64>(sampleRate);
-    rmsDebugSamplesAccumulated = 0;
-
+    liveOutputChannels = outputChannels;
     audioRouter.prepare(sampleRate, samplesPerBlockExpected, outputChannels);
+    workerPool.start(sampleRate, samplesPerBlockExpected);
+
+    // The callback is stopped here, so the wheel can be resized and re-keyed to the new rate
+    midiScheduler.reserve(midiSchedulerBudgetBytes.load());
+    midiScheduler.rekey([this](const MidiEventScheduler::Event &event)
+                        { return samplePositionForTimestamp(event.timestamp); });
 
     const juce::ScopedLock pluginLock(pluginInstanceLock);
     for (auto &[pluginId, pluginInstance] : pluginInstances)
@@ -199,297 +303,1414 @@ void PluginManager::prepareToPlay(int samplesPerBlockExpected, double sampleRate
             pluginInstance->prepareToPlay(sampleRate, samplesPerBlockExpected);
         }
     }
+    prepareScratchBuffers(samplesPerBlockExpected);
+    startInternalBlockThread();
 }
 
 void PluginManager::getNextAudioBlock(const juce::AudioSourceChannelInfo &bufferToFill)
 {
+    // Debug builds count any allocation made on this thread until the callback returns
+    const AudioThreadAllocationGuard::ScopedRealtimeSection realtimeSection;
+    const auto callbackStartTicks = juce::Time::getHighResolutionTicks();
+
+    // Pin the current plugin graph. Structural changes publish a new one rather than
+    // locking this callback out; beginExclusiveRender waits for this scope to end.
+    const RcuDomain::ReadScope graphReadScope(pluginGraphDomain);
+
+    // clear the output buffer
+    bufferToFill.clearActiveBufferRegion();
+
     if (renderInProgress.load())
     {
-        bufferToFill.clearActiveBufferRegion();
+        // What is left of the playing internal block, and the one rendered after it, predate the render
+        internalOutputPosition = internalBlockSizeInUse;
+        firstFreshInternalBlock = playingInternalBlock + 2;
         return;
     }
 
-    // 1) Update the shared play-head before any plugin processes
-
-    auto &pos = hostPlayHead.positionInfo;
-
-    pos = {}; // clear all flags
+    // If the device is missing, skip processing
+    if (deviceManager.getCurrentAudioDevice() == nullptr)
+        return;
 
-    // Validate BPM before setting
-    if (currentBpm > 0.0)
+    auto &graph = *pluginGraph.get();
+    if (internalBlockSizeInUse <= 0)
     {
-        pos.setBpm(currentBpm);
+        for (int done = 0; done < bufferToFill.numSamples;)
+            done += processEngineBlock(graph, *bufferToFill.buffer, bufferToFill.startSample + done,
+                                       bufferToFill.numSamples - done, done);
     }
     else
     {
-        pos.setBpm(120.0); // Default fallback BPM
-    }
+        // Hand the device the blocks the renderer has finished ahead of it. Each used-up block's
+        // buffer goes back for the block after next, so the engine stays one internal block ahead
+        // of the device. A block that is not ready in time plays as silence rather than stalling
+        // the callback, and the one after it still starts on time.
+        for (int done = 0; done < bufferToFill.numSamples;)
+        {
+            if (internalOutputPosition >= internalBlockSizeInUse)
+            {
+                ++playingInternalBlock;
+                internalOutputPosition = 0;
+                requestedInternalBlocks.store(playingInternalBlock + 2);
+                if (internalBlockThread != nullptr)
+                    internalBlockThread->wake();
+            }
 
-    pos.setTimeSignature(juce::AudioPlayHead::TimeSignature{4, 4});
+            const int numToCopy = juce::jmin(bufferToFill.numSamples - done, internalBlockSizeInUse - internalOutputPosition);
+            if (playingInternalBlock >= firstFreshInternalBlock
+                && renderedInternalBlocks.load(std::memory_order_acquire) > playingInternalBlock)
+            {
+                const auto &internalOutput = internalOutputs[(size_t)(playingInternalBlock & 1)];
+                for (int ch = 0; ch < bufferToFill.buffer->getNumChannels(); ++ch)
+                {
+                    bufferToFill.buffer->copyFrom(ch,
+                                                  bufferToFill.startSample + done,
+                                                  internalOutput,
+                                                  juce::jmin(ch, internalOutput.getNumChannels() - 1),
+                                                  internalOutputPosition,
+                                                  numToCopy);
+                }
+            }
+            internalOutputPosition += numToCopy;
+            done += numToCopy;
+        }
+    }
 
-    // Validate sample position
-    if (playbackSamplePosition >= 0 && currentSampleRate > 0.0)
+    // TAP audio for UDP streaming
+    // Tap the final mixed audio buffer once per callback
+    if (audioTapCallback != nullptr)
     {
-        pos.setTimeInSamples(playbackSamplePosition);
-        pos.setTimeInSeconds(playbackSamplePosition / currentSampleRate);
-        pos.setPpqPosition(playbackSamplePosition * (currentBpm / 60.0) / currentSampleRate);
+        try
+        {
+            audioTapCallback(*bufferToFill.buffer);
+        }
+        catch (const std::exception &e)
+        {
+            const AudioThreadAllocationGuard::ScopedAllowAllocation logging;
+            DBG("Exception in audio tap callback: " << e.what());
+        }
+        catch (...)
+        {
+            const AudioThreadAllocationGuard::ScopedAllowAllocation logging;
+            DBG("Unknown exception in audio tap callback");
+        }
     }
-    else
+
+    // A callback at or over 100% of the buffer period is an overrun, whether or not the driver caught it.
+    // With an internal block size the renderer measures the engine against its own block period.
+    const double budgetTicks = internalBlockSizeInUse <= 0 ? DspLoadHistogram::budgetTicksFor(bufferToFill.numSamples, currentSampleRate)
+                                                           : 0.0;
+    if (budgetTicks > 0.0)
     {
-        pos.setTimeInSamples(0);
-        pos.setTimeInSeconds(0.0);
-        pos.setPpqPosition(0.0);
+        const double loadPercent = 100.0 * (double)(juce::Time::getHighResolutionTicks() - callbackStartTicks) / budgetTicks;
+        callbackLoad.record(loadPercent);
+        applyCpuWatchdog(graph, loadPercent, 1000.0 * bufferToFill.numSamples / currentSampleRate);
     }
 
-    pos.setIsPlaying(true);
-
-    // clear the output buffer
-    bufferToFill.clearActiveBufferRegion();
+    reportAudioThreadAllocations();
+}
 
-    const juce::ScopedLock sl(midiCriticalSection);
-    const juce::ScopedLock pluginLock(pluginInstanceLock);
+void PluginManager::renderInternalBlock(juce::int64 blockIndex)
+{
+    // Debug builds count any allocation made on this thread until the block is done
+    const AudioThreadAllocationGuard::ScopedRealtimeSection realtimeSection;
+    const auto blockStartTicks = juce::Time::getHighResolutionTicks();
 
-    // Guard against missing audio device
-    if (auto *audioDevice = deviceManager.getCurrentAudioDevice(); audioDevice != nullptr)
+    auto &output = internalOutputs[(size_t)(blockIndex & 1)];
+    output.clear();
     {
-        double sampleRate = audioDevice->getCurrentSampleRate();
-
-        audioRouter.beginBlock(bufferToFill.numSamples);
-
-        // Purge MIDI messages for non-existent plugins
-        taggedMidiBuffer.erase(
-            std::remove_if(taggedMidiBuffer.begin(), taggedMidiBuffer.end(),
-                           [this](const MyMidiMessage &m)
-                           {
-                               return pluginInstances.find(m.pluginId) == pluginInstances.end();
-                           }),
-            taggedMidiBuffer.end());
-
-        const bool isStartingPlayback = (playbackSamplePosition == 0);
-        const int graceWindow = bufferToFill.numSamples;
-        std::unordered_map<juce::String, juce::MidiBuffer> scheduledPluginMessages;
-
-        if (!taggedMidiBuffer.empty())
+        // Pinned like the callback's, so beginExclusiveRender waits for this block too
+        const RcuDomain::ReadScope graphReadScope(pluginGraphDomain);
+        if (!renderInProgress.load())
         {
-            while (!taggedMidiBuffer.empty())
+            // The block starts playing once the device has used up the one before it
+            auto &graph = *pluginGraph.get();
+            for (int processed = 0; processed < internalBlockSizeInUse;)
+                processed += processEngineBlock(graph, output, processed, internalBlockSizeInUse - processed,
+                                                internalBlockSizeInUse + processed);
+
+            // The engine has a whole internal block period per block, however the device slices it up
+            const double budgetTicks = DspLoadHistogram::budgetTicksFor(internalBlockSizeInUse, currentSampleRate);
+            if (budgetTicks > 0.0)
             {
-                auto &taggedMessage = taggedMidiBuffer.front();
-
-                if (pluginInstances.find(taggedMessage.pluginId) == pluginInstances.end())
-                {
-                    taggedMidiBuffer.pop_front();
-                    continue;
-                }
-
-                bool consumeMessage = false;
-
-                if (sampleRate <= 0.0 || taggedMessage.timestamp == 0)
-                {
-                    scheduledPluginMessages[taggedMessage.pluginId].addEvent(taggedMessage.message, 0);
-                    consumeMessage = true;
-                }
-                else
-                {
-                    auto absPos = static_cast<juce::int64>((taggedMessage.timestamp / 1000.0) * sampleRate);
-                    auto offset64 = absPos - playbackSamplePosition;
-                    const int offset = static_cast<int>(offset64);
-
-                    const bool fitsCurrentBlock = (offset >= 0 && offset < bufferToFill.numSamples);
-                    const bool fitsGraceWindow = isStartingPlayback && offset >= -graceWindow && offset < bufferToFill.numSamples;
-
-                    if (fitsCurrentBlock || fitsGraceWindow)
-                    {
-                        scheduledPluginMessages[taggedMessage.pluginId].addEvent(
-                            taggedMessage.message,
-                            juce::jlimit(0, bufferToFill.numSamples - 1, offset));
-                        // DBG("Scheduling preview event plugin=" << taggedMessage.pluginId
-                        //     << " offset=" << offset
-                        //     << " blockSamples=" << bufferToFill.numSamples
-                        //     << " playbackPos=" << playbackSamplePosition
-                        //     << " msg=" << taggedMessage.message.getDescription());
-                        consumeMessage = true;
-                    }
-                    else if (offset < 0)
-                    {
-                        // Message arrived late, but still deliver it immediately instead of dropping
-                        scheduledPluginMessages[taggedMessage.pluginId].addEvent(
-                            taggedMessage.message,
-                            0);
-                        DBG("Scheduling late preview event plugin=" << taggedMessage.pluginId
-                                                                    << " offset=" << offset
-                                                                    << " msg=" << taggedMessage.message.getDescription());
-                        consumeMessage = true;
-                    }
-                    else if (offset >= bufferToFill.numSamples)
-                    {
-                        // Queue is sorted by timestamp, so everything beyond this is for a future block
-                        break;
-                    }
-                }
-
-                if (consumeMessage)
-                    taggedMidiBuffer.pop_front();
-                else
-                    break;
+                const double loadPercent = 100.0 * (double)(juce::Time::getHighResolutionTicks() - blockStartTicks) / budgetTicks;
+                callbackLoad.record(loadPercent);
+                applyCpuWatchdog(graph, loadPercent, 1000.0 * internalBlockSizeInUse / currentSampleRate);
             }
         }
+    }
 
-        // 2) Process each plugin once, in a single loop
-        for (auto &[pluginId, pluginInstance] : pluginInstances)
-        {
-            if (!pluginInstance)
-                continue;
+    renderedInternalBlocks.store(blockIndex + 1, std::memory_order_release);
+}
 
-            // Validate plugin instance before processing
-            try
-            {
-                // Check if plugin is properly initialized
-                if (pluginInstance->getTotalNumOutputChannels() <= 0)
-                {
-                    DBG("Warning: Plugin " << pluginId << " has no output channels, skipping");
-                    continue;
-                }
+void PluginManager::startInternalBlockThread()
+{
+    stopInternalBlockThread();
+    if (internalBlockSizeInUse <= 0)
+        return;
 
-                // d) prepare a per-plugin tempBuffer with correct channel count
-                int numOut = pluginInstance->getTotalNumOutputChannels();
-                juce::AudioBuffer<float> tempBuffer(numOut, bufferToFill.numSamples);
-                tempBuffer.clear();
+    // Blocks 0 and 1 are rendered straight away, ready for the first callbacks
+    for (auto &buffer : internalOutputs)
+    {
+        buffer.setSize(liveOutputChannels, internalBlockSizeInUse);
+        buffer.clear();
+    }
+    playingInternalBlock = 0;
+    firstFreshInternalBlock = 0;
+    internalOutputPosition = 0;
+    renderedInternalBlocks.store(0);
+    requestedInternalBlocks.store(2);
 
-                // e) gather tagged MIDI for this plugin
-                juce::MidiBuffer matchingMessages;
-                if (auto scheduled = scheduledPluginMessages.find(pluginId);
-                    scheduled != scheduledPluginMessages.end())
-                {
-                    matchingMessages = std::move(scheduled->second);
-                }
+    internalBlockThread = std::make_unique<InternalBlockThread>(*this);
+    const auto options = juce::Thread::RealtimeOptions{}.withPriority(10).withApproximateAudioProcessingTime(internalBlockSizeInUse,
+                                                                                                            currentSampleRate);
+    if (!internalBlockThread->startRealtimeThread(options))
+    {
+        DBG("Internal block renderer: realtime priority unavailable, starting at highest priority");
+        internalBlockThread->startThread(juce::Thread::Priority::highest);
+    }
+}
 
-                // merge in live incoming MIDI if this is the selected plugin
-                if (pluginId == mainComponent->getOrchestraTableModel().getSelectedPluginId())
-                    matchingMessages.addEvents(incomingMidi,
-                                               0,
-                                               bufferToFill.numSamples,
-                                               bufferToFill.startSample);
+void PluginManager::stopInternalBlockThread()
+{
+    // The renderer is the engine's only thread while it runs, so it stops before anything is re-prepared
+    if (internalBlockThread != nullptr)
+    {
+        internalBlockThread->shutdown();
+        internalBlockThread.reset();
+    }
+}
 
-                // f) run the plugin with error handling
-                try
-                {
-                    pluginInstance->processBlock(tempBuffer, matchingMessages);
-                }
-                catch (const std::exception &e)
-                {
-                    DBG("Exception processing plugin " << pluginId << ": " << e.what());
-                    tempBuffer.clear(); // Clear buffer to avoid audio artifacts
-                    continue;
-                }
-                catch (...)
-                {
-                    DBG("Unknown exception processing plugin " << pluginId);
-                    tempBuffer.clear(); // Clear buffer to avoid audio artifacts
-                    continue;
-                }
+int PluginManager::processEngineBlock(PluginGraph &graph, juce::AudioBuffer<float> &output, int startSample,
+                                      int numSamples, int deviceOffset)
+{
+    const auto blockStartTicks = juce::Time::getHighResolutionTicks();
+
+    // Apply clear/reset requests and pull in everything the producers queued since the last block
+    ingestPendingMidi(deviceOffset);
+
+    // 1) Publish this block's play-head before any plugin processes. A block stops short of the
+    //    next tempo change, so every plugin sees one tempo for the whole of what it processes.
+    const auto &tempo = *tempoMap.get();
+    const auto nextTempoChange = tempo.getNextChangeSample(playbackSamplePosition, currentSampleRate);
+    if (nextTempoChange > playbackSamplePosition)
+        numSamples = (int)juce::jmin<juce::int64>(numSamples, nextTempoChange - playbackSamplePosition);
+
+    auto position = tempo.getPositionAt(playbackSamplePosition, currentSampleRate);
+    position.setIsPlaying(true);
+    hostPlayHead.publish(position);
+
+    audioRouter.beginBlock(numSamples);
+
+    // Pull this block's events off the timing wheel into their slots; events whose
+    // plugin has since been removed fail the generation check and are dropped here
+    midiScheduler.collectDue(playbackSamplePosition,
+                             numSamples,
+                             [&graph](const MidiEventScheduler::Event &event, const juce::uint8 *data, int size, int offset)
+                             {
+                                 if (auto *slot = resolvePluginSlot(graph, event.target))
+                                     slot->midi.addEvent(data, size, offset);
+                             });
+
+    // 2) Collect one job per plugin. MIDI is gathered here on the callback thread so
+    //    the workers only ever touch the job they are handed. Jobs and slot buffers are
+    //    sized when plugins are prepared or added, so this only reallocates if the
+    //    device delivers a block larger than it announced.
+    const bool flushNotes = allNotesOffRequested.exchange(false);
+    int numJobs = 0;
+    for (auto *activeSlot : graph.active)
+    {
+        auto &slot = *activeSlot;
+
+        // Check if plugin is properly initialized
+        const int numOut = slot.instance->getTotalNumOutputChannels();
+        if (numOut <= 0)
+        {
+            const AudioThreadAllocationGuard::ScopedAllowAllocation logging;
+            DBG("Warning: Plugin " << slot.pluginId << " has no output channels, skipping");
+            slot.midi.clear();
+            continue;
+        }
 
-                audioRouter.routeAudio(pluginId, tempBuffer, bufferToFill.numSamples);
+        // Shed by the CPU watchdog: its MIDI is dropped until there is headroom again
+        if (slot.shed.load(std::memory_order_relaxed))
+        {
+            slot.midi.clear();
+            continue;
+        }
 
-                // g) mix plugin output back into the host buffer
-                for (int ch = 0; ch < bufferToFill.buffer->getNumChannels(); ++ch)
-                {
-                    int outCh = ch < tempBuffer.getNumChannels() ? ch : tempBuffer.getNumChannels() - 1;
-                    if (outCh >= 0 && outCh < tempBuffer.getNumChannels())
-                    {
-                        bufferToFill.buffer->addFrom(ch,
-                                                     bufferToFill.startSample,
-                                                     tempBuffer,
-                                                     outCh,
-                                                     0,
-                                                     bufferToFill.numSamples);
-                    }
-                }
-            }
-            catch (const std::exception &e)
-            {
-                DBG("Exception in plugin processing loop for " << pluginId << ": " << e.what());
-                continue;
-            }
-            catch (...)
+        // Idle sleep: the block that carries the next event wakes the plugin, and the event
+        // keeps its offset within that block, so the wake is sample accurate
+        if (slot.sleeping.load(std::memory_order_relaxed))
+        {
+            if (slot.midi.isEmpty() && idleSleepEnabled.load(std::memory_order_relaxed)
+                && !slot.keepAwake.load(std::memory_order_relaxed))
             {
-                DBG("Unknown exception in plugin processing loop for " << pluginId);
+                slot.blocksSlept.fetch_add(1, std::memory_order_relaxed);
                 continue;
             }
+
+            slot.sleeping.store(false, std::memory_order_relaxed);
+            slot.silentSamples = 0;
         }
+
+        auto &job = graph.jobs[(size_t)numJobs++];
+        job.slot = &slot;
+        job.instance = slot.instance;
+        job.outputPeak = 0.0f;
+        job.succeeded = false;
+        job.slot->audio.setSize(numOut, numSamples, false, false, true);
+        job.slot->audio.clear();
+        job.midi.clear();
+
+        // stopAllNotes() requests, and notes left hanging while the plugin was shed, are
+        // cleared ahead of anything scheduled in this block
+        if (flushNotes || slot.flushOnRestore)
+            job.midi.addEvents(allNotesOffMessages, 0, -1, 0);
+        slot.flushOnRestore = false;
+
+        // Swapping keeps both preallocated buffers alive; the slot's is refilled next block
+        if (job.midi.isEmpty())
+            job.midi.swapWith(slot.midi);
+        else
+            job.midi.addEvents(slot.midi, 0, -1, 0);
+        slot.midi.clear();
+        trackHeldNotes(slot, job.midi);
     }
-    else
+
+    // 3) Run the plugins across the worker pool. Plugins in worker processes are all handed
+    //    their block first, so they run side by side however many pool threads there are,
+    //    and are waited on only until the block's share of its period has gone.
+    const double budgetTicks = DspLoadHistogram::budgetTicksFor(numSamples, currentSampleRate);
+    const auto remoteDeadline = blockStartTicks + (juce::int64)(budgetTicks * kRemoteDeadlineShare);
+    for (auto *remoteSlot : graph.remote)
+        remoteSlot->remote->setDeadline(remoteDeadline);
+    for (int i = 0; i < numJobs; ++i)
     {
-        // If the device is missing, clear buffers and skip processing
-        bufferToFill.clearActiveBufferRegion();
-        incomingMidi.clear();
-        return;
+        auto &job = graph.jobs[(size_t)i];
+        if (job.slot->remote != nullptr)
+            job.slot->remote->sendBlock(job.slot->audio, job.midi);
     }
 
-    // TAP audio for UDP streaming
-    // Tap the final mixed audio buffer once per callback
-    if (audioTapCallback != nullptr)
+    auto processJob = [&graph, budgetTicks](int jobIndex)
     {
+        auto &job = graph.jobs[(size_t)jobIndex];
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        const int jobSamples = job.slot->audio.getNumSamples();
+        auto *outgoing = job.slot->outgoing.load(std::memory_order_acquire);
+        if (outgoing != nullptr)
+            captureOutgoingInput(*job.slot, *outgoing, nullptr, job.midi, jobSamples);
         try
         {
-            audioTapCallback(*bufferToFill.buffer);
+            // Third-party code: what the plugin allocates is its own business
+            const AudioThreadAllocationGuard::ScopedAllowAllocation pluginCode;
+            job.instance->processBlock(job.slot->audio, job.midi);
+            if (outgoing != nullptr)
+                mixOutgoing(*job.slot, *outgoing, job.slot->audio, jobSamples);
+            job.outputPeak = job.slot->audio.getMagnitude(0, jobSamples);
+            job.succeeded = true;
         }
         catch (const std::exception &e)
         {
-            DBG("Exception in audio tap callback: " << e.what());
+            const AudioThreadAllocationGuard::ScopedAllowAllocation logging;
+            DBG("Exception processing plugin " << job.slot->pluginId << ": " << e.what());
+            job.slot->audio.clear(); // Clear buffer to avoid audio artifacts
         }
         catch (...)
         {
-            DBG("Unknown exception in audio tap callback");
+            const AudioThreadAllocationGuard::ScopedAllowAllocation logging;
+            DBG("Unknown exception processing plugin " << job.slot->pluginId);
+            job.slot->audio.clear(); // Clear buffer to avoid audio artifacts
+        }
+        job.slot->dspLoad.recordTicks(juce::Time::getHighResolutionTicks() - startTicks, budgetTicks);
+    };
+    workerPool.run(numJobs, processJob);
+
+    // 4) Route back in instance order so the sums match the serial path bit for bit
+    for (int i = 0; i < numJobs; ++i)
+    {
+        const auto &job = graph.jobs[(size_t)i];
+        updateIdleState(*job.slot, job.succeeded ? job.outputPeak : 0.0f, numSamples);
+        if (!job.succeeded)
+            continue;
+
+        audioRouter.routeAudio(job.slot->slotIndex, job.slot->audio, numSamples);
+    }
+
+    // 5) Run the bus graph's inserts and returns, meter the buses, then play Master
+    processBusGraph(graph, numSamples, budgetTicks);
+    audioRouter.measureBuses(numSamples);
+    if (const auto *master = graph.buses.empty() ? nullptr : graph.buses.back().buffer)
+    {
+        for (int ch = 0; ch < output.getNumChannels(); ++ch)
+        {
+            const int masterCh = juce::jmin(ch, master->getNumChannels() - 1);
+            if (masterCh >= 0)
+            {
+                output.copyFrom(ch,
+                                startSample,
+                                *master,
+                                masterCh,
+                                0,
+                                numSamples);
+            }
         }
     }
 
-    // logBusRmsIfNeeded(bufferToFill.numSamples);
+    // advance the host clock
+    playbackSamplePosition += numSamples;
+    pendingMidiCount.store(midiScheduler.getNumPending(), std::memory_order_relaxed);
+    return numSamples;
+}
+
+void PluginManager::reportAudioThreadAllocations()
+{
+    // Always 0 in release builds
+    const auto allocations = AudioThreadAllocationGuard::getAllocationCount();
+    if (allocations == reportedAudioAllocations)
+        return;
 
-    // clear incoming MIDI and advance the host clock
-    incomingMidi.clear();
-    playbackSamplePosition += bufferToFill.numSamples;
+    static juce::uint32 lastAllocationLog = 0;
+    const auto now = juce::Time::getMillisecondCounter();
+    if (now - lastAllocationLog > kMidiOverflowLogIntervalMs)
+    {
+        const AudioThreadAllocationGuard::ScopedAllowAllocation logging;
+        DBG("Warning: audio callback made " << (allocations - reportedAudioAllocations)
+                                            << " heap allocation(s) outside plugin code");
+        reportedAudioAllocations = allocations;
+        lastAllocationLog = now;
+    }
 }
 
-void PluginManager::releaseResources()
+void PluginManager::ingestPendingMidi(int deviceOffset)
 {
-    const juce::ScopedLock pluginLock(pluginInstanceLock);
-    for (auto &[pluginId, pluginInstance] : pluginInstances)
+    const auto clearBefore = midiIngestQueue.getClearBeforeSequence();
+    if (clearBefore > appliedClearSequence)
     {
-        if (pluginInstance != nullptr)
+        midiScheduler.removeOlderThan(clearBefore);
+        appliedClearSequence = clearBefore;
+    }
+
+    const auto resetBefore = midiIngestQueue.getResetBeforeSequence();
+    if (resetBefore > appliedResetSequence)
+    {
+        // Sample zero is the moment of the reset request, so start this block however far past it
+        // it will be played: now, plus its offset into the device block when processing ahead
+        const double elapsedMs = juce::Time::getMillisecondCounterHiRes() - playbackAnchorHostMs.load(std::memory_order_acquire);
+        const auto elapsedSamples = static_cast<juce::int64>(std::llround(juce::jmax(0.0, elapsedMs) * currentSampleRate / 1000.0)) + deviceOffset;
+        playbackSamplePosition = juce::jmin(elapsedSamples, static_cast<juce::int64>(currentSampleRate));
+        midiScheduler.setPosition(playbackSamplePosition);
+        appliedResetSequence = resetBefore;
+    }
+
+    const auto droppedBefore = midiScheduler.getDroppedCount();
+    midiIngestQueue.drain(clearBefore, [this](const IngestedMidiEvent &ingested)
+                          {
+                              MidiEventScheduler::Event event;
+                              event.target = ingested.target;
+                              event.timestamp = ingested.timestamp;
+                              event.sequence = ingested.sequence;
+                              event.immediate = ingested.timestamp == 0 || currentSampleRate <= 0.0;
+                              event.samplePosition = samplePositionForTimestamp(ingested.timestamp);
+                              midiScheduler.insert(event, ingested.getData(), ingested.size); });
+
+    if (midiScheduler.getDroppedCount() != droppedBefore)
+    {
+        static juce::uint32 lastOverflowLog = 0;
+        const auto now = juce::Time::getMillisecondCounter();
+        if (now - lastOverflowLog > kMidiOverflowLogIntervalMs)
         {
-            pluginInstance->releaseResources();
+            const AudioThreadAllocationGuard::ScopedAllowAllocation logging;
+            DBG("Warning: MIDI scheduler memory budget exhausted with " << midiScheduler.getNumPending()
+                                                                        << " pending events; dropping new events.");
+            lastOverflowLog = now;
         }
     }
 }
 
-void PluginManager::setBpm(double bpm)
+juce::int64 PluginManager::samplePositionForTimestamp(juce::int64 timestampUs) const
 {
-    currentBpm = bpm;
+    // Rounded, not truncated, so a timestamp lands on its nearest sample
+    return static_cast<juce::int64>(std::llround(static_cast<double>(timestampUs) * currentSampleRate / 1.0e6));
 }
 
-juce::PluginDescription PluginManager::getDescFromName(const juce::String &name)
+std::unique_ptr<PluginManager::PluginSlot> PluginManager::makePluginSlot(const juce::String &pluginId,
+                                                                       juce::AudioPluginInstance *instance,
+                                                                       int slotIndex,
+                                                                       juce::uint32 generation) const
 {
-    const auto types = knownPluginList.getTypes();
-    for (const auto &desc : types)
+    auto slot = std::make_unique<PluginSlot>();
+    slot->instance = instance;
+    slot->remote = RemotePlugin::of(instance);
+    slot->pluginId = pluginId;
+    slot->generation = generation;
+    slot->slotIndex = slotIndex;
+    slot->tailSeconds = instance->getTailLengthSeconds();
+    if (auto priority = pluginPriorities.find(pluginId); priority != pluginPriorities.end())
+        slot->priority.store(priority->second);
+    slot->midi.ensureSize(kSlotMidiBufferBytes);
+    if (currentBlockSize > 0)
+        slot->audio.setSize(juce::jmax(1, instance->getTotalNumInputChannels(), instance->getTotalNumOutputChannels()),
+                            currentBlockSize);
+    return slot;
+}
+
+PluginHandle PluginManager::assignPluginSlot(const juce::String &pluginId, juce::AudioPluginInstance *instance)
+{
+    // Caller holds pluginInstanceLock and publishes the graph afterwards
+    const juce::ScopedLock handleLock(pluginHandleLock);
+    if (auto it = pluginHandles.find(pluginId); it != pluginHandles.end())
+    {
+        // Re-instantiating an id keeps its handle so queued events still reach it
+        const int index = PluginHandles::slotIndexOf(it->second);
+        retiringSlots.push_back(std::move(slotObjects[(size_t)index]));
+        slotObjects[(size_t)index] = makePluginSlot(pluginId, instance, index, slotGenerations[(size_t)index]);
+        return it->second;
+    }
+
+    int index;
+    if (!freePluginSlots.empty())
     {
-        if (desc.name == name)
-            return desc;
+        index = freePluginSlots.back();
+        freePluginSlots.pop_back();
     }
-    return juce::PluginDescription();
+    else
+    {
+        if ((int)slotObjects.size() >= PluginHandles::kMaxSlots)
+        {
+            DBG("Error: plugin slot table full, cannot register " << pluginId);
+            return kInvalidPluginHandle;
+        }
+        index = (int)slotObjects.size();
+        slotObjects.emplace_back();
+        slotGenerations.push_back(1u);
+    }
+
+    slotObjects[(size_t)index] = makePluginSlot(pluginId, instance, index, slotGenerations[(size_t)index]);
+
+    const auto handle = PluginHandles::make(index, slotGenerations[(size_t)index]);
+    pluginHandles[pluginId] = handle;
+    notifyPluginHandlesChanged();
+    return handle;
 }
 
-void PluginManager::instantiatePluginByName(const juce::String &name, const juce::String &pluginId)
+void PluginManager::releasePluginSlot(const juce::String &pluginId)
 {
-    juce::PluginDescription desc = getDescFromName(name);
-    if (desc.name.isNotEmpty())
+    // Caller holds pluginInstanceLock and publishes the graph afterwards
+    const juce::ScopedLock handleLock(pluginHandleLock);
+    auto it = pluginHandles.find(pluginId);
+    if (it == pluginHandles.end())
+        return;
+
+    const int index = PluginHandles::slotIndexOf(it->second);
+    retiringSlots.push_back(std::move(slotObjects[(size_t)index]));
+
+    // Bumping the generation invalidates every handle already handed out for this slot
+    auto &generation = slotGenerations[(size_t)index];
+    generation = generation >= PluginHandles::kMaxGeneration ? 1u : generation + 1u;
+
+    freePluginSlots.push_back(index);
+    pluginHandles.erase(it);
+    notifyPluginHandlesChanged();
+}
+
+void PluginManager::setPluginHandlesChangedCallback(std::function<void()> callback)
+{
+    const juce::ScopedLock handleLock(pluginHandleLock);
+    pluginHandlesChangedCallback = std::move(callback);
+}
+
+void PluginManager::notifyPluginHandlesChanged()
+{
+    // Caller holds pluginHandleLock
+    if (pluginHandlesChangedCallback)
+        pluginHandlesChangedCallback();
+}
+
+void PluginManager::retirePluginInstance(std::unique_ptr<juce::AudioPluginInstance> instance)
+{
+    // Caller holds pluginInstanceLock; destroyed once the audio thread can no longer see it
+    if (instance != nullptr)
+        retiringInstances.push_back(std::move(instance));
+}
+
+void PluginManager::publishPluginGraph()
+{
+    // Caller holds pluginInstanceLock, which serialises writers
+    auto next = std::make_unique<PluginGraph>();
+
+    // Plugins used as inserts run inside their bus rather than as instruments
+    std::unordered_set<PluginSlot *> insertSlots;
+    for (const auto &compiled : compiledBuses)
+    {
+        PluginGraph::BusNode node;
+        node.name = compiled.name;
+        node.output = compiled.output;
+        node.busIndex = audioRouter.getBusIndex(compiled.name);
+        node.outputIndex = audioRouter.getBusIndex(compiled.output);
+        for (const auto &insertId : compiled.inserts)
+        {
+            // Not loaded yet, or already inserted on another bus
+            auto *slot = findPluginSlotUnlocked(insertId);
+            if (slot != nullptr && insertSlots.insert(slot).second)
+                node.inserts.push_back(slot);
+        }
+        next->buses.push_back(std::move(node));
+    }
+    next->busLevelStarts = BusGraph::levelStarts(compiledBuses);
+
+    next->slotsByIndex.resize(slotObjects.size(), nullptr);
+    std::vector<juce::String> pluginIdsBySlot(slotObjects.size());
+    for (size_t i = 0; i < slotObjects.size(); ++i)
     {
-        const juce::ScopedLock pluginLock(pluginInstanceLock);
-        instantiatePlugin(&desc, pluginId);
+        if (auto *slot = slotObjects[i].get())
+        {
+            next->slotsByIndex[i] = slot;
+            pluginIdsBySlot[i] = slot->pluginId;
+            if (insertSlots.count(slot) == 0)
+                next->active.push_back(slot);
+            if (slot->remote != nullptr)
+                next->remote.push_back(slot);
+        }
+    }
+
+    next->jobs.resize(next->active.size());
+
+    next->shedOrder = next->active;
+    std::stable_sort(next->shedOrder.begin(), next->shedOrder.end(),
+                     [](const PluginSlot *a, const PluginSlot *b)
+                     {
+                         return a->priority.load() < b->priority.load();
+                     });
+    for (auto &job : next->jobs)
+        job.midi.ensureSize(kSlotMidiBufferBytes);
+
+    using RetiredSlots = std::vector<std::unique_ptr<PluginSlot>>;
+    using RetiredInstances = std::vector<std::unique_ptr<juce::AudioPluginInstance>>;
+    auto slots = std::make_shared<RetiredSlots>(std::move(retiringSlots));
+    auto instances = std::make_shared<RetiredInstances>(std::move(retiringInstances));
+    retiringSlots.clear();
+    retiringInstances.clear();
+
+    // Routes first, so no published slot is without one
+    audioRouter.setPluginSlots(pluginIdsBySlot);
+    pluginGraph.publish(std::move(next), [slots, instances]
+                        {
+                            slots->clear();
+                            if (instances->empty())
+                                return;
+
+                            // Plugin instances are torn down on the message thread, as VST3 expects
+                            auto destroyInstances = [instances]
+                            {
+                                for (auto &instance : *instances)
+                                    instance->releaseResources();
+                                instances->clear();
+                            };
+
+                            if (juce::MessageManager::existsAndIsCurrentThread())
+                                destroyInstances();
+                            else
+                                juce::MessageManager::callAsync(destroyInstances);
+                        });
+}
+
+PluginManager::PluginSlot *PluginManager::resolvePluginSlot(const PluginGraph &graph, PluginHandle handle)
+{
+    const int index = PluginHandles::slotIndexOf(handle);
+    if (handle == kInvalidPluginHandle || index >= (int)graph.slotsByIndex.size())
+        return nullptr;
+
+    auto *slot = graph.slotsByIndex[(size_t)index];
+    if (slot == nullptr || slot->generation != PluginHandles::generationOf(handle))
+        return nullptr;
+
+    return slot;
+}
+
+void PluginManager::prepareScratchBuffers(int blockSize)
+{
+    // Caller holds pluginInstanceLock and the audio callback is stopped or locked out by a
+    // render, so the published graph's scratch can be resized in place
+    for (auto &slot : slotObjects)
+    {
+        if (slot == nullptr)
+            continue;
+
+        // Inputs count too: a plugin used as an insert processes its bus in this buffer
+        slot->audio.setSize(juce::jmax(1, slot->instance->getTotalNumInputChannels(), slot->instance->getTotalNumOutputChannels()),
+                            blockSize, false, true, false);
+        slot->midi.ensureSize(kSlotMidiBufferBytes);
+    }
+}
+
+PluginManager::PluginSlot *PluginManager::findPluginSlotUnlocked(const juce::String &pluginId) const
+{
+    // Caller holds pluginInstanceLock, which keeps slotObjects stable
+    const auto handle = getPluginHandle(pluginId);
+    if (handle == kInvalidPluginHandle)
+        return nullptr;
+
+    return slotObjects[(size_t)PluginHandles::slotIndexOf(handle)].get();
+}
+
+void PluginManager::trackHeldNotes(PluginSlot &slot, const juce::MidiBuffer &midi)
+{
+    // Audio thread. Reads raw bytes so nothing is copied; voices only start and stop on
+    // three-byte channel messages.
+    if (midi.isEmpty())
+        return;
+
+    slot.samplesSinceEvent = 0;
+    for (const auto metadata : midi)
+    {
+        if (metadata.numBytes < 3)
+            continue;
+
+        const auto *data = metadata.data;
+        const int status = data[0] & 0xf0;
+        const auto channelBit = static_cast<juce::uint16>(1u << (data[0] & 0x0f));
+
+        if (status == 0x90 && data[2] > 0)
+        {
+            ++slot.heldNotes;
+        }
+        else if (status == 0x80 || status == 0x90)
+        {
+            slot.heldNotes = juce::jmax(0, slot.heldNotes - 1);
+        }
+        else if (status == 0xb0 && data[1] == 64)
+        {
+            if (data[2] >= 64)
+                slot.sustainedChannels |= channelBit;
+            else
+                slot.sustainedChannels &= static_cast<juce::uint16>(~channelBit);
+        }
+        else if (status == 0xb0 && (data[1] == 120 || data[1] == 123))
+        {
+            slot.heldNotes = 0;
+            slot.sustainedChannels = 0;
+        }
+    }
+}
+
+void PluginManager::updateIdleState(PluginSlot &slot, float outputPeak, int numSamples)
+{
+    // Audio thread, after the slot processed a block
+    slot.blocksProcessed.fetch_add(1, std::memory_order_relaxed);
+    slot.samplesSinceEvent += numSamples;
+    slot.silentSamples = outputPeak < kIdleSilenceThreshold ? slot.silentSamples + numSamples : 0;
+
+    if (!idleSleepEnabled.load(std::memory_order_relaxed) || slot.keepAwake.load(std::memory_order_relaxed))
+        return;
+    if (slot.heldNotes > 0 || slot.sustainedChannels != 0 || std::isinf(slot.tailSeconds))
+        return;
+
+    // Past the reported tail since the last event, and quiet long enough to cover releases
+    // that plugins leave out of their reported tail
+    const double tailSamples = slot.tailSeconds * currentSampleRate;
+    const auto holdSamples = static_cast<juce::int64>(kIdleSilenceHoldSeconds * currentSampleRate);
+    if (static_cast<double>(slot.samplesSinceEvent) >= tailSamples && slot.silentSamples >= holdSamples)
+        slot.sleeping.store(true, std::memory_order_relaxed);
+}
+
+void PluginManager::applyCpuWatchdog(const PluginGraph &graph, double loadPercent, double blockMs)
+{
+    // Audio thread, once the callback has been timed. One plugin per step: shed the lowest
+    // priority plugin that is actually running, or restore the highest priority one shed.
+    int numShed = 0;
+    for (const auto *slot : graph.shedOrder)
+        numShed += slot->shed.load(std::memory_order_relaxed) ? 1 : 0;
+
+    const auto action = cpuWatchdog.update(loadPercent, blockMs, numShed > 0);
+    if (action == CpuWatchdog::Action::Degrade)
+    {
+        for (auto *slot : graph.shedOrder)
+        {
+            const int priority = slot->priority.load(std::memory_order_relaxed);
+            if (priority >= CpuWatchdog::kProtectedPriority)
+                break;
+
+            // A sleeping plugin costs nothing, so shedding it would gain nothing
+            if (slot->shed.load(std::memory_order_relaxed) || slot->sleeping.load(std::memory_order_relaxed))
+                continue;
+
+            slot->shed.store(true, std::memory_order_relaxed);
+            cpuWatchdog.logStep(action, slot->pluginId, priority, loadPercent, numShed + 1);
+            break;
+        }
+    }
+    else if (action == CpuWatchdog::Action::Restore)
+    {
+        for (auto it = graph.shedOrder.rbegin(); it != graph.shedOrder.rend(); ++it)
+        {
+            auto *slot = *it;
+            if (!slot->shed.load(std::memory_order_relaxed))
+                continue;
+
+            slot->shed.store(false, std::memory_order_relaxed);
+            slot->flushOnRestore = true;
+            cpuWatchdog.logStep(action, slot->pluginId, slot->priority.load(std::memory_order_relaxed), loadPercent, numShed - 1);
+            break;
+        }
+    }
+}
+
+void PluginManager::rebuildBusGraph()
+{
+    // Caller holds pluginInstanceLock. Names take the case of the bus or stem they refer to,
+    // so the graph and the router agree on them.
+    auto definitions = busDefinitions;
+    for (auto &definition : definitions)
+    {
+        definition.name = audioRouter.resolveBusName(definition.name.trim());
+        definition.output = audioRouter.resolveBusName(definition.output.trim());
+    }
+    compiledBuses = BusGraph::compile(definitions);
+
+    std::vector<juce::String> graphBusNames;
+    for (const auto &node : compiledBuses)
+        graphBusNames.push_back(node.name);
+
+    std::unordered_map<juce::String, std::vector<AudioRouter::SendDefinition>> sends;
+    for (const auto &send : busSends)
+        sends[send.pluginId].push_back({audioRouter.resolveBusName(send.busName), send.level});
+
+    audioRouter.setBusGraph(graphBusNames, sends);
+    publishPluginGraph();
+}
+
+void PluginManager::processBusGraph(PluginGraph &graph, int numSamples, double budgetTicks)
+{
+    // Callback or render thread, once every plugin has been routed. Buses in one level never
+    // feed each other, so their insert chains share the worker pool; a level is summed into
+    // its outputs before the next one starts.
+    for (auto &node : graph.buses)
+        node.buffer = audioRouter.getBusForProcessing(node.busIndex);
+
+    int levelStart = 0;
+    auto processNode = [&graph, &levelStart, numSamples, budgetTicks](int nodeIndex)
+    {
+        processBusInserts(graph.buses[(size_t)(levelStart + nodeIndex)], numSamples, budgetTicks);
+    };
+
+    for (size_t level = 0; level + 1 < graph.busLevelStarts.size(); ++level)
+    {
+        levelStart = graph.busLevelStarts[level];
+        const int levelEnd = graph.busLevelStarts[level + 1];
+
+        const bool anyInserts = std::any_of(graph.buses.begin() + levelStart, graph.buses.begin() + levelEnd,
+                                            [](const PluginGraph::BusNode &node)
+                                            { return !node.inserts.empty(); });
+        if (anyInserts)
+        {
+            // Chains that start in a worker process hand it their block before any is waited on
+            for (int i = levelStart; i < levelEnd; ++i)
+            {
+                auto &node = graph.buses[(size_t)i];
+                auto *head = node.inserts.empty() ? nullptr : node.inserts.front();
+                if (head != nullptr && head->remote != nullptr && fillInsertInput(*head, node, numSamples))
+                    head->remote->sendBlock(head->audio, head->midi);
+            }
+            workerPool.run(levelEnd - levelStart, processNode);
+        }
+
+        for (int i = levelStart; i < levelEnd; ++i)
+        {
+            auto &node = graph.buses[(size_t)i];
+            if (node.buffer != nullptr && node.outputIndex >= 0)
+                audioRouter.sumBusInto(*node.buffer, node.outputIndex, numSamples);
+        }
+    }
+}
+
+void PluginManager::processBusInserts(PluginGraph::BusNode &node, int numSamples, double budgetTicks)
+{
+    // Worker or callback thread. An insert that throws is bypassed for the block.
+    for (auto *slot : node.inserts)
+    {
+        if (!fillInsertInput(*slot, node, numSamples))
+        {
+            slot->midi.clear();
+            continue;
+        }
+
+        const int numOut = slot->instance->getTotalNumOutputChannels();
+        auto &bus = *node.buffer;
+        auto &scratch = slot->audio;
+        auto *outgoing = slot->outgoing.load(std::memory_order_acquire);
+        if (outgoing != nullptr)
+            captureOutgoingInput(*slot, *outgoing, &scratch, slot->midi, numSamples);
+
+        bool succeeded = false;
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        try
+        {
+            // MIDI sent to an insert (automation, program changes) arrives in its slot as usual
+            const AudioThreadAllocationGuard::ScopedAllowAllocation pluginCode;
+            slot->instance->processBlock(scratch, slot->midi);
+            if (outgoing != nullptr)
+                mixOutgoing(*slot, *outgoing, scratch, numSamples);
+            succeeded = true;
+        }
+        catch (const std::exception &e)
+        {
+            const AudioThreadAllocationGuard::ScopedAllowAllocation logging;
+            DBG("Exception processing insert " << slot->pluginId << " on " << node.name << ": " << e.what());
+        }
+        catch (...)
+        {
+            const AudioThreadAllocationGuard::ScopedAllowAllocation logging;
+            DBG("Unknown exception processing insert " << slot->pluginId << " on " << node.name);
+        }
+        slot->midi.clear();
+        slot->dspLoad.recordTicks(juce::Time::getHighResolutionTicks() - startTicks, budgetTicks);
+        slot->blocksProcessed.fetch_add(1, std::memory_order_relaxed);
+
+        if (!succeeded)
+            continue;
+
+        for (int ch = 0; ch < bus.getNumChannels(); ++ch)
+        {
+            // A mono effect feeds both sides of a stereo bus, as AudioRouter does for plugins
+            if (ch < numOut)
+                bus.copyFrom(ch, 0, scratch, ch, 0, numSamples);
+            else if (numOut == 1 && ch == 1)
+                bus.copyFrom(ch, 0, scratch, 0, 0, numSamples);
+        }
+    }
+}
+
+bool PluginManager::fillInsertInput(PluginSlot &slot, const PluginGraph::BusNode &node, int numSamples)
+{
+    // Copies the bus into the insert's scratch; false if the insert has nothing to process
+    const int numIn = slot.instance->getTotalNumInputChannels();
+    const int numOut = slot.instance->getTotalNumOutputChannels();
+    if (node.buffer == nullptr || numOut <= 0)
+        return false;
+
+    const auto &bus = *node.buffer;
+    auto &scratch = slot.audio;
+    scratch.setSize(juce::jmax(numIn, numOut), numSamples, false, false, true);
+    for (int ch = 0; ch < scratch.getNumChannels(); ++ch)
+    {
+        if (ch < numIn && ch < bus.getNumChannels())
+            scratch.copyFrom(ch, 0, bus, ch, 0, numSamples);
+        else
+            scratch.clear(ch, 0, numSamples);
+    }
+    return true;
+}
+
+void PluginManager::captureOutgoingInput(PluginSlot &slot, juce::AudioPluginInstance &outgoing,
+                                         const juce::AudioBuffer<float> *input, const juce::MidiBuffer &midi, int numSamples)
+{
+    // Worker or callback thread, before the new instance runs: it may overwrite both. Both
+    // buffers were sized when the swap was published, so nothing allocates here.
+    const int numIn = outgoing.getTotalNumInputChannels();
+    auto &scratch = slot.outgoingAudio;
+    scratch.setSize(juce::jmax(1, numIn, outgoing.getTotalNumOutputChannels()), numSamples, false, false, true);
+    for (int ch = 0; ch < scratch.getNumChannels(); ++ch)
+    {
+        if (input != nullptr && ch < numIn && ch < input->getNumChannels())
+            scratch.copyFrom(ch, 0, *input, ch, 0, numSamples);
+        else
+            scratch.clear(ch, 0, numSamples);
+    }
+
+    slot.outgoingMidi.clear();
+    slot.outgoingMidi.addEvents(midi, 0, -1, 0);
+}
+
+void PluginManager::mixOutgoing(PluginSlot &slot, juce::AudioPluginInstance &outgoing,
+                                juce::AudioBuffer<float> &output, int numSamples)
+{
+    // Worker or callback thread, after the new instance has written output. The old instance
+    // gets the same input and MIDI, so held notes ring on under the fade.
+    try
+    {
+        const AudioThreadAllocationGuard::ScopedAllowAllocation pluginCode;
+        outgoing.processBlock(slot.outgoingAudio, slot.outgoingMidi);
+    }
+    catch (...)
+    {
+        // Fade the rest in from silence rather than cutting
+        const AudioThreadAllocationGuard::ScopedAllowAllocation logging;
+        DBG("Exception processing outgoing instance of " << slot.pluginId);
+        slot.outgoingAudio.clear();
+    }
+
+    const int length = juce::jmax(1, slot.crossfadeSamples);
+    const int fadeSamples = juce::jlimit(0, numSamples, length - slot.crossfadePosition);
+    const float startGain = (float)slot.crossfadePosition / (float)length;
+    const float endGain = (float)(slot.crossfadePosition + fadeSamples) / (float)length;
+    const int outgoingChannels = juce::jmin(outgoing.getTotalNumOutputChannels(), slot.outgoingAudio.getNumChannels());
+
+    for (int ch = 0; ch < output.getNumChannels(); ++ch)
+    {
+        output.applyGainRamp(ch, 0, fadeSamples, startGain, endGain);
+
+        // A mono instance feeds every channel of a wider one
+        if (outgoingChannels > 0)
+            output.addFromWithRamp(ch, 0, slot.outgoingAudio.getReadPointer(juce::jmin(ch, outgoingChannels - 1)),
+                                   fadeSamples, 1.0f - startGain, 1.0f - endGain);
+    }
+
+    slot.crossfadePosition += fadeSamples;
+    if (slot.crossfadePosition >= length)
+        slot.outgoing.store(nullptr, std::memory_order_release);
+}
+
+std::vector<BusDefinition> PluginManager::getBusDefinitions() const
+{
+    const juce::ScopedLock pluginLock(pluginInstanceLock);
+    return busDefinitions;
+}
+
+void PluginManager::setBusDefinitions(const std::vector<BusDefinition> &definitions)
+{
+    const juce::ScopedLock pluginLock(pluginInstanceLock);
+    busDefinitions = definitions;
+    rebuildBusGraph();
+}
+
+std::vector<PluginManager::BusSend> PluginManager::getBusSends() const
+{
+    const juce::ScopedLock pluginLock(pluginInstanceLock);
+    return busSends;
+}
+
+void PluginManager::setBusSend(const juce::String &pluginId, const juce::String &busName, float level)
+{
+    const juce::ScopedLock pluginLock(pluginInstanceLock);
+    busSends.erase(std::remove_if(busSends.begin(), busSends.end(),
+                                  [&](const BusSend &send)
+                                  {
+                                      return send.pluginId == pluginId && send.busName.equalsIgnoreCase(busName);
+                                  }),
+                   busSends.end());
+
+    if (level > 0.0f)
+        busSends.push_back({pluginId, busName.trim(), level});
+
+    rebuildBusGraph();
+}
+
+void PluginManager::setPluginPriority(const juce::String &pluginId, int priority)
+{
+    const int clamped = juce::jlimit(CpuWatchdog::kMinPriority, CpuWatchdog::kProtectedPriority, priority);
+
+    const juce::ScopedLock pluginLock(pluginInstanceLock);
+    if (auto existing = pluginPriorities.find(pluginId); existing != pluginPriorities.end() && existing->second == clamped)
+        return;
+
+    pluginPriorities[pluginId] = clamped;
+    if (auto *slot = findPluginSlotUnlocked(pluginId))
+    {
+        slot->priority.store(clamped);
+        publishPluginGraph(); // re-sorts the shed order
+    }
+}
+
+void PluginManager::setIdleSleepEnabled(bool shouldSleep)
+{
+    idleSleepEnabled.store(shouldSleep);
+    DBG("Idle plugin sleep " << (shouldSleep ? "enabled" : "disabled"));
+}
+
+void PluginManager::setPluginKeepAwake(const juce::String &pluginId, bool keepAwake)
+{
+    const juce::ScopedLock pluginLock(pluginInstanceLock);
+    if (auto *slot = findPluginSlotUnlocked(pluginId))
+        slot->keepAwake.store(keepAwake);
+}
+
+void PluginManager::attachWindowKeepAwake(const juce::String &pluginId)
+{
+    // Caller holds pluginInstanceLock
+    auto it = pluginWindows.find(pluginId);
+    if (it == pluginWindows.end())
+        return;
+
+    it->second->onVisibilityChanged = [this, pluginId](bool visible)
+    {
+        setPluginKeepAwake(pluginId, visible);
+    };
+    setPluginKeepAwake(pluginId, it->second->isVisible());
+}
+
+PluginHandle PluginManager::getPluginHandle(const juce::String &pluginId) const
+{
+    const juce::ScopedLock handleLock(pluginHandleLock);
+    auto it = pluginHandles.find(pluginId);
+    return it != pluginHandles.end() ? it->second : kInvalidPluginHandle;
+}
+
+void PluginManager::setMidiSchedulerMemoryBudget(std::size_t bytes)
+{
+    midiSchedulerBudgetBytes.store(juce::jmax<std::size_t>(1, bytes));
+}
+
+void PluginManager::releaseResources()
+{
+    stopInternalBlockThread();
+
+    const juce::ScopedLock pluginLock(pluginInstanceLock);
+    for (auto &[pluginId, pluginInstance] : pluginInstances)
+    {
+        if (pluginInstance != nullptr)
+        {
+            pluginInstance->releaseResources();
+        }
+    }
+}
+
+void PluginManager::setInternalBlockSize(int numSamples)
+{
+    const int blockSize = numSamples > 0 ? juce::jlimit(kMinInternalBlockSize, kMaxInternalBlockSize, numSamples) : 0;
+    if (internalBlockSize.exchange(blockSize) == blockSize)
+        return;
+
+    DBG("Internal block size " << (blockSize > 0 ? juce::String(blockSize) : juce::String("off")));
+
+    // Plugins, buses and the FIFO are sized in prepareToPlay, so reopen the device to get there.
+    // During a render the new size waits for the next time the device starts.
+    if (!renderInProgress.load() && deviceManager.getCurrentAudioDevice() != nullptr)
+    {
+        deviceManager.closeAudioDevice();
+        deviceManager.restartLastAudioDevice();
+    }
+}
+
+int PluginManager::getInternalBlockLatencySamples() const
+{
+    // The renderer finishes each block while the device is still playing the one before it
+    return juce::jmax(0, internalBlockSizeInUse);
+}
+
+void PluginManager::setBpm(double bpm)
+{
+    const auto &first = getTempoMap().getPoints().front();
+    setTempoMap(TempoMap::constant(bpm, first.numerator, first.denominator));
+}
+
+void PluginManager::setTempoMap(TempoMap map)
+{
+    // Writers are serialised by the lock; the audio thread reads inside its graph ReadScope
+    const juce::ScopedLock sl(tempoMapLock);
+    tempoMap.publish(std::make_unique<TempoMap>(std::move(map)));
+}
+
+TempoMap PluginManager::getTempoMap() const
+{
+    // Nothing is retired while the lock is held, so the current map can be copied outside a ReadScope
+    const juce::ScopedLock sl(tempoMapLock);
+    return *tempoMap.get();
+}
+
+juce::PluginDescription PluginManager::getDescFromName(const juce::String &name)
+{
+    const auto types = knownPluginList.getTypes();
+    for (const auto &desc : types)
+    {
+        if (desc.name == name)
+            return desc;
+    }
+    return juce::PluginDescription();
+}
+
+void PluginManager::instantiatePluginByName(const juce::String &name, const juce::String &pluginId)
+{
+    juce::PluginDescription desc = getDescFromName(name);
+    if (desc.name.isNotEmpty())
+    {
+        const juce::ScopedLock pluginLock(pluginInstanceLock);
+        instantiatePlugin(&desc, pluginId);
+    }
+    else
+    {
+        DBG("Plugin not found: " << name);
+    }
+}
+
+std::shared_future<PluginLoader::Result> PluginManager::instantiatePluginAsync(const juce::String &name,
+                                                                               const juce::String &pluginId,
+                                                                               PluginLoader::FinishedFunction onFinished)
+{
+    const auto desc = getDescFromName(name);
+    if (desc.name.isEmpty())
+    {
+        DBG("Plugin not found: " << name);
+        const PluginLoader::Result result{pluginId, false, "plugin not found: " + name};
+        if (onFinished)
+            juce::MessageManager::callAsync([onFinished, result]
+                                            { onFinished(result); });
+
+        std::promise<PluginLoader::Result> failed;
+        failed.set_value(result);
+        return failed.get_future().share();
+    }
+
+    const auto setup = deviceManager.getAudioDeviceSetup();
+    const double sampleRate = setup.sampleRate > 0.0 ? setup.sampleRate : currentSampleRate;
+    const int blockSize = setup.bufferSize > 0 ? setup.bufferSize : juce::jmax(1, currentBlockSize);
+
+    // A worker process builds the plugin on its own message thread. The request that waits for it
+    // runs on the loader's pool, so the message thread never waits and separate workers load at once.
+    if (const auto processGroup = getPluginProcessGroup(pluginId); processGroup.isNotEmpty())
+    {
+        return pluginLoader->loadWith(pluginId, sampleRate, blockSize,
+                                      [this, processGroup, desc, sampleRate, blockSize](juce::String &error)
+                                      { return remotePluginHost.createInstance(processGroup, desc, sampleRate, blockSize, error); },
+                                      std::move(onFinished));
+    }
+
+    return pluginLoader->load(desc, pluginId, sampleRate, blockSize, std::move(onFinished));
+}
+
+bool PluginManager::admitPluginInstance(const juce::String &pluginId, std::unique_ptr<juce::AudioPluginInstance> &instance)
+{
+    // Loader pool thread, with the instance already prepared
+    const juce::ScopedLock pluginLock(pluginInstanceLock);
+    auto &entry = pluginInstances[pluginId];
+    if (entry != nullptr)
+    {
+        DBG("Plugin " << pluginId << " is already loaded, keeping it");
+        return false;
+    }
+
+    // The device may have changed while it was loading
+    if (currentSampleRate > 0.0 && currentBlockSize > 0
+        && (instance->getSampleRate() != currentSampleRate || instance->getBlockSize() != currentBlockSize))
+        instance->prepareToPlay(currentSampleRate, currentBlockSize);
+
+    instance->setPlayHead(&hostPlayHead);
+    entry = std::move(instance);
+    assignPluginSlot(pluginId, entry.get());
+    publishPluginGraph();
+    DBG("Plugin instantiated successfully: " << pluginId);
+    return true;
+}
+
+void PluginManager::instantiatePluginsAsync(const std::vector<std::pair<juce::String, juce::String>> &idsAndNames,
+                                            std::function<void()> onAllFinished)
+{
+    // Message thread; so are the completion callbacks, which keeps the counts plain
+    if (idsAndNames.empty())
+    {
+        if (onAllFinished)
+            onAllFinished();
+        return;
+    }
+
+    struct Progress
+    {
+        int total = 0;
+        int finished = 0;
+        int failed = 0;
+    };
+    auto progress = std::make_shared<Progress>();
+    progress->total = (int)idsAndNames.size();
+    notifyRestoreStatus("Loading " + juce::String(progress->total) + " plugins...");
+
+    for (const auto &[pluginId, name] : idsAndNames)
+    {
+        instantiatePluginAsync(name, pluginId, [this, progress, onAllFinished](const PluginLoader::Result &result)
+                               {
+                                   ++progress->finished;
+                                   if (!result.loaded)
+                                       ++progress->failed;
+                                   notifyRestoreStatus("Loaded plugin " + juce::String(progress->finished) + " of "
+                                                       + juce::String(progress->total) + ": " + result.pluginId);
+
+                                   if (progress->finished < progress->total)
+                                       return;
+
+                                   DBG("Plugins loaded: " << progress->total - progress->failed << " of " << progress->total);
+                                   if (onAllFinished)
+                                       onAllFinished();
+                               });
+    }
+}
+
+void PluginManager::replacePlugin(const juce::String &name, const juce::String &pluginId)
+{
+    // Message thread. Plugins in a worker process are swapped with a hard cut.
+    if (!hasPluginInstance(pluginId) || getPluginProcessGroup(pluginId).isNotEmpty())
+    {
+        instantiatePluginByName(name, pluginId);
+        return;
+    }
+
+    const auto desc = getDescFromName(name);
+    if (desc.name.isEmpty())
+    {
+        DBG("Plugin not found: " << name);
+        return;
+    }
+
+    // A later replacement of the same id supersedes this one
+    const auto ticket = ++hotSwapTickets[pluginId];
+    const auto setup = deviceManager.getAudioDeviceSetup();
+    const double sampleRate = setup.sampleRate > 0.0 ? setup.sampleRate : currentSampleRate;
+    const int blockSize = setup.bufferSize > 0 ? setup.bufferSize : juce::jmax(1, currentBlockSize);
+    juce::Component::SafePointer<PluginManager> safeThis(this);
+
+    formatManager.createPluginInstanceAsync(
+        desc, sampleRate, blockSize,
+        [safeThis, pluginId, ticket, sampleRate, blockSize](std::unique_ptr<juce::AudioPluginInstance> instance,
+                                                           const juce::String &errorMessage)
+        {
+            if (instance == nullptr)
+            {
+                DBG("Error instantiating plugin: " << errorMessage);
+                return;
+            }
+
+            // Prepare and pre-roll on a thread of its own: neither the audio nor the message
+            // thread waits, and the first block it plays is not its first block ever
+            auto *prepared = instance.release();
+            juce::Thread::launch([safeThis, pluginId, ticket, sampleRate, blockSize, prepared]
+                                 {
+                                     try
+                                     {
+                                         prepared->prepareToPlay(sampleRate, blockSize);
+
+                                         juce::AudioBuffer<float> silence(juce::jmax(1, prepared->getTotalNumInputChannels(),
+                                                                                     prepared->getTotalNumOutputChannels()),
+                                                                          blockSize);
+                                         juce::MidiBuffer noMidi;
+                                         const int preRollBlocks = (int)std::ceil(kHotSwapPreRollSeconds * sampleRate / blockSize);
+                                         for (int i = 0; i < preRollBlocks; ++i)
+                                         {
+                                             silence.clear();
+                                             noMidi.clear();
+                                             prepared->processBlock(silence, noMidi);
+                                         }
+                                     }
+                                     catch (...)
+                                     {
+                                         DBG("Exception pre-rolling replacement for " << pluginId);
+                                     }
+
+                                     juce::MessageManager::callAsync([safeThis, pluginId, ticket, prepared]
+                                                                     {
+                                                                         std::unique_ptr<juce::AudioPluginInstance> owned(prepared);
+                                                                         if (safeThis != nullptr)
+                                                                             safeThis->completeHotSwap(pluginId, ticket, std::move(owned));
+                                                                     });
+                                 });
+        });
+}
+
+void PluginManager::completeHotSwap(const juce::String &pluginId, juce::uint32 ticket,
+                                    std::unique_ptr<juce::AudioPluginInstance> instance)
+{
+    // Message thread. An instance that lost the race is destroyed here, never published.
+    if (hotSwapTickets[pluginId] != ticket)
+        return;
+
+    // A slot fades out one instance at a time, so this one waits until finishHotSwap has retired
+    // the last. A newer replacement still supersedes it while it waits.
+    if (std::any_of(fadingInstances.begin(), fadingInstances.end(), [&pluginId](const auto &fading)
+                    { return fading.first == pluginId; }))
+    {
+        auto *waiting = instance.release();
+        juce::Component::SafePointer<PluginManager> safeThis(this);
+        juce::Timer::callAfterDelay(kHotSwapFinishDelayMs, [safeThis, pluginId, ticket, waiting]
+                                    {
+                                        std::unique_ptr<juce::AudioPluginInstance> owned(waiting);
+                                        if (safeThis != nullptr)
+                                            safeThis->completeHotSwap(pluginId, ticket, std::move(owned));
+                                    });
+        return;
+    }
+    hotSwapTickets.erase(pluginId);
+
+    // The device may have changed while it was being prepared
+    if (instance->getSampleRate() != currentSampleRate || instance->getBlockSize() != currentBlockSize)
+    {
+        if (currentSampleRate > 0.0 && currentBlockSize > 0)
+            instance->prepareToPlay(currentSampleRate, currentBlockSize);
+    }
+    instance->setPlayHead(&hostPlayHead);
+
+    const juce::ScopedLock pluginLock(pluginInstanceLock);
+    auto entry = pluginInstances.find(pluginId);
+    if (entry == pluginInstances.end() || entry->second == nullptr)
+    {
+        DBG("Plugin " << pluginId << " was removed before its replacement was ready");
+        return;
+    }
+
+    // Its editor must not outlive it
+    pluginWindows.erase(pluginId);
+
+    auto *old = entry->second.get();
+    fadingInstances.emplace_back(pluginId, std::move(entry->second));
+    entry->second = std::move(instance);
+
+    // A fresh slot at the same index: the published graph switches over at the next block
+    // and the old instance fades out inside it
+    assignPluginSlot(pluginId, entry->second.get());
+    if (auto *slot = findPluginSlotUnlocked(pluginId))
+    {
+        const int blockSize = juce::jmax(1, currentBlockSize);
+        slot->outgoingAudio.setSize(juce::jmax(1, old->getTotalNumInputChannels(), old->getTotalNumOutputChannels()), blockSize);
+        slot->outgoingMidi.ensureSize(kSlotMidiBufferBytes);
+        slot->crossfadeSamples = juce::jmax(1, (int)std::lround(kHotSwapCrossfadeSeconds * currentSampleRate));
+        slot->outgoing.store(old, std::memory_order_release);
+    }
+    publishPluginGraph();
+    DBG("Plugin replaced, crossfading: " << pluginId);
+
+    juce::Component::SafePointer<PluginManager> safeThis(this);
+    juce::Timer::callAfterDelay(kHotSwapFinishDelayMs, [safeThis, pluginId]
+                                {
+                                    if (safeThis != nullptr)
+                                        safeThis->finishHotSwap(pluginId, 1);
+                                });
+}
+
+void PluginManager::finishHotSwap(const juce::String &pluginId, int attempt)
+{
+    // Message thread
+    const juce::ScopedLock pluginLock(pluginInstanceLock);
+    if (auto *slot = findPluginSlotUnlocked(pluginId); slot != nullptr && slot->outgoing.load() != nullptr)
+    {
+        if (attempt < kHotSwapFinishAttempts)
+        {
+            juce::Component::SafePointer<PluginManager> safeThis(this);
+            juce::Timer::callAfterDelay(kHotSwapFinishDelayMs, [safeThis, pluginId, attempt]
+                                        {
+                                            if (safeThis != nullptr)
+                                                safeThis->finishHotSwap(pluginId, attempt + 1);
+                                        });
+            return;
+        }
+
+        // The callback never finished the fade (device stopped, plugin shed or asleep): cut over
+        slot->outgoing.store(nullptr);
     }
-    else
+
+    bool retired = false;
+    for (auto it = fadingInstances.begin(); it != fadingInstances.end();)
     {
-        DBG("Plugin not found: " << name);
+        if (it->first == pluginId)
+        {
+            retirePluginInstance(std::move(it->second));
+            it = fadingInstances.erase(it);
+            retired = true;
+        }
+        else
+        {
+            ++it;
+        }
     }
+
+    // Publishing is what hands retired instances to the grace period
+    if (retired)
+        publishPluginGraph();
 }
 
 // Method to get plugin instance IDs as a StringArray
@@ -520,6 +1741,16 @@ std::vector<PluginManager::PluginInstanceInfo> PluginManager::getPluginInstanceI
         else
             info.pluginName = "Unavailable";
 
+        if (const auto *slot = findPluginSlotUnlocked(pluginPair.first))
+        {
+            info.sleeping = slot->sleeping.load(std::memory_order_relaxed);
+            info.blocksProcessed = slot->blocksProcessed.load(std::memory_order_relaxed);
+            info.blocksSlept = slot->blocksSlept.load(std::memory_order_relaxed);
+            info.dspLoad = slot->dspLoad.getSummary();
+            info.priority = slot->priority.load();
+            info.shed = slot->shed.load();
+        }
+
         infos.push_back(std::move(info));
     }
 
@@ -532,28 +1763,83 @@ std::vector<PluginManager::PluginInstanceInfo> PluginManager::getPluginInstanceI
     return infos;
 }
 
+PluginManager::DspLoadReport PluginManager::getDspLoadReport() const
+{
+    DspLoadReport report;
+    report.callback = callbackLoad.getSummary();
+
+    const juce::ScopedLock pluginLock(pluginInstanceLock);
+    report.plugins.reserve(pluginInstances.size());
+    for (const auto &pluginPair : pluginInstances)
+    {
+        if (const auto *slot = findPluginSlotUnlocked(pluginPair.first))
+            report.plugins.push_back({pluginPair.first, slot->dspLoad.getSummary()});
+    }
+
+    // Heaviest first
+    std::sort(report.plugins.begin(), report.plugins.end(),
+              [](const DspLoadReport::PluginLoad &a, const DspLoadReport::PluginLoad &b)
+              {
+                  return a.load.p99Percent > b.load.p99Percent;
+              });
+
+    if (auto *device = deviceManager.getCurrentAudioDevice())
+        report.deviceXRuns = device->getXRunCount();
+
+    return report;
+}
+
+void PluginManager::resetDspLoadStats()
+{
+    callbackLoad.reset();
+
+    const juce::ScopedLock pluginLock(pluginInstanceLock);
+    for (auto &slot : slotObjects)
+    {
+        if (slot != nullptr)
+            slot->dspLoad.reset();
+    }
+}
+
 void PluginManager::instantiatePlugin(juce::PluginDescription *desc, const juce::String &pluginId)
+{
+    instantiatePluginIn(desc, pluginId, getPluginProcessGroup(pluginId));
+}
+
+bool PluginManager::instantiatePluginIn(juce::PluginDescription *desc, const juce::String &pluginId, const juce::String &processGroup)
 {
     juce::String errorMessage;
 
     auto sampleRate = deviceManager.getAudioDeviceSetup().sampleRate;
     auto blockSize = deviceManager.getAudioDeviceSetup().bufferSize;
 
-    std::unique_ptr<juce::AudioPluginInstance> instance = formatManager.createPluginInstance(
-        *desc, sampleRate, blockSize, errorMessage);
+    std::unique_ptr<juce::AudioPluginInstance> instance =
+        processGroup.isEmpty() ? formatManager.createPluginInstance(*desc, sampleRate, blockSize, errorMessage)
+                               : remotePluginHost.createInstance(processGroup, *desc, sampleRate, blockSize, errorMessage);
 
     if (instance != nullptr)
     {
+        // Prepared before it is published, so the audio thread only ever sees it ready to run
+        instance->setPlayHead(&hostPlayHead);
+        instance->prepareToPlay(sampleRate, blockSize);
+
         const juce::ScopedLock pluginLock(pluginInstanceLock);
-        pluginInstances[pluginId] = std::move(instance);
-        pluginInstances[pluginId]->setPlayHead(&hostPlayHead);
-        pluginInstances[pluginId]->prepareToPlay(sampleRate, blockSize);
+        auto &entry = pluginInstances[pluginId];
+        if (entry != nullptr)
+        {
+            // Replacing a live instance: its editor must not outlive it
+            pluginWindows.erase(pluginId);
+            retirePluginInstance(std::move(entry));
+        }
+        entry = std::move(instance);
+        assignPluginSlot(pluginId, entry.get());
+        publishPluginGraph();
         DBG("Plugin instantiated successfully: " << pluginId);
+        return true;
     }
-    else
-    {
-        DBG("Error instantiating plugin: " << errorMessage);
-    }
+
+    DBG("Error instantiating plugin: " << errorMessage);
+    return false;
 }
 
 void PluginManager::openPluginWindow(juce::String pluginId)
@@ -562,6 +1848,7 @@ void PluginManager::openPluginWindow(juce::String pluginId)
     if (pluginWindows.find(pluginId) == pluginWindows.end() && pluginInstances.find(pluginId) != pluginInstances.end())
     {
         pluginWindows[pluginId] = std::make_unique<PluginWindow>(pluginInstances[pluginId].get());
+        attachWindowKeepAwake(pluginId);
     }
     else if (pluginWindows.find(pluginId) != pluginWindows.end())
     {
@@ -575,26 +1862,6 @@ void PluginManager::openPluginWindow(juce::String pluginId)
     }
 }
 
-void PluginManager::logBusRmsIfNeeded(int numSamples)
-{
-    if (numSamples <= 0 || rmsDebugIntervalSamples <= 0)
-        return;
-
-    rmsDebugSamplesAccumulated += numSamples;
-    if (rmsDebugSamplesAccumulated < rmsDebugIntervalSamples)
-        return;
-
-    const auto rmsValues = audioRouter.calculateRmsPerBus(numSamples);
-    juce::String message("Bus RMS: ");
-    for (const auto &[name, rms] : rmsValues)
-    {
-        message << name << "=" << juce::String(rms, 4) << " ";
-    }
-
-    DBG(message.trimEnd());
-    rmsDebugSamplesAccumulated = 0;
-}
-
 std::vector<PluginManager::StemConfig> PluginManager::getStemConfigs() const
 {
     return stemConfigs;
@@ -672,6 +1939,10 @@ void PluginManager::setStemConfigs(const std::vector<StemConfig> &configs)
     }
 
     audioRouter.setStemRules(definitions);
+
+    // Stem names may have changed case or appeared, so re-resolve the bus graph against them
+    const juce::ScopedLock pluginLock(pluginInstanceLock);
+    rebuildBusGraph();
 }
 
 void PluginManager::rebuildRouterTagIndexFromConductor()
@@ -771,7 +2042,7 @@ bool PluginManager::saveRoutingConfigToFile(const juce::File &file) const
         parentDir.createDirectory();
 
     juce::XmlElement root("RoutingConfig");
-    root.setAttribute("version", 1);
+    root.setAttribute("version", 2);
 
     for (const auto &stem : stemConfigs)
     {
@@ -792,6 +2063,25 @@ bool PluginManager::saveRoutingConfigToFile(const juce::File &file) const
         }
     }
 
+    for (const auto &bus : getBusDefinitions())
+    {
+        auto *busElement = root.createNewChildElement("Bus");
+        busElement->setAttribute("name", bus.name);
+        busElement->setAttribute("output", bus.output);
+        busElement->setAttribute("return", bus.isReturn ? 1 : 0);
+
+        for (const auto &insertId : bus.inserts)
+            busElement->createNewChildElement("Insert")->setAttribute("plugin", insertId);
+    }
+
+    for (const auto &send : getBusSends())
+    {
+        auto *sendElement = root.createNewChildElement("Send");
+        sendElement->setAttribute("plugin", send.pluginId);
+        sendElement->setAttribute("bus", send.busName);
+        sendElement->setAttribute("level", (double)send.level);
+    }
+
     return root.writeTo(file);
 }
 
@@ -807,9 +2097,41 @@ bool PluginManager::loadRoutingConfigFromFile(const juce::File &file)
         return false;
 
     std::vector<StemConfig> loaded;
+    std::vector<BusDefinition> loadedBuses;
+    std::vector<BusSend> loadedSends;
 
     for (auto *stemElement = xml->getFirstChildElement(); stemElement != nullptr; stemElement = stemElement->getNextElement())
     {
+        if (stemElement->hasTagName("Bus"))
+        {
+            BusDefinition bus;
+            bus.name = stemElement->getStringAttribute("name").trim();
+            bus.output = stemElement->getStringAttribute("output", "Master").trim();
+            bus.isReturn = stemElement->getBoolAttribute("return", false);
+            for (auto *insertElement = stemElement->getChildByName("Insert"); insertElement != nullptr;
+                 insertElement = insertElement->getNextElementWithTagName("Insert"))
+            {
+                auto pluginId = insertElement->getStringAttribute("plugin").trim();
+                if (pluginId.isNotEmpty())
+                    bus.inserts.push_back(pluginId);
+            }
+
+            if (bus.name.isNotEmpty())
+                loadedBuses.push_back(std::move(bus));
+            continue;
+        }
+
+        if (stemElement->hasTagName("Send"))
+        {
+            BusSend send;
+            send.pluginId = stemElement->getStringAttribute("plugin").trim();
+            send.busName = stemElement->getStringAttribute("bus").trim();
+            send.level = (float)stemElement->getDoubleAttribute("level", 0.0);
+            if (send.pluginId.isNotEmpty() && send.busName.isNotEmpty() && send.level > 0.0f)
+                loadedSends.push_back(std::move(send));
+            continue;
+        }
+
         if (!stemElement->hasTagName("Stem"))
             continue;
 
@@ -847,6 +2169,12 @@ bool PluginManager::loadRoutingConfigFromFile(const juce::File &file)
     }
 
     setStemConfigs(loaded);
+
+    // Files from before the bus graph have neither, which clears it
+    const juce::ScopedLock pluginLock(pluginInstanceLock);
+    busDefinitions = std::move(loadedBuses);
+    busSends = std::move(loadedSends);
+    rebuildBusGraph();
     return true;
 }
 
@@ -887,12 +2215,14 @@ void PluginManager::resetPlugin(const juce::String &pluginId)
         // Destroy the plugin window first which also deletes the editor
         pluginWindows.erase(pluginId);
 
-        // Release and reset the plugin instance
-        pluginInstances[pluginId]->releaseResources();
-        pluginInstances[pluginId].reset();
+        // Unpublish the slot; the instance is released and destroyed once the audio
+        // thread is guaranteed to have stopped using it
+        releasePluginSlot(pluginId);
+        retirePluginInstance(std::move(pluginInstances[pluginId]));
 
         // Remove instance entry from map
         pluginInstances.erase(pluginId);
+        publishPluginGraph();
 
         DBG("Plugin reset: " << pluginId);
     }
@@ -918,6 +2248,58 @@ void PluginManager::resetAllPlugins()
     DBG("All plugins have been reset.");
 }
 
+bool PluginManager::setPluginProcessGroup(const juce::String &pluginId, const juce::String &group)
+{
+    const auto newGroup = group.trim();
+    auto commitGroup = [this, &pluginId, &newGroup]
+    {
+        if (newGroup.isEmpty())
+            pluginProcessGroups.erase(pluginId);
+        else
+            pluginProcessGroups[pluginId] = newGroup;
+    };
+
+    juce::PluginDescription desc;
+    juce::MemoryBlock state;
+    {
+        const juce::ScopedLock pluginLock(pluginInstanceLock);
+        const auto current = pluginProcessGroups.count(pluginId) > 0 ? pluginProcessGroups[pluginId] : juce::String();
+        if (current == newGroup)
+            return true;
+
+        auto it = pluginInstances.find(pluginId);
+        if (it == pluginInstances.end() || it->second == nullptr)
+        {
+            commitGroup();
+            return true;
+        }
+
+        desc = it->second->getPluginDescription();
+        it->second->getStateInformation(state);
+    }
+
+    // Reloaded in its new home; playback of this plugin stops for the reload. The old instance
+    // and its group stay as they were if the new one fails to load.
+    if (!instantiatePluginIn(&desc, pluginId, newGroup))
+        return false;
+
+    {
+        const juce::ScopedLock pluginLock(pluginInstanceLock);
+        commitGroup();
+    }
+
+    restorePluginState(pluginId, state);
+    DBG("Plugin " << pluginId << " now runs in " << (newGroup.isEmpty() ? juce::String("the engine") : "worker process " + newGroup));
+    return true;
+}
+
+juce::String PluginManager::getPluginProcessGroup(const juce::String &pluginId) const
+{
+    const juce::ScopedLock pluginLock(pluginInstanceLock);
+    auto it = pluginProcessGroups.find(pluginId);
+    return it != pluginProcessGroups.end() ? it->second : juce::String();
+}
+
 bool PluginManager::hasPluginInstance(const juce::String &pluginId)
 {
     const juce::ScopedLock pluginLock(pluginInstanceLock);
@@ -1594,8 +2976,7 @@ bool PluginManager::loadPluginListFromFile()
 
 void PluginManager::clearTaggedMidiBuffer()
 {
-    const juce::ScopedLock sl(midiCriticalSection);
-    taggedMidiBuffer.clear();
+    midiIngestQueue.requestClear();
 }
 
 void PluginManager::clearMasterTaggedMidiBuffer()
@@ -1606,14 +2987,9 @@ void PluginManager::clearMasterTaggedMidiBuffer()
 
 void PluginManager::printTaggedMidiBuffer()
 {
-    const juce::ScopedLock sl(midiCriticalSection);
-    DBG("Tagged MIDI Buffer Contents:");
-    for (const auto &taggedMessage : taggedMidiBuffer)
-    {
-        DBG("Plugin ID: " << taggedMessage.pluginId
-                          << ", Timestamp: " << taggedMessage.timestamp
-                          << ", Message: " << taggedMessage.message.getDescription());
-    }
+    // The queue itself belongs to the audio thread, so only report what it published
+    DBG("Tagged MIDI Buffer: " << pendingMidiCount.load() << " pending events, "
+                               << (int)midiIngestQueue.getDroppedCount() << " dropped at ingest");
 }
 
 void PluginManager::printMasterTaggedMidiBufferSummary()
@@ -1721,6 +3097,9 @@ bool PluginManager::saveMasterTaggedMidiBufferToFile(const juce::File &file)
         xmlEvent->setAttribute("data", dataBlock.toBase64Encoding());
     }
 
+    // The capture's timestamps and the tempo map share a clock, so they are kept together
+    root.addChildElement(getTempoMap().createXml().release());
+
     if (auto parent = file.getParentDirectory(); !parent.exists())
         parent.createDirectory();
 
@@ -1770,7 +3149,6 @@ bool PluginManager::loadMasterTaggedMidiBufferFromFile(const juce::File &file)
     {
         const juce::ScopedLock sl(midiCriticalSection);
         masterTaggedMidiBuffer.clear();
-        taggedMidiBuffer.clear();
         previewActive = false;
         previewPaused = false;
         previewOffsetMs = 0.0;
@@ -1780,6 +3158,10 @@ bool PluginManager::loadMasterTaggedMidiBufferFromFile(const juce::File &file)
             insertSortedMidiMessage(masterTaggedMidiBuffer, std::move(message));
     }
 
+    // Older captures have no tempo map and leave the current one alone
+    if (auto *tempoXml = xml->getChildByName(TempoMap::kXmlTag))
+        setTempoMap(TempoMap::fromXml(*tempoXml));
+
     resetPlayback();
     stopAllNotes();
     return true;
@@ -1806,6 +3188,7 @@ void PluginManager::prepareAllPlugins(double sampleRate, int blockSize)
             pluginInstance->prepareToPlay(sampleRate, blockSize);
         }
     }
+    prepareScratchBuffers(blockSize);
 }
 
 void PluginManager::setRenderProgressCallback(std::function<void(float)> callback)
@@ -1884,14 +3267,13 @@ void PluginManager::beginExclusiveRender(double sampleRate, int blockSize)
     if (wasRendering)
         return;
 
+    // Wait out any callback that started before the flag was raised; later ones return early
+    pluginGraphDomain.synchronize();
+
     liveSampleRateBackup = currentSampleRate;
     liveBlockSizeBackup = currentBlockSize;
 
-    {
-        const juce::ScopedLock sl(midiCriticalSection);
-        taggedMidiBuffer.clear();
-        incomingMidi.clear();
-    }
+    midiIngestQueue.requestClear();
 
     currentSampleRate = sampleRate;
     currentBlockSize = blockSize;
@@ -1915,11 +3297,7 @@ void PluginManager::endExclusiveRender()
 
     stopAllNotes();
 
-    {
-        const juce::ScopedLock sl(midiCriticalSection);
-        taggedMidiBuffer.clear();
-        incomingMidi.clear();
-    }
+    midiIngestQueue.requestClear();
 
     if (liveSampleRateBackup > 0.0 && liveBlockSizeBackup > 0)
     {
@@ -1927,6 +3305,9 @@ void PluginManager::endExclusiveRender()
         currentBlockSize = liveBlockSizeBackup;
         invokeOnMessageThreadBlocking([this]()
                                       { prepareAllPlugins(currentSampleRate, currentBlockSize); });
+
+        // The device now plays the Master bus, so give the buses back their live shape
+        audioRouter.prepare(currentSampleRate, currentBlockSize, liveOutputChannels);
     }
 
     renderInProgress.store(false);
@@ -1978,6 +3359,10 @@ bool PluginManager::renderMaster(const juce::File &outFolder,
 
     const double renderZeroMs = static_cast<double>(snapshot.front().timestamp);
     auto renderEvents = buildRenderTimelineFromSnapshot(snapshot, renderZeroMs, sampleRate);
+
+    // Render sample 0 is the first captured event, which sits renderStartSample into the tempo map
+    const auto renderTempo = getTempoMap();
+    const auto renderStartSample = static_cast<juce::int64>(std::llround(renderZeroMs * sampleRate / 1000.0));
     if (renderEvents.empty())
     {
         DBG("RenderMaster: render events empty after conversion");
@@ -2033,18 +3418,68 @@ bool PluginManager::renderMaster(const juce::File &outFolder,
             return false;
     }
 
-    std::unordered_map<juce::String, juce::MidiBuffer> midiByPlugin;
+    // Returns render alongside the stems, after their inserts
+    std::vector<juce::String> returnBusNames;
+    {
+        const juce::ScopedLock pluginLock(pluginInstanceLock);
+        for (const auto &node : compiledBuses)
+        {
+            if (node.isReturn)
+                returnBusNames.push_back(node.name);
+        }
+    }
+    for (const auto &returnName : returnBusNames)
+    {
+        if (writers.count(returnName) == 0 && !addBusWriters(returnName, "_" + sanitiseRenderName(returnName)))
+            return false;
+    }
+
     size_t eventIndex = 0;
-    juce::AudioBuffer<float> pluginBuffer;
 
     const juce::ScopedLock pluginLock(pluginInstanceLock);
+
+    // Resolve every event's plugin once, up front, rather than per block
+    std::vector<PluginHandle> renderTargets;
+    renderTargets.reserve(renderEvents.size());
+    {
+        std::unordered_map<juce::String, PluginHandle> handleCache;
+        for (const auto &ev : renderEvents)
+        {
+            auto cached = handleCache.find(ev.pluginId);
+            if (cached == handleCache.end())
+                cached = handleCache.emplace(ev.pluginId, getPluginHandle(ev.pluginId)).first;
+            renderTargets.push_back(cached->second);
+        }
+    }
+
+    // The live callback is locked out for the whole render, so the current graph's scratch is ours
+    auto &graph = *pluginGraph.get();
+    for (auto *slot : graph.active)
+        slot->midi.clear();
+
+    // Offline there is no block deadline: remote plugins wait for every result, so a slow
+    // worker makes the render slower rather than dropping blocks from it
+    for (auto *slot : graph.remote)
+        slot->remote->setOffline(true);
+
     audioRouter.prepare(sampleRate, blockSize, 2);
     audioRouter.setRenderDebugEnabled(true);
-    for (int64 blockStart = 0; blockStart < endSample; blockStart += blockSize)
+
+    // The router's route tables are reclaimed through the graph's domain
+    const RcuDomain::ReadScope routeReadScope(pluginGraphDomain);
+    for (int64 blockStart = 0; blockStart < endSample;)
     {
-        const int numSamples = (int)juce::jmin<int64>(blockSize, endSample - blockStart);
+        // Blocks stop short of tempo changes, as they do live
+        int numSamples = (int)juce::jmin<int64>(blockSize, endSample - blockStart);
+        const auto timelineSample = renderStartSample + blockStart;
+        const auto nextTempoChange = renderTempo.getNextChangeSample(timelineSample, sampleRate);
+        if (nextTempoChange > timelineSample)
+            numSamples = (int)juce::jmin<int64>(numSamples, nextTempoChange - timelineSample);
+
+        auto position = renderTempo.getPositionAt(timelineSample, sampleRate);
+        position.setIsPlaying(true);
+        hostPlayHead.publish(position);
         audioRouter.beginBlock(numSamples);
-        midiByPlugin.clear();
 
         const int64 blockEnd = blockStart + numSamples;
         while (eventIndex < renderEvents.size() && renderEvents[eventIndex].samplePos < blockEnd)
@@ -2052,42 +3487,54 @@ bool PluginManager::renderMaster(const juce::File &outFolder,
             const auto &ev = renderEvents[eventIndex];
             if (ev.samplePos >= blockStart)
             {
-                const int offset = (int)(ev.samplePos - blockStart);
-                midiByPlugin[ev.pluginId].addEvent(ev.message, offset);
+                if (auto *slot = resolvePluginSlot(graph, renderTargets[eventIndex]))
+                    slot->midi.addEvent(ev.message, (int)(ev.samplePos - blockStart));
             }
             ++eventIndex;
         }
 
-        for (const auto &[pluginId, pluginInstance] : pluginInstances)
+        int numJobs = 0;
+        for (auto *activeSlot : graph.active)
         {
-            if (pluginInstance == nullptr)
-                continue;
-
-            juce::MidiBuffer midi;
-            if (auto it = midiByPlugin.find(pluginId); it != midiByPlugin.end())
-                midi = std::move(it->second);
-
-            const int pluginChannels = juce::jmax(1, pluginInstance->getTotalNumOutputChannels());
-            pluginBuffer.setSize(pluginChannels, numSamples, false, false, true);
-            pluginBuffer.clear();
+            auto &slot = *activeSlot;
+            auto &job = graph.jobs[(size_t)numJobs++];
+            job.slot = &slot;
+            job.instance = slot.instance;
+            job.midi.clear();
+            job.midi.swapWith(slot.midi);
+
+            const int pluginChannels = juce::jmax(1, slot.instance->getTotalNumOutputChannels());
+            job.slot->audio.setSize(pluginChannels, numSamples, false, false, true);
+            job.slot->audio.clear();
+        }
 
+        // Offline, but timed against the real-time budget so heavy plugins show up in the same stats
+        const double budgetTicks = DspLoadHistogram::budgetTicksFor(numSamples, sampleRate);
+        auto renderJob = [&graph, budgetTicks](int jobIndex)
+        {
+            auto &job = graph.jobs[(size_t)jobIndex];
+            const auto startTicks = juce::Time::getHighResolutionTicks();
             try
             {
-                pluginInstance->processBlock(pluginBuffer, midi);
+                job.instance->processBlock(job.slot->audio, job.midi);
             }
             catch (const std::exception &e)
             {
-                DBG("RenderMaster: exception processing " << pluginId << ": " << e.what());
-                pluginBuffer.clear();
+                DBG("RenderMaster: exception processing " << job.slot->pluginId << ": " << e.what());
+                job.slot->audio.clear();
             }
             catch (...)
             {
-                DBG("RenderMaster: unknown exception processing " << pluginId);
-                pluginBuffer.clear();
+                DBG("RenderMaster: unknown exception processing " << job.slot->pluginId);
+                job.slot->audio.clear();
             }
+            job.slot->dspLoad.recordTicks(juce::Time::getHighResolutionTicks() - startTicks, budgetTicks);
+        };
+        workerPool.run(numJobs, renderJob);
 
-            audioRouter.routeAudio(pluginId, pluginBuffer, numSamples);
-        }
+        for (int i = 0; i < numJobs; ++i)
+            audioRouter.routeAudio(graph.jobs[(size_t)i].slot->slotIndex, graph.jobs[(size_t)i].slot->audio, numSamples);
+        processBusGraph(graph, numSamples, budgetTicks);
 
         for (auto &[busName, writerList] : writers)
         {
@@ -2105,11 +3552,15 @@ bool PluginManager::renderMaster(const juce::File &outFolder,
                     writer->writeFromFloatArrays(channelPointers, 2, numSamples);
             }
         }
+        blockStart += numSamples;
         float progressValue = static_cast<float>(blockStart) / static_cast<float>(endSample);
         renderProgress.store(progressValue);
         notifyRenderProgress(progressValue);
     }
 
+    for (auto *slot : graph.remote)
+        slot->remote->setOffline(false);
+
     writers.clear();
     audioRouter.setRenderDebugEnabled(false);
     renderProgress.store(1.0f);
@@ -2175,11 +3626,27 @@ void PluginManager::enqueueMasterForPreview(const std::vector<MyMidiMessage> &so
         staged.push_back(std::move(scheduled));
     }
 
+    // Bulk producer: wait for the audio thread to make room rather than dropping events
+    midiIngestQueue.requestClear();
+    std::unordered_map<juce::String, PluginHandle> handleCache;
+    int queued = 0;
+    for (const auto &message : staged)
     {
-        const juce::ScopedLock sl(midiCriticalSection);
-        taggedMidiBuffer.assign(staged.begin(), staged.end());
+        auto cached = handleCache.find(message.pluginId);
+        if (cached == handleCache.end())
+            cached = handleCache.emplace(message.pluginId, getPluginHandle(message.pluginId)).first;
+        if (cached->second == kInvalidPluginHandle)
+            continue;
+
+        // Capture timestamps are ms; the ingest path carries us
+        if (!midiIngestQueue.push(MidiIngestSource::Control, message.message, cached->second, message.timestamp * 1000, kBulkIngestTimeoutMs))
+        {
+            DBG("enqueueMasterForPreview: ingest lane stalled, stopping after " << queued << " events");
+            break;
+        }
+        ++queued;
     }
-    DBG("enqueueMasterForPreview complete, queued events: " << (int)taggedMidiBuffer.size());
+    DBG("enqueueMasterForPreview complete, queued events: " << queued);
 }
 
 void PluginManager::previewPlay()
@@ -2212,7 +3679,6 @@ void PluginManager::previewPlay()
         }
 
         previewStartHostMs = nowMs;
-        playbackSamplePosition = 0;
     }
 
     enqueueMasterForPreview(snapshot, previewOffsetMs, baseTimestamp);
@@ -2231,12 +3697,14 @@ void PluginManager::previewPause()
         previewOffsetMs += (nowMs - previewStartHostMs);
         previewPauseHostMs = nowMs;
         previewPaused = true;
-        taggedMidiBuffer.clear();
         shouldStop = true;
     }
 
     if (shouldStop)
+    {
+        midiIngestQueue.requestClear();
         stopAllNotes();
+    }
 }
 
 void PluginManager::previewStop()
@@ -2246,8 +3714,8 @@ void PluginManager::previewStop()
         previewActive = false;
         previewPaused = false;
         previewOffsetMs = 0.0;
-        taggedMidiBuffer.clear();
     }
+    midiIngestQueue.requestClear();
     stopAllNotes();
     resetPlayback();
 }
@@ -2284,49 +3752,96 @@ bool PluginManager::isPreviewPaused() const
     return previewPaused;
 }
 
-void PluginManager::addMidiMessage(const juce::MidiMessage &message, const juce::String &pluginId, juce::int64 &adjustedTimestamp)
+void PluginManager::addMidiMessage(const juce::MidiMessage &message, const juce::String &pluginId, juce::int64 &adjustedTimestampUs,
+                                   MidiIngestSource source)
+{
+    addMidiMessage(message, PluginTarget{pluginId, getPluginHandle(pluginId)}, adjustedTimestampUs, source);
+}
+
+void PluginManager::addMidiMessage(const juce::MidiMessage &message, const PluginTarget &target, juce::int64 &adjustedTimestampUs,
+                                   MidiIngestSource source)
 {
+    const auto &pluginId = target.pluginId;
     const bool rendering = renderInProgress.load();
-    const juce::ScopedLock sl(midiCriticalSection); // Lock the critical section to ensure thread safety
 
-    // Live OSC plugins sometimes send timestamp 0. Keep playback scheduling as-is (timestamp 0 = immediate),
-    // but record capture needs a monotonic clock so we stamp it with wall-clock ms when missing.
-    juce::int64 captureTimestamp = adjustedTimestamp;
-    if (captureEnabled && captureTimestamp <= 0)
+    // Events for plugins that are not instantiated can never play, but are still captured
+    if (!rendering && target.handle != kInvalidPluginHandle)
     {
-        captureTimestamp = static_cast<juce::int64>(juce::Time::getMillisecondCounterHiRes());
-        if (captureStartMs < 0.0 && masterTaggedMidiBuffer.empty())
-            captureStartMs = static_cast<double>(captureTimestamp);
+        // Interactive producers never wait on the audio thread; bulk ones (overdub republish) may
+        const int timeoutMs = source == MidiIngestSource::Overdub ? kBulkIngestTimeoutMs : 0;
+        if (!midiIngestQueue.push(source, message, target.handle, adjustedTimestampUs, timeoutMs))
+        {
+            static juce::uint32 lastOverflowLog = 0;
+            const auto now = juce::Time::getMillisecondCounter();
+            if (now - lastOverflowLog > kMidiOverflowLogIntervalMs)
+            {
+                DBG("Warning: MIDI ingest lane full; dropped event for " << pluginId);
+                lastOverflowLog = now;
+            }
+        }
     }
 
-    if (rendering)
-    {
-        if (captureEnabled)
-            insertIntoMasterCaptureUnlocked(MyMidiMessage(message, pluginId, captureTimestamp));
+    // The capture buffer is only shared with other producers and the message thread
+    const juce::ScopedLock sl(midiCriticalSection);
+    if (!captureEnabled)
         return;
+
+    captureMidiMessageUnlocked(message, pluginId, adjustedTimestampUs);
+    // DBG("Added MIDI message: " << message.getDescription() << " for pluginId: " << pluginId << " at adjusted time: " << juce::String(adjustedTimestampUs));
+}
+
+void PluginManager::addMidiMessages(const MidiEventBatch &batch, MidiIngestSource source)
+{
+    // Events for plugins that are not instantiated are skipped by the lane, but still captured
+    if (!renderInProgress.load())
+    {
+        const int timeoutMs = source == MidiIngestSource::Overdub ? kBulkIngestTimeoutMs : 0;
+        if (!midiIngestQueue.pushBatch(source, batch, timeoutMs))
+            DBG("Warning: MIDI ingest lane full; dropped a batch of events");
     }
 
-    insertSortedMidiMessage(taggedMidiBuffer, MyMidiMessage(message, pluginId, adjustedTimestamp));
+    const juce::ScopedLock sl(midiCriticalSection);
+    if (!captureEnabled)
+        return;
 
-    if (taggedMidiBuffer.size() > kMaxTaggedMidiEvents)
+    struct Capture : MidiEventBatch::Visitor
     {
-        const auto overflow = taggedMidiBuffer.size() - kMaxTaggedMidiEvents;
-        for (std::size_t i = 0; i < overflow && !taggedMidiBuffer.empty(); ++i)
-            taggedMidiBuffer.pop_back();
+        explicit Capture(PluginManager &m) : manager(m) {}
 
-        static juce::uint32 lastOverflowLog = 0;
-        const auto now = juce::Time::getMillisecondCounter();
-        if (now - lastOverflowLog > kMidiOverflowLogIntervalMs)
+        void visit(const juce::uint8 *data, int size, PluginHandle, const juce::String &pluginId, juce::int64 timestamp) override
         {
-            DBG("Warning: MIDI queue exceeded " << (int)kMaxTaggedMidiEvents
-                                                << " events; dropping " << (int)overflow << " far-future events.");
-            lastOverflowLog = now;
+            manager.captureMidiMessageUnlocked(juce::MidiMessage(data, size), pluginId, timestamp);
         }
+
+        PluginManager &manager;
+    } capture(*this);
+    batch.forEachEvent(capture);
+}
+
+void PluginManager::captureMidiMessageUnlocked(const juce::MidiMessage &message, const juce::String &pluginId, juce::int64 timestampUs)
+{
+    // Live OSC plugins sometimes send timestamp 0. Keep playback scheduling as-is (timestamp 0 = immediate),
+    // but record capture needs a monotonic clock so we stamp it with wall-clock ms when missing.
+    // The capture (and its saved file format) stays in ms.
+    juce::int64 captureTimestamp = timestampUs / 1000;
+    if (timestampUs <= 0)
+    {
+        captureTimestamp = static_cast<juce::int64>(juce::Time::getMillisecondCounterHiRes());
+        if (captureStartMs < 0.0 && masterTaggedMidiBuffer.empty())
+            captureStartMs = static_cast<double>(captureTimestamp);
     }
 
-    if (captureEnabled)
-        insertIntoMasterCaptureUnlocked(MyMidiMessage(message, pluginId, captureTimestamp));
-    // DBG("Added MIDI message: " << message.getDescription() << " for pluginId: " << pluginId << " at adjusted time: " << juce::String(adjustedTimestamp));
+    insertIntoMasterCaptureUnlocked(MyMidiMessage(message, pluginId, captureTimestamp));
+}
+
+void PluginManager::addLiveInputMidi(const juce::MidiMessage &message, const juce::String &pluginId)
+{
+    if (pluginId.isEmpty() || renderInProgress.load())
+        return;
+
+    const auto handle = getPluginHandle(pluginId);
+    if (handle != kInvalidPluginHandle)
+        midiIngestQueue.push(MidiIngestSource::MidiInput, message, handle, 0);
 }
 
 void PluginManager::insertIntoMasterCapture(MyMidiMessage message)
@@ -2343,50 +3858,19 @@ void PluginManager::insertIntoMasterCaptureUnlocked(MyMidiMessage message)
     insertSortedMidiMessage(masterTaggedMidiBuffer, std::move(message));
 }
 
-void PluginManager::resetPlayback()
+void PluginManager::resetPlayback(double anchorHostMs)
 {
-    playbackSamplePosition = 0;
-    hostPlayHead.positionInfo.setIsPlaying(false);
-    // Also clear the taggedMidiBuffer under the MIDI lock
-    const juce::ScopedLock sl(midiCriticalSection);
-    taggedMidiBuffer.clear();
+    // Applied by the audio thread at the start of its next block; the anchor is published first
+    playbackAnchorHostMs.store(anchorHostMs, std::memory_order_release);
+    midiIngestQueue.requestClear(true);
 }
 
 // And stop any currently playing notes
 void PluginManager::stopAllNotes()
 {
-    const juce::ScopedLock sl(midiCriticalSection);
-    for (auto &[pluginId, pluginInstance] : pluginInstances)
-    {
-        if (pluginInstance != nullptr)
-        {
-            int numOut = pluginInstance->getTotalNumOutputChannels();
-            if (numOut <= 0)
-                continue; // Skip plugins with no output channels
-
-            juce::MidiBuffer stopMessages;
-            for (int channel = 1; channel <= 16; ++channel)
-            {
-                stopMessages.addEvent(juce::MidiMessage::allNotesOff(channel), 0);
-                stopMessages.addEvent(juce::MidiMessage::allSoundOff(channel), 0);
-            }
-            juce::AudioBuffer<float> dummyBuffer(numOut, 512);
-            dummyBuffer.clear();
-
-            try
-            {
-                pluginInstance->processBlock(dummyBuffer, stopMessages);
-            }
-            catch (const std::exception &e)
-            {
-                DBG("Exception in stopAllNotes for plugin " << pluginId << ": " << e.what());
-            }
-            catch (...)
-            {
-                DBG("Unknown exception in stopAllNotes for plugin " << pluginId);
-            }
-        }
-    }
+    // Plugins may only be processed on the audio thread, so hand the all-notes-off
+    // burst to the next block rather than calling processBlock from here
+    allNotesOffRequested.store(true);
 }
 
 juce::int8 PluginManager::getNumInstances(std::vector<juce::String> &instances)
@@ -2449,6 +3933,14 @@ void PluginManager::savePluginDescriptionsToFile(const juce::String &dataFilePat
                 dataOutputStream.writeString(desc.name);
             }
         }
+
+        // Worker process of each plugin, in the same order, after the list so older builds
+        // still read the file
+        for (const auto &pluginPair : pluginInstances)
+        {
+            if (instances.empty() || std::find(instances.begin(), instances.end(), pluginPair.first) != instances.end())
+                dataOutputStream.writeString(getPluginProcessGroup(pluginPair.first));
+        }
         DBG("All plugin descriptions saved successfully to binary file.");
     }
     else
@@ -2457,7 +3949,7 @@ void PluginManager::savePluginDescriptionsToFile(const juce::String &dataFilePat
     }
 }
 
-void PluginManager::restorePluginDescriptionsFromFile(const juce::String &dataFilePath)
+void PluginManager::restorePluginDescriptionsFromFile(const juce::String &dataFilePath, std::function<void()> onRestored)
 {
     // Restore plugin descriptions from binary file dataFilePath
     juce::File dataFile(dataFilePath);
@@ -2470,26 +3962,38 @@ void PluginManager::restorePluginDescriptionsFromFile(const juce::String &dataFi
         // iterate plugin instances and remove them
         resetAllPlugins();
 
-        // Iterate over each plugin instance and restore its description
+        // Read every description first, then load them all at once
+        std::vector<std::pair<juce::String, juce::String>> idsAndNames;
         for (int i = 0; i < numPluginInstances; ++i)
         {
             juce::String pluginId = dataInputStream.readString();
             juce::String name = dataInputStream.readString();
-            juce::PluginDescription desc;
-            desc.name = name;
+            idsAndNames.emplace_back(pluginId, name);
+        }
 
-            instantiatePluginByName(name, pluginId);
+        // Groups first, so each plugin loads straight into its worker process
+        {
+            const juce::ScopedLock pluginLock(pluginInstanceLock);
+            pluginProcessGroups.clear();
         }
+        restorePluginProcessGroups(dataInputStream, idsAndNames, idsAndNames);
 
-        DBG("All plugin descriptions restored successfully from binary file.");
+        instantiatePluginsAsync(idsAndNames, [onRestored]
+                                {
+                                    DBG("All plugin descriptions restored successfully from binary file.");
+                                    if (onRestored)
+                                        onRestored();
+                                });
     }
     else
     {
         DBG("Failed to open file for restoring plugin descriptions.");
+        if (onRestored)
+            onRestored();
     }
 }
 
-void PluginManager::upsertPluginDescriptionsFromFile(const juce::String &dataFilePath)
+void PluginManager::upsertPluginDescriptionsFromFile(const juce::String &dataFilePath, std::function<void()> onRestored)
 {
     // Restore plugin descriptions from binary file dataFilePath
     juce::File dataFile(dataFilePath);
@@ -2500,23 +4004,61 @@ void PluginManager::upsertPluginDescriptionsFromFile(const juce::String &dataFil
         int numPluginInstances = dataInputStream.readInt();
 
         // Iterate over each plugin instance and restore its description
+        std::vector<std::pair<juce::String, juce::String>> allIdsAndNames;
         for (int i = 0; i < numPluginInstances; ++i)
         {
             juce::String pluginId = dataInputStream.readString();
             juce::String name = dataInputStream.readString();
+            allIdsAndNames.emplace_back(pluginId, name);
+        }
 
-            // first check if the pluginId is not already in the pluginInstances map
-            if (pluginInstances.find(pluginId) == pluginInstances.end())
-            {
-                instantiatePluginByName(name, pluginId);
-            }
-
-            DBG("All plugin descriptions upserted successfully from binary file.");
+        // first check if the pluginId is not already in the pluginInstances map
+        std::vector<std::pair<juce::String, juce::String>> idsAndNames;
+        for (const auto &idAndName : allIdsAndNames)
+        {
+            if (!hasPluginInstance(idAndName.first))
+                idsAndNames.push_back(idAndName);
         }
+        restorePluginProcessGroups(dataInputStream, allIdsAndNames, idsAndNames);
+
+        instantiatePluginsAsync(idsAndNames, [onRestored]
+                                {
+                                    DBG("All plugin descriptions upserted successfully from binary file.");
+                                    if (onRestored)
+                                        onRestored();
+                                });
     }
     else
     {
         DBG("Failed to open file for restoring plugin descriptions.");
+        if (onRestored)
+            onRestored();
+    }
+}
+
+void PluginManager::restorePluginProcessGroups(juce::InputStream &input,
+                                               const std::vector<std::pair<juce::String, juce::String>> &savedIdsAndNames,
+                                               const std::vector<std::pair<juce::String, juce::String>> &idsAndNames)
+{
+    // One group per saved plugin, in the same order; files saved before groups were
+    // written end after the descriptions
+    std::map<juce::String, juce::String> savedGroups;
+    for (const auto &idAndName : savedIdsAndNames)
+    {
+        if (input.isExhausted())
+            break;
+        savedGroups[idAndName.first] = input.readString().trim();
+    }
+
+    // Only the plugins about to load take their saved group
+    const juce::ScopedLock pluginLock(pluginInstanceLock);
+    for (const auto &idAndName : idsAndNames)
+    {
+        auto saved = savedGroups.find(idAndName.first);
+        if (saved != savedGroups.end() && saved->second.isNotEmpty())
+            pluginProcessGroups[idAndName.first] = saved->second;
+        else
+            pluginProcessGroups.erase(idAndName.first);
     }
 }
 
@@ -2631,15 +4173,54 @@ void PluginManager::renamePluginInstance(const juce::String &oldId, const juce::
     const juce::ScopedLock pluginLock(pluginInstanceLock);
     if (pluginInstances.find(oldId) != pluginInstances.end())
     {
+        // An instance already registered under the new ID is replaced
+        releasePluginSlot(newId);
+        if (auto existing = pluginInstances.find(newId); existing != pluginInstances.end())
+            retirePluginInstance(std::move(existing->second));
+
         // Move the plugin instance to the new ID
         pluginInstances[newId] = std::move(pluginInstances[oldId]);
         pluginInstances.erase(oldId);
 
+        // The slot (and so its handle and priority) follows the instance under its new name
+        if (auto priority = pluginPriorities.find(oldId); priority != pluginPriorities.end())
+        {
+            pluginPriorities[newId] = priority->second;
+            pluginPriorities.erase(priority);
+        }
+        pluginProcessGroups.erase(newId);
+        if (auto processGroup = pluginProcessGroups.find(oldId); processGroup != pluginProcessGroups.end())
+        {
+            pluginProcessGroups[newId] = processGroup->second;
+            pluginProcessGroups.erase(processGroup);
+        }
+        for (auto &bus : busDefinitions)
+            std::replace(bus.inserts.begin(), bus.inserts.end(), oldId, newId);
+        for (auto &send : busSends)
+        {
+            if (send.pluginId == oldId)
+                send.pluginId = newId;
+        }
+        {
+            const juce::ScopedLock handleLock(pluginHandleLock);
+            if (auto it = pluginHandles.find(oldId); it != pluginHandles.end())
+            {
+                const int index = PluginHandles::slotIndexOf(it->second);
+                retiringSlots.push_back(std::move(slotObjects[(size_t)index]));
+                slotObjects[(size_t)index] = makePluginSlot(newId, pluginInstances[newId].get(), index, slotGenerations[(size_t)index]);
+                pluginHandles[newId] = it->second;
+                pluginHandles.erase(it);
+                notifyPluginHandlesChanged();
+            }
+        }
+        rebuildBusGraph(); // publishes the graph with inserts and sends under the new id
+
         // Update the plugin window mapping if necessary
         if (pluginWindows.find(oldId) != pluginWindows.end())
         {
             pluginWindows[newId] = std::move(pluginWindows[oldId]);
             pluginWindows.erase(oldId);
+            attachWindowKeepAwake(newId);
         }
 
         DBG("Plugin Instance ID renamed from " + oldId + " to " + newId);
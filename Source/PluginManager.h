@@ -4,6 +4,7 @@
 #include <deque>
 #include <map>
 #include <vector>
+#include <array>
 #include <atomic>
 #include <functional>
 
@@ -11,6 +12,17 @@
 #include "PluginWindow.h"
 #include "HostPlayHead.h"
 #include "AudioRouter.h"
+#include "RealtimeWorkerPool.h"
+#include "MidiIngestQueue.h"
+#include "MidiEventScheduler.h"
+#include "PluginHandle.h"
+#include "RcuDomain.h"
+#include "DspLoadHistogram.h"
+#include "CpuWatchdog.h"
+#include "BusGraph.h"
+#include "PluginLoader.h"
+#include "RemotePluginHost.h"
+#include "TempoMap.h"
 
 
 // Forward declaration
@@ -51,6 +63,26 @@ public:
     {
         juce::String pluginId;
         juce::String pluginName;
+        bool sleeping = false;            // skipped by the audio callback until its next event
+        juce::uint64 blocksProcessed = 0;
+        juce::uint64 blocksSlept = 0;     // since the plugin was loaded
+        DspLoadHistogram::Summary dspLoad;
+        int priority = CpuWatchdog::kDefaultPriority;
+        bool shed = false;                // skipped by the CPU watchdog until there is headroom
+    };
+    // processBlock time per plugin and for the whole callback, as a share of the buffer period;
+    // with an internal block size, the engine's time per internal block, as a share of its period
+    struct DspLoadReport
+    {
+        struct PluginLoad
+        {
+            juce::String pluginId;
+            DspLoadHistogram::Summary load;
+        };
+
+        DspLoadHistogram::Summary callback;
+        std::vector<PluginLoad> plugins;
+        int deviceXRuns = -1; // as reported by the driver, -1 if unknown
     };
     struct StemRule
     {
@@ -63,6 +95,13 @@ public:
         std::vector<StemRule> rules;
         bool renderEnabled = true;
     };
+    // Share of a plugin's output sent to a return bus, on top of its normal routing
+    struct BusSend
+    {
+        juce::String pluginId;
+        juce::String busName;
+        float level = 0.0f; // linear gain
+    };
     struct MasterBufferSummary
     {
         std::size_t totalEvents = 0;
@@ -91,13 +130,29 @@ public:
         }
     };
     PlayHeadImpl playHead;   // <--- keep one instance
-    PluginManager(MainComponent*, juce::CriticalSection&, juce::MidiBuffer&);
+    PluginManager(MainComponent*, juce::CriticalSection&);
     ~PluginManager() override;
 
     void prepareToPlay(int samplesPerBlockExpected, double sampleRate) override;
     void getNextAudioBlock(const juce::AudioSourceChannelInfo& bufferToFill) override;
     void releaseResources() override;
+    // Replaces the tempo map with this one tempo, keeping the opening time signature
     void setBpm(double bpm);
+    // Tempo and time signature changes over playback time. Plugins see them sample accurately,
+    // live and in renderMaster, and the map is saved with the master capture.
+    void setTempoMap(TempoMap map);
+    TempoMap getTempoMap() const;
+    static constexpr double kDefaultBpm = 125.0;
+    // Processes plugins and buses in blocks of numSamples, buffered to and from whatever the
+    // device asks for; 0 processes at the device's block size. Reopens the audio device.
+    void setInternalBlockSize(int numSamples);
+    int getInternalBlockSize() const { return internalBlockSize.load(); }
+    int getDeviceBlockSize() const { return deviceBlockSize; }
+    // Samples the engine runs ahead of the device, which live input and late MIDI wait out:
+    // one internal block, rendered while the device plays the one before it
+    int getInternalBlockLatencySamples() const;
+    static constexpr int kMinInternalBlockSize = 16;
+    static constexpr int kMaxInternalBlockSize = 8192;
     int playStartCounter = 0;
     static bool playStartIssued;
     static bool midiStartSent;
@@ -105,9 +160,20 @@ public:
     juce::PluginDescription getDescFromName(const juce::String& name);
 
     void instantiatePluginByName(const juce::String& name, const juce::String& pluginId);
+    // Replaces a loaded plugin without a gap: the new instance is created, prepared and
+    // pre-rolled with silence off the audio thread, then crossfaded in at a block boundary.
+    // Loads it as instantiatePluginByName does when nothing is loaded under the id yet. One
+    // replaced while a previous swap is still fading out waits for that fade to finish.
+    void replacePlugin(const juce::String& name, const juce::String& pluginId);
+    // Queues a plugin on pluginLoader and returns at once; the engine admits it as soon as it is
+    // prepared. An id that is already loaded keeps its instance. Message thread.
+    std::shared_future<PluginLoader::Result> instantiatePluginAsync(const juce::String& name, const juce::String& pluginId,
+                                                                    PluginLoader::FinishedFunction onFinished = {});
 
     juce::StringArray getPluginInstanceIds() const;
     std::vector<PluginInstanceInfo> getPluginInstanceInfos() const;
+    DspLoadReport getDspLoadReport() const;
+    void resetDspLoadStats();
 
     // Methods to manage plugins
     void instantiatePlugin(juce::PluginDescription* desc, const juce::String& pluginId);
@@ -117,8 +183,21 @@ public:
     void resetPlugin(const juce::String& pluginId);
     void resetAllPlugins();
 
+    // Message thread. Moves a plugin into the named worker process, or back into this one
+    // when group is empty, keeping its state; a plugin not loaded yet goes there when it is.
+    // False, with the plugin left where it was, if it could not be loaded in its new home.
+    // Groups are saved with the plugin descriptions and follow a renamed plugin.
+    bool setPluginProcessGroup(const juce::String& pluginId, const juce::String& group);
+    juce::String getPluginProcessGroup(const juce::String& pluginId) const;
+    std::map<juce::String, int> getProcessGroupSizes() const { return remotePluginHost.getGroupSizes(); }
+
     // Plugin management
     bool hasPluginInstance(const juce::String& pluginId);
+    // Handle for the plugin's slot, or kInvalidPluginHandle; stable until the plugin is reset
+    PluginHandle getPluginHandle(const juce::String& pluginId) const;
+    // Called on whichever thread issues, releases or renames a handle, with the handle table
+    // locked: keep it short and hand the work to the message thread
+    void setPluginHandlesChangedCallback(std::function<void()> callback);
     juce::KnownPluginList knownPluginList;
 	void listPluginInstances();
 	void savePluginData(const juce::String& dataFilePath, const juce:: String & filename, const juce::String& pluginId);
@@ -129,17 +208,42 @@ public:
 
     juce::String getPluginUniqueId(const juce::String& pluginId);
 
-    // Adds a tagged MIDI message to the taggedMidiBuffer
-	void addMidiMessage(const juce::MidiMessage& message, const juce::String& pluginId, juce::int64& timestamp);
-	void resetPlayback();
+    // Adds a tagged MIDI message to the producer's ingest lane; the audio thread moves it onto its timing wheel.
+    // timestampUs is microseconds since the last playback reset, 0 = play immediately.
+	void addMidiMessage(const juce::MidiMessage& message, const juce::String& pluginId, juce::int64& timestampUs,
+		MidiIngestSource source = MidiIngestSource::Osc);
+    // Same, for callers that already resolved the plugin's handle
+	void addMidiMessage(const juce::MidiMessage& message, const PluginTarget& target, juce::int64& timestampUs,
+		MidiIngestSource source = MidiIngestSource::Osc);
+    // Several at once, in one ingest operation: the audio thread schedules all of them or none.
+    // They are copied into the lane from the batch's own buffers, and made into MidiMessages
+    // only while capturing.
+	void addMidiMessages(const MidiEventBatch& batch, MidiIngestSource source = MidiIngestSource::Osc);
+    // Live MIDI input, played on the given plugin at the start of the next block
+    void addLiveInputMidi(const juce::MidiMessage& message, const juce::String& pluginId);
+    // Restarts the playback clock. The audio thread places sample zero at anchorHostMs
+    // (Time::getMillisecondCounterHiRes) rather than at whichever block happens to apply the reset.
+	void resetPlayback(double anchorHostMs = juce::Time::getMillisecondCounterHiRes());
+    // Upper bound on memory for pending future MIDI; takes effect on the next prepareToPlay
+    void setMidiSchedulerMemoryBudget(std::size_t bytes);
+    // Plugins silent past their tail stop being processed until an event is due for them
+    void setIdleSleepEnabled(bool shouldSleep);
+    bool isIdleSleepEnabled() const { return idleSleepEnabled.load(); }
+    // Keeps a plugin processing regardless of idle state, e.g. while its editor is open
+    void setPluginKeepAwake(const juce::String& pluginId, bool keepAwake);
+    // CPU watchdog priority, CpuWatchdog::kMinPriority (shed first) to kProtectedPriority (never shed)
+    void setPluginPriority(const juce::String& pluginId, int priority);
+    CpuWatchdog& getCpuWatchdog() { return cpuWatchdog; }
 
     void stopAllNotes();
 
     juce::int8 getNumInstances(std::vector<juce::String>& instances);
 
     void savePluginDescriptionsToFile(const juce::String& dataFilePath, std::vector<juce::String> instances = {});
-	void restorePluginDescriptionsFromFile(const juce::String& dataFilePath);
-	void upsertPluginDescriptionsFromFile(const juce::String& dataFilePath);
+	// Plugins load in parallel on pluginLoader; onRestored runs on the message thread once
+	// every one of them has been admitted or has failed
+	void restorePluginDescriptionsFromFile(const juce::String& dataFilePath, std::function<void()> onRestored = {});
+	void upsertPluginDescriptionsFromFile(const juce::String& dataFilePath, std::function<void()> onRestored = {});
 
 	// Methods to manage plugin state, save and restore
 	void scanPlugins(juce::FileSearchPath searchPath, bool replaceExisting = true);
@@ -197,13 +301,19 @@ public:
 
     AudioRouter& getAudioRouter() { return audioRouter; }
     const AudioRouter& getAudioRouter() const { return audioRouter; }
-    void logBusRmsIfNeeded(int numSamples);
     std::vector<StemConfig> getStemConfigs() const;
     void setStemConfigs(const std::vector<StemConfig>& configs);
     void rebuildRouterTagIndexFromConductor();
     std::vector<std::vector<int>> getStemRuleMatchCounts() const;
     bool saveRoutingConfigToFile(const juce::File& file) const;
     bool loadRoutingConfigFromFile(const juce::File& file);
+    // Bus graph: insert chains and outputs for stems, return buses and Master's inserts.
+    // A plugin used as an insert stops being played as an instrument.
+    std::vector<BusDefinition> getBusDefinitions() const;
+    void setBusDefinitions(const std::vector<BusDefinition>& definitions);
+    std::vector<BusSend> getBusSends() const;
+    // A level of 0 or below removes the send
+    void setBusSend(const juce::String& pluginId, const juce::String& busName, float level);
 
     // Update getter method to return inherited device manager
     juce::AudioDeviceManager& getDeviceManager() { return deviceManager; }
@@ -218,8 +328,117 @@ private:
     std::map<juce::String, std::unique_ptr<juce::AudioPluginInstance>> pluginInstances;
     std::map<juce::String, std::unique_ptr<PluginWindow>> pluginWindows;
 
-    // Chronologically sorted MIDI queue
-    std::deque<MyMidiMessage> taggedMidiBuffer;
+    // One plugin as the audio thread sees it. Identity fields never change once a slot is
+    // published: renaming or re-instantiating publishes a fresh slot at the same index.
+    struct PluginSlot
+    {
+        juce::AudioPluginInstance* instance = nullptr;
+        RemotePlugin* remote = nullptr;   // instance, when it runs in a worker process
+        juce::String pluginId;
+        juce::uint32 generation = 1;
+        int slotIndex = 0;
+        juce::MidiBuffer midi;            // this block's MIDI, reused every block
+        juce::AudioBuffer<float> audio;   // plugin output scratch, sized when prepared
+        double tailSeconds = 0.0;         // as reported when loaded; infinite never sleeps
+
+        // Idle tracking, audio thread only
+        int heldNotes = 0;
+        juce::uint16 sustainedChannels = 0; // bit per MIDI channel with the pedal down
+        juce::int64 samplesSinceEvent = 0;
+        juce::int64 silentSamples = 0;
+
+        // Written by the audio thread, read for reporting
+        std::atomic<bool> sleeping{ false };
+        std::atomic<bool> keepAwake{ false };
+        std::atomic<juce::uint64> blocksProcessed{ 0 };
+        std::atomic<juce::uint64> blocksSlept{ 0 };
+        DspLoadHistogram dspLoad;
+
+        // CPU watchdog state; flushOnRestore is audio thread only
+        std::atomic<int> priority{ CpuWatchdog::kDefaultPriority };
+        std::atomic<bool> shed{ false };
+        bool flushOnRestore = false;
+
+        // Hot swap: the instance being replaced runs beside this one, fading out, until the
+        // audio thread finishes the crossfade and clears it. fadingInstances owns it.
+        std::atomic<juce::AudioPluginInstance*> outgoing{ nullptr };
+        juce::AudioBuffer<float> outgoingAudio;
+        juce::MidiBuffer outgoingMidi;
+        int crossfadeSamples = 0;
+        int crossfadePosition = 0;        // audio thread only
+    };
+
+    // One entry per plugin for the current block: filled on the callback thread, processed
+    // by the worker pool, then mixed back in instance order.
+    struct PluginProcessJob
+    {
+        PluginSlot* slot = nullptr;
+        juce::AudioPluginInstance* instance = nullptr;
+        juce::MidiBuffer midi;
+        float outputPeak = 0.0f;
+        bool succeeded = false;
+    };
+
+    // Immutable version of the plugin graph, published atomically and read by the audio
+    // thread without locks. Only the scratch (slot buffers, jobs) is written, by the reader.
+    struct PluginGraph
+    {
+        std::vector<PluginSlot*> slotsByIndex; // handle slot index -> slot, nullptr when free
+        std::vector<PluginSlot*> active;       // processing order
+        std::vector<PluginProcessJob> jobs;    // one per active slot
+        std::vector<PluginSlot*> shedOrder;    // lowest priority first, for the CPU watchdog
+        std::vector<PluginSlot*> remote;       // slots running in worker processes, inserts included
+
+        // Bus graph in processing order, Master last. Insert slots are not in active.
+        struct BusNode
+        {
+            juce::String name;                  // AudioRouter bus
+            juce::String output;                // empty for Master
+            int busIndex = -1;                  // AudioRouter bus indices, resolved when published
+            int outputIndex = -1;               // -1 for Master
+            std::vector<PluginSlot*> inserts;
+            juce::AudioBuffer<float>* buffer = nullptr; // looked up by index at the start of each evaluation
+        };
+        std::vector<BusNode> buses;
+        std::vector<int> busLevelStarts;       // first node of each level, then buses.size()
+    };
+
+    // Writer side, guarded by pluginInstanceLock. The id -> handle map has its own lock so
+    // producers can resolve targets without contending with plugin loads.
+    std::vector<std::unique_ptr<PluginSlot>> slotObjects; // by slot index, null when free
+    std::vector<juce::uint32> slotGenerations;
+    std::vector<int> freePluginSlots;
+    std::vector<std::unique_ptr<PluginSlot>> retiringSlots;
+    std::vector<std::unique_ptr<juce::AudioPluginInstance>> retiringInstances;
+    std::vector<std::pair<juce::String, std::unique_ptr<juce::AudioPluginInstance>>> fadingInstances; // replaced, by plugin id
+    std::map<juce::String, juce::uint32> hotSwapTickets; // message thread only; latest replacePlugin per id
+    mutable juce::CriticalSection pluginHandleLock;
+    std::map<juce::String, PluginHandle> pluginHandles;
+    std::function<void()> pluginHandlesChangedCallback; // guarded by pluginHandleLock
+    std::map<juce::String, int> pluginPriorities; // guarded by pluginInstanceLock, outlives reloads
+    std::vector<BusDefinition> busDefinitions;    // guarded by pluginInstanceLock
+    std::vector<BusSend> busSends;
+    std::vector<BusGraph::Node> compiledBuses;
+
+    RcuDomain pluginGraphDomain;
+    RcuSnapshot<PluginGraph> pluginGraph{ pluginGraphDomain };
+    mutable juce::CriticalSection tempoMapLock; // serialises tempoMap writers
+    RcuSnapshot<TempoMap> tempoMap{ pluginGraphDomain };
+
+    // Producer lanes drained by the audio thread at the start of every block
+    MidiIngestQueue midiIngestQueue;
+    // Future MIDI keyed by playback sample, owned by the audio thread
+    MidiEventScheduler midiScheduler;
+    std::atomic<std::size_t> midiSchedulerBudgetBytes{ MidiEventScheduler::kDefaultMemoryBudgetBytes };
+    juce::uint64 appliedClearSequence = 0;
+    juce::uint64 appliedResetSequence = 0;
+    std::atomic<double> playbackAnchorHostMs{ 0.0 };
+    std::atomic<int> pendingMidiCount{ 0 };
+    std::atomic<bool> allNotesOffRequested{ false };
+    std::atomic<bool> idleSleepEnabled{ true };
+    DspLoadHistogram callbackLoad;
+    CpuWatchdog cpuWatchdog;
+    juce::MidiBuffer allNotesOffMessages;
     std::deque<MyMidiMessage> masterTaggedMidiBuffer;
     bool captureEnabled = false;
     double captureStartMs = -1.0;
@@ -234,19 +453,44 @@ private:
 
     // juce::AudioDeviceManager deviceManager;  // Remove this line
     juce::AudioPluginFormatManager formatManager;
-    AudioRouter audioRouter;
-    juce::int64 rmsDebugSamplesAccumulated = 0;
-    juce::int64 rmsDebugIntervalSamples = 0;
+    AudioRouter audioRouter{ pluginGraphDomain };
     std::vector<StemConfig> stemConfigs;
 
     juce::CriticalSection& midiCriticalSection;
-    juce::MidiBuffer& incomingMidi;
+
+    RealtimeWorkerPool workerPool;
+    std::unique_ptr<PluginLoader> pluginLoader; // reset first on destruction: its pool admits into this
+    RemotePluginHost remotePluginHost;
+    std::map<juce::String, juce::String> pluginProcessGroups; // plugin id -> worker process, guarded by pluginInstanceLock
+
+    // False, with any existing instance left in place, if the plugin fails to load
+    bool instantiatePluginIn(juce::PluginDescription* desc, const juce::String& pluginId, const juce::String& processGroup);
+    // Reads the groups written after the descriptions in a plugins file and assigns them to
+    // idsAndNames, the plugins about to load out of savedIdsAndNames
+    void restorePluginProcessGroups(juce::InputStream& input,
+                                    const std::vector<std::pair<juce::String, juce::String>>& savedIdsAndNames,
+                                    const std::vector<std::pair<juce::String, juce::String>>& idsAndNames);
+
+    juce::uint64 reportedAudioAllocations = 0;
 
     // playback counter
 	juce::int64 playbackSamplePosition = 0;
-    double currentBpm = 125.0; // Default BPM
     double currentSampleRate = 44100.0;
     int currentBlockSize = 0;
+    int liveOutputChannels = 2;
+    std::atomic<int> internalBlockSize{ 0 };   // requested; applied by prepareToPlay
+    int internalBlockSizeInUse = 0;            // 0: the engine runs at the device block size
+    int deviceBlockSize = 0;
+    // Internal blocks are rendered one ahead on their own thread: block n into internalOutputs[n & 1],
+    // once the callback has used up block n - 2, and handed out to the device in pieces
+    class InternalBlockThread;
+    std::array<juce::AudioBuffer<float>, 2> internalOutputs;
+    std::unique_ptr<InternalBlockThread> internalBlockThread;
+    std::atomic<juce::int64> requestedInternalBlocks{ 0 }; // audio thread -> renderer
+    std::atomic<juce::int64> renderedInternalBlocks{ 0 };  // renderer -> audio thread
+    juce::int64 playingInternalBlock = 0;      // audio thread
+    juce::int64 firstFreshInternalBlock = 0;   // audio thread; earlier blocks predate an offline render
+    int internalOutputPosition = 0;            // audio thread; internalBlockSizeInUse when used up
     juce::int64  totalSamplesProcessed{ 0 };
     MainComponent* mainComponent;
     double liveSampleRateBackup = 0.0;
@@ -264,9 +508,49 @@ private:
     void prepareAllPlugins(double sampleRate, int blockSize);
     void invokeOnMessageThreadBlocking(std::function<void()> fn);
     void notifyRenderProgress(float progress);
+    void ingestPendingMidi(int deviceOffset);
+    // Renderer thread: processes internal block blockIndex into its buffer
+    void renderInternalBlock(juce::int64 blockIndex);
+    void startInternalBlockThread();
+    void stopInternalBlockThread();
+    // Processes up to numSamples, stopping short of the next tempo change; returns how many it did
+    int processEngineBlock(PluginGraph& graph, juce::AudioBuffer<float>& output, int startSample, int numSamples,
+                           int deviceOffset);
+    std::unique_ptr<PluginSlot> makePluginSlot(const juce::String& pluginId, juce::AudioPluginInstance* instance,
+                                               int slotIndex, juce::uint32 generation) const;
+    PluginHandle assignPluginSlot(const juce::String& pluginId, juce::AudioPluginInstance* instance);
+    void releasePluginSlot(const juce::String& pluginId);
+    void notifyPluginHandlesChanged();
+    void retirePluginInstance(std::unique_ptr<juce::AudioPluginInstance> instance);
+    bool admitPluginInstance(const juce::String& pluginId, std::unique_ptr<juce::AudioPluginInstance>& instance);
+    void instantiatePluginsAsync(const std::vector<std::pair<juce::String, juce::String>>& idsAndNames,
+                                 std::function<void()> onAllFinished);
+    void completeHotSwap(const juce::String& pluginId, juce::uint32 ticket,
+                         std::unique_ptr<juce::AudioPluginInstance> instance);
+    void finishHotSwap(const juce::String& pluginId, int attempt);
+    static void captureOutgoingInput(PluginSlot& slot, juce::AudioPluginInstance& outgoing,
+                                     const juce::AudioBuffer<float>* input, const juce::MidiBuffer& midi, int numSamples);
+    static void mixOutgoing(PluginSlot& slot, juce::AudioPluginInstance& outgoing,
+                            juce::AudioBuffer<float>& output, int numSamples);
+    void publishPluginGraph();
+    static PluginSlot* resolvePluginSlot(const PluginGraph& graph, PluginHandle handle);
+    PluginSlot* findPluginSlotUnlocked(const juce::String& pluginId) const;
+    static void trackHeldNotes(PluginSlot& slot, const juce::MidiBuffer& midi);
+    void updateIdleState(PluginSlot& slot, float outputPeak, int numSamples);
+    void applyCpuWatchdog(const PluginGraph& graph, double loadPercent, double blockMs);
+    void rebuildBusGraph();
+    void processBusGraph(PluginGraph& graph, int numSamples, double budgetTicks);
+    static void processBusInserts(PluginGraph::BusNode& node, int numSamples, double budgetTicks);
+    static bool fillInsertInput(PluginSlot& slot, const PluginGraph::BusNode& node, int numSamples);
+    void attachWindowKeepAwake(const juce::String& pluginId);
+    void prepareScratchBuffers(int blockSize);
+    void reportAudioThreadAllocations();
+    juce::int64 samplePositionForTimestamp(juce::int64 timestampUs) const;
 
     void notifyRestoreStatus(const juce::String& message);
     void insertIntoMasterCaptureUnlocked(MyMidiMessage message);
+    // Caller holds midiCriticalSection and has checked captureEnabled
+    void captureMidiMessageUnlocked(const juce::MidiMessage& message, const juce::String& pluginId, juce::int64 timestampUs);
     void enrichPluginListWithTuids(juce::XmlElement* pluginListXml);
 
     // TUID cache for VST3 plugins - maps plugin filepath to TUID
@@ -36,3 +36,10 @@ void PluginWindow::closeButtonPressed()
 {
 	PluginWindow::setVisible(false);
 }
+
+void PluginWindow::visibilityChanged()
+{
+	juce::DocumentWindow::visibilityChanged();
+	if (onVisibilityChanged)
+		onVisibilityChanged(isVisible());
+}
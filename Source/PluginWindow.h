@@ -18,6 +18,10 @@ public:
 	~PluginWindow();
 
 	void closeButtonPressed() override;
+	void visibilityChanged() override;
+
+	// Called with the new state whenever the window is shown or hidden
+	std::function<void(bool)> onVisibilityChanged;
 
 private:
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginWindow)
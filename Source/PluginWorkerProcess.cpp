@@ -0,0 +1,206 @@
+#include "PluginWorkerProcess.h"
+
+namespace
+{
+    constexpr int kBlockWaitMs = 100;   // how often an idle slot thread checks whether to stop
+    constexpr int kStopTimeoutMs = 2000;
+}
+
+// Processes one plugin's blocks as they arrive on the transport
+class PluginWorkerProcess::SlotRunner : public juce::Thread
+{
+public:
+    SlotRunner(SharedAudioTransport& transportToUse, int slotIndex, std::unique_ptr<juce::AudioPluginInstance> pluginInstance)
+        : juce::Thread("Plugin worker slot " + juce::String(slotIndex)),
+          transport(transportToUse),
+          slot(slotIndex),
+          instance(std::move(pluginInstance))
+    {
+        midi.ensureSize(SharedAudioTransport::kMidiRingSize * 8);
+    }
+
+    ~SlotRunner() override
+    {
+        stopThread(kStopTimeoutMs);
+    }
+
+    juce::AudioPluginInstance& getInstance() { return *instance; }
+
+    void run() override
+    {
+        const int numChannels = juce::jmax(1, instance->getTotalNumInputChannels(), instance->getTotalNumOutputChannels());
+        juce::AudioBuffer<float> audio;
+        while (!threadShouldExit())
+        {
+            juce::uint32 sequence = 0;
+            if (!transport.waitForBlock(slot, sequence, kBlockWaitMs))
+                continue;
+
+            transport.readBlock(slot, numChannels, audio, midi);
+            try
+            {
+                instance->processBlock(audio, midi);
+            }
+            catch (...)
+            {
+                DBG("Plugin worker: exception processing slot " << slot);
+                audio.clear();
+            }
+            transport.finishBlock(slot, sequence);
+        }
+    }
+
+private:
+    SharedAudioTransport& transport;
+    const int slot;
+    std::unique_ptr<juce::AudioPluginInstance> instance;
+    juce::MidiBuffer midi;
+};
+
+PluginWorkerProcess::PluginWorkerProcess()
+{
+    formatManager.addFormat(new juce::VST3PluginFormat());
+}
+
+PluginWorkerProcess::~PluginWorkerProcess()
+{
+    for (auto& runner : runners)
+        runner.reset();
+}
+
+bool PluginWorkerProcess::isWorkerCommandLine(const juce::String& commandLine)
+{
+    return commandLine.contains(PluginWorkerProtocol::kProcessUid);
+}
+
+void PluginWorkerProcess::handleConnectionMade()
+{
+    DBG("Plugin worker: connected to the engine");
+}
+
+void PluginWorkerProcess::handleConnectionLost()
+{
+    // The engine has gone, or stopped answering pings
+    juce::MessageManager::callAsync([] { juce::JUCEApplicationBase::quit(); });
+}
+
+void PluginWorkerProcess::handleMessageFromCoordinator(const juce::MemoryBlock& message)
+{
+    // Connection thread; plugins are created and torn down on the message thread
+    juce::MessageManager::callAsync([this, message] { handleRequest(message); });
+}
+
+void PluginWorkerProcess::handleRequest(const juce::MemoryBlock& message)
+{
+    using namespace PluginWorkerProtocol;
+
+    juce::MemoryInputStream args(message, false);
+    const int requestId = args.readInt();
+    const int command = args.readInt();
+
+    juce::MemoryOutputStream payload;
+    juce::String error;
+    bool ok = false;
+
+    if (command == attach)
+    {
+        transport = SharedAudioTransport::open(juce::File(args.readString()));
+        ok = transport != nullptr && transport->getNumSlots() >= kMaxPlugins;
+        if (!ok)
+            error = "cannot open the transport";
+    }
+    else
+    {
+        const int slot = args.readInt();
+        if (transport == nullptr || slot < 0 || slot >= kMaxPlugins)
+        {
+            error = "bad slot " + juce::String(slot);
+        }
+        else if (command == load)
+        {
+            ok = loadPlugin(slot, args, payload, error);
+        }
+        else if (runners[(size_t) slot] == nullptr)
+        {
+            error = "nothing loaded in slot " + juce::String(slot);
+        }
+        else if (command == prepare)
+        {
+            const double sampleRate = args.readDouble();
+            const int blockSize = args.readInt();
+            auto& runner = *runners[(size_t) slot];
+            runner.stopThread(kStopTimeoutMs);
+            runner.getInstance().prepareToPlay(sampleRate, blockSize);
+            runner.startThread(juce::Thread::Priority::highest);
+            ok = true;
+        }
+        else if (command == release)
+        {
+            runners[(size_t) slot].reset();
+            ok = true;
+        }
+        else if (command == getState)
+        {
+            juce::MemoryBlock state;
+            runners[(size_t) slot]->getInstance().getStateInformation(state);
+            payload.writeInt64((juce::int64) state.getSize());
+            payload.write(state.getData(), state.getSize());
+            ok = true;
+        }
+        else if (command == setState)
+        {
+            juce::MemoryBlock state;
+            args.readIntoMemoryBlock(state, args.readInt64());
+            runners[(size_t) slot]->getInstance().setStateInformation(state.getData(), (int) state.getSize());
+            ok = true;
+        }
+        else
+        {
+            error = "unknown command " + juce::String(command);
+        }
+    }
+
+    juce::MemoryOutputStream reply;
+    reply.writeInt(requestId);
+    reply.writeBool(ok);
+    reply.writeString(error);
+    reply.write(payload.getData(), payload.getDataSize());
+    sendMessageToCoordinator(reply.getMemoryBlock());
+}
+
+bool PluginWorkerProcess::loadPlugin(int slot, juce::MemoryInputStream& args, juce::MemoryOutputStream& reply,
+                                     juce::String& error)
+{
+    const auto descriptionXml = juce::parseXML(args.readString());
+    const double sampleRate = args.readDouble();
+    const int blockSize = args.readInt();
+
+    juce::PluginDescription description;
+    if (descriptionXml == nullptr || !description.loadFromXml(*descriptionXml))
+    {
+        error = "bad plugin description";
+        return false;
+    }
+
+    runners[(size_t) slot].reset();
+    auto instance = formatManager.createPluginInstance(description, sampleRate, blockSize, error);
+    if (instance == nullptr)
+        return false;
+
+    const int numChannels = juce::jmax(instance->getTotalNumInputChannels(), instance->getTotalNumOutputChannels());
+    if (numChannels > transport->getMaxChannels())
+    {
+        error = "needs more channels than the transport carries";
+        return false;
+    }
+
+    instance->prepareToPlay(sampleRate, blockSize);
+    reply.writeInt(instance->getTotalNumInputChannels());
+    reply.writeInt(instance->getTotalNumOutputChannels());
+    reply.writeDouble(instance->getTailLengthSeconds());
+    reply.writeBool(instance->acceptsMidi());
+
+    runners[(size_t) slot] = std::make_unique<SlotRunner>(*transport, slot, std::move(instance));
+    runners[(size_t) slot]->startThread(juce::Thread::Priority::highest);
+    return true;
+}
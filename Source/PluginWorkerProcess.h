@@ -0,0 +1,54 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <memory>
+#include "SharedAudioTransport.h"
+
+// Requests the engine sends a plugin worker process, and the worker side itself. Every
+// request starts with an id and a command and is answered with the same id, a success flag,
+// an error string and the command's payload.
+namespace PluginWorkerProtocol
+{
+    constexpr const char* kProcessUid = "oscdawPluginWorker";
+    constexpr int kMaxPlugins = 16;     // slots per worker process
+
+    enum Command
+    {
+        attach = 1,     // transport file path
+        load,           // slot, description XML, sample rate, block size -> inputs, outputs, tail seconds, accepts MIDI
+        prepare,        // slot, sample rate, block size
+        release,        // slot
+        getState,       // slot -> state
+        setState        // slot, state
+    };
+}
+
+// Runs in a child process started by PluginProcessGroup (see RemotePluginHost). Plugins are
+// created on this process's message thread; each then gets a thread of its own that waits
+// for blocks on the shared transport and processes them in place.
+class PluginWorkerProcess : public juce::ChildProcessWorker
+{
+public:
+    PluginWorkerProcess();
+    ~PluginWorkerProcess() override;
+
+    static bool isWorkerCommandLine(const juce::String& commandLine);
+
+    void handleMessageFromCoordinator(const juce::MemoryBlock& message) override;
+    void handleConnectionMade() override;
+    void handleConnectionLost() override;
+
+private:
+    class SlotRunner;
+
+    // Message thread
+    void handleRequest(const juce::MemoryBlock& message);
+    bool loadPlugin(int slot, juce::MemoryInputStream& args, juce::MemoryOutputStream& reply, juce::String& error);
+
+    juce::AudioPluginFormatManager formatManager;
+    std::unique_ptr<SharedAudioTransport> transport;
+    std::array<std::unique_ptr<SlotRunner>, PluginWorkerProtocol::kMaxPlugins> runners;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginWorkerProcess)
+};
@@ -0,0 +1,170 @@
+#include "RcuDomain.h"
+#include <thread>
+
+namespace
+{
+    constexpr int kReclaimIntervalMs = 100;
+}
+
+class RcuDomain::Reclaimer : public juce::Thread
+{
+public:
+    explicit Reclaimer(RcuDomain& ownerRef)
+        : juce::Thread("RCU reclaimer"),
+          owner(ownerRef)
+    {
+    }
+
+    ~Reclaimer() override
+    {
+        signalThreadShouldExit();
+        notify();
+        stopThread(2000);
+    }
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            wait(kReclaimIntervalMs);
+            if (!threadShouldExit())
+                owner.reclaimExpired();
+        }
+    }
+
+private:
+    RcuDomain& owner;
+};
+
+RcuDomain::RcuDomain()
+{
+    reclaimer = std::make_unique<Reclaimer>(*this);
+    reclaimer->startThread(juce::Thread::Priority::low);
+}
+
+RcuDomain::~RcuDomain()
+{
+    reclaimer.reset();
+    reclaimAll();
+}
+
+RcuDomain::ReadScope::ReadScope(RcuDomain& domainToRead)
+    : domain(domainToRead)
+{
+    // Claim a free reader slot, then pin the current epoch before the caller loads any pointer
+    for (;;)
+    {
+        for (int i = 0; i < kMaxConcurrentReaders; ++i)
+        {
+            auto& slot = domain.readers[(size_t) i];
+            bool expected = false;
+            if (!slot.inUse.load(std::memory_order_relaxed)
+                && slot.inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            {
+                readerIndex = i;
+                slot.epoch.store(domain.globalEpoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+                return;
+            }
+        }
+
+        // More simultaneous readers than slots; only a misconfiguration gets here
+        jassertfalse;
+        std::this_thread::yield();
+    }
+}
+
+RcuDomain::ReadScope::~ReadScope()
+{
+    auto& slot = domain.readers[(size_t) readerIndex];
+    slot.epoch.store(0, std::memory_order_seq_cst);
+    slot.inUse.store(false, std::memory_order_release);
+}
+
+juce::uint64 RcuDomain::advanceEpoch()
+{
+    return globalEpoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+}
+
+bool RcuDomain::isGracePeriodOver(juce::uint64 retireEpoch) const
+{
+    // A reader that pinned an older epoch may still hold a pointer published before retireEpoch
+    for (const auto& slot : readers)
+    {
+        const auto pinned = slot.epoch.load(std::memory_order_seq_cst);
+        if (pinned != 0 && pinned < retireEpoch)
+            return false;
+    }
+    return true;
+}
+
+void RcuDomain::retire(std::function<void()> reclaim)
+{
+    const auto epoch = advanceEpoch();
+
+    const juce::ScopedLock sl(retiredLock);
+    retired.push_back({ epoch, std::move(reclaim) });
+}
+
+void RcuDomain::synchronize()
+{
+    const auto epoch = advanceEpoch();
+    while (!isGracePeriodOver(epoch))
+        juce::Thread::sleep(1);
+}
+
+void RcuDomain::reclaimExpired()
+{
+    std::vector<Retired> expired;
+    {
+        const juce::ScopedLock sl(retiredLock);
+        for (auto it = retired.begin(); it != retired.end();)
+        {
+            if (isGracePeriodOver(it->epoch))
+            {
+                expired.push_back(std::move(*it));
+                it = retired.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    // Run outside the lock: a reclaim may itself publish or retire
+    for (auto& item : expired)
+    {
+        try
+        {
+            item.reclaim();
+        }
+        catch (const std::exception& e)
+        {
+            DBG("RcuDomain: exception while reclaiming: " << e.what());
+        }
+        catch (...)
+        {
+            DBG("RcuDomain: unknown exception while reclaiming");
+        }
+    }
+}
+
+void RcuDomain::reclaimAll()
+{
+    for (;;)
+    {
+        // Reclaims may retire more, so repeat until nothing is left
+        synchronize();
+        reclaimExpired();
+
+        const juce::ScopedLock sl(retiredLock);
+        if (retired.empty())
+            return;
+    }
+}
+
+int RcuDomain::getNumPendingReclaims() const
+{
+    const juce::ScopedLock sl(retiredLock);
+    return (int) retired.size();
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Epoch-based read-copy-update for state the audio thread reads without locks. A reader
+// pins the current epoch for the length of a ReadScope; a writer publishes a new version and
+// retires the old one, and a background thread reclaims it once every reader that could
+// still be looking at it has left. Readers never block, allocate or take a lock.
+class RcuDomain
+{
+public:
+    static constexpr int kMaxConcurrentReaders = 16;
+
+    RcuDomain();
+    ~RcuDomain();
+
+    // Realtime safe. Not reentrant on the same thread.
+    class ReadScope
+    {
+    public:
+        explicit ReadScope(RcuDomain& domainToRead);
+        ~ReadScope();
+
+    private:
+        RcuDomain& domain;
+        int readerIndex = -1;
+
+        JUCE_DECLARE_NON_COPYABLE(ReadScope)
+    };
+
+    // Writer side, any non-realtime thread: reclaim runs on the background thread once the
+    // grace period for everything published before this call has passed
+    void retire(std::function<void()> reclaim);
+
+    // Blocks until every reader that was inside a ReadScope when this was called has left it
+    void synchronize();
+
+    // Waits for readers and runs every pending reclaim on the calling thread; for shutdown
+    void reclaimAll();
+
+    int getNumPendingReclaims() const;
+
+private:
+    class Reclaimer;
+
+    struct alignas(64) ReaderSlot
+    {
+        std::atomic<bool> inUse{ false };
+        std::atomic<juce::uint64> epoch{ 0 }; // 0 = not reading
+    };
+
+    struct Retired
+    {
+        juce::uint64 epoch = 0;
+        std::function<void()> reclaim;
+    };
+
+    juce::uint64 advanceEpoch();
+    bool isGracePeriodOver(juce::uint64 retireEpoch) const;
+    void reclaimExpired();
+
+    std::atomic<juce::uint64> globalEpoch{ 1 };
+    std::array<ReaderSlot, kMaxConcurrentReaders> readers;
+    mutable juce::CriticalSection retiredLock;
+    std::vector<Retired> retired;
+    std::unique_ptr<Reclaimer> reclaimer;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RcuDomain)
+};
+
+// Atomically published pointer to a version of T, read inside an RcuDomain::ReadScope.
+// Writers must be serialised by the caller.
+template <typename T>
+class RcuSnapshot
+{
+public:
+    explicit RcuSnapshot(RcuDomain& domainToUse) : domain(domainToUse) {}
+
+    // The owner guarantees no reader is left by the time this runs
+    ~RcuSnapshot() { delete current.load(); }
+
+    // Reader side (inside a ReadScope), or a writer holding its own serialising lock
+    T* get() const { return current.load(std::memory_order_seq_cst); }
+
+    // Swaps in the next version; the old one (and anything in alsoReclaim) is released after
+    // the grace period
+    void publish(std::unique_ptr<T> next, std::function<void()> alsoReclaim = {})
+    {
+        T* previous = current.exchange(next.release(), std::memory_order_seq_cst);
+        domain.retire([previous, extra = std::move(alsoReclaim)]
+                      {
+                          delete previous;
+                          if (extra)
+                              extra();
+                      });
+    }
+
+private:
+    RcuDomain& domain;
+    std::atomic<T*> current{ nullptr };
+
+    JUCE_DECLARE_NON_COPYABLE(RcuSnapshot)
+};
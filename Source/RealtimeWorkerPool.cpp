@@ -0,0 +1,246 @@
+#include "RealtimeWorkerPool.h"
+#include <thread>
+
+#if JUCE_INTEL
+ #include <emmintrin.h>
+#endif
+
+namespace
+{
+    constexpr int kMaxWorkers = 31;
+    constexpr int kIdleSpinIterations = 4096;
+    constexpr int kIdleWaitMs = 50;
+
+    inline void spinPause()
+    {
+       #if JUCE_INTEL
+        _mm_pause();
+       #else
+        std::this_thread::yield();
+       #endif
+    }
+}
+
+class RealtimeWorkerPool::Worker : public juce::Thread
+{
+public:
+    Worker(RealtimeWorkerPool& ownerRef, int index)
+        : juce::Thread("Audio worker " + juce::String(index)),
+          owner(ownerRef),
+          participantIndex(index)
+    {
+    }
+
+    ~Worker() override
+    {
+        shutdown();
+    }
+
+    void wake()
+    {
+        if (sleeping.exchange(false))
+            wakeEvent.signal();
+    }
+
+    void shutdown()
+    {
+        signalThreadShouldExit();
+        wakeEvent.signal();
+        stopThread(2000);
+    }
+
+    void run() override
+    {
+        juce::uint32 lastSeen = owner.generation.load();
+
+        while (!threadShouldExit())
+        {
+            if (!waitForNewGeneration(lastSeen))
+                continue;
+
+            // Register before re-reading the generation so the caller cannot rewrite the job
+            // ranges underneath us (it closes the generation and waits for activeWorkers == 0).
+            owner.activeWorkers.fetch_add(1);
+            const auto current = owner.generation.load();
+            if ((current & 1u) == 0 && current != lastSeen)
+            {
+                lastSeen = current;
+                owner.participate(participantIndex);
+            }
+            owner.activeWorkers.fetch_sub(1);
+        }
+    }
+
+private:
+    bool hasNewGeneration(juce::uint32 lastSeen) const
+    {
+        const auto current = owner.generation.load();
+        return (current & 1u) == 0 && current != lastSeen;
+    }
+
+    bool waitForNewGeneration(juce::uint32 lastSeen)
+    {
+        for (int i = 0; i < kIdleSpinIterations; ++i)
+        {
+            if (hasNewGeneration(lastSeen))
+                return true;
+            spinPause();
+        }
+
+        sleeping.store(true);
+        if (!hasNewGeneration(lastSeen) && !threadShouldExit())
+            wakeEvent.wait(kIdleWaitMs);
+        sleeping.store(false);
+
+        return hasNewGeneration(lastSeen);
+    }
+
+    RealtimeWorkerPool& owner;
+    const int participantIndex;
+    juce::WaitableEvent wakeEvent;
+    std::atomic<bool> sleeping{ false };
+};
+
+RealtimeWorkerPool::RealtimeWorkerPool(int numWorkers)
+    : requestedWorkers(numWorkers)
+{
+}
+
+RealtimeWorkerPool::~RealtimeWorkerPool()
+{
+    stop();
+}
+
+void RealtimeWorkerPool::start(double sampleRate, int blockSize)
+{
+    stop();
+
+    const int numCpus = juce::SystemStats::getNumCpus();
+    const int numWorkers = juce::jlimit(0, kMaxWorkers, requestedWorkers >= 0 ? requestedWorkers : numCpus - 1);
+
+    numParticipants = numWorkers + 1;
+    ranges = std::make_unique<JobRange[]>((size_t) numParticipants);
+
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        // Participant 0 is the audio callback thread itself
+        auto worker = std::make_unique<Worker>(*this, i + 1);
+
+        if (numCpus > 1 && numCpus <= 32)
+            worker->setAffinityMask(1u << (juce::uint32) ((i + 1) % numCpus));
+
+        auto options = juce::Thread::RealtimeOptions{}.withPriority(10);
+        if (sampleRate > 0.0 && blockSize > 0)
+            options = options.withApproximateAudioProcessingTime(blockSize, sampleRate);
+
+        if (!worker->startRealtimeThread(options))
+        {
+            DBG("RealtimeWorkerPool: realtime priority unavailable, starting worker " << (i + 1) << " at highest priority");
+            worker->startThread(juce::Thread::Priority::highest);
+        }
+
+        workers.push_back(std::move(worker));
+    }
+
+    startedWorkers.store(numWorkers, std::memory_order_release);
+    running.store(true, std::memory_order_release);
+    DBG("RealtimeWorkerPool: started " << numWorkers << " worker(s)");
+}
+
+void RealtimeWorkerPool::stop()
+{
+    running.store(false, std::memory_order_release);
+    startedWorkers.store(0, std::memory_order_release);
+
+    // Wait for any in-flight run() to finish before tearing the workers down
+    while (busy.exchange(true))
+        std::this_thread::yield();
+
+    for (auto& worker : workers)
+        worker->shutdown();
+    workers.clear();
+    numParticipants = 1;
+
+    busy.store(false);
+}
+
+void RealtimeWorkerPool::runJobs(int numJobs, JobFunction function, void* context)
+{
+    if (numJobs <= 0)
+        return;
+
+    // The worker count is read once busy is held: stop() clears it and then waits for busy, so
+    // the workers cannot be torn down between the check and the wake below
+    const bool claimed = numJobs > 1 && !busy.exchange(true);
+    const int numWorkers = claimed ? startedWorkers.load(std::memory_order_acquire) : 0;
+    if (numWorkers == 0)
+    {
+        if (claimed)
+            busy.store(false, std::memory_order_release);
+
+        for (int i = 0; i < numJobs; ++i)
+            function(context, i);
+        return;
+    }
+
+    // Close the current generation (odd) and wait for stragglers from the previous run
+    // to leave before the shared job state is rewritten.
+    const auto closed = generation.load() + 1u;
+    generation.store(closed);
+    while (activeWorkers.load() != 0)
+        spinPause();
+
+    currentFunction = function;
+    currentContext = context;
+    jobsRemaining.store(numJobs);
+
+    // Contiguous slice per participant; idle participants steal from the others
+    const int baseCount = numJobs / numParticipants;
+    const int extra = numJobs % numParticipants;
+    int start = 0;
+    for (int p = 0; p < numParticipants; ++p)
+    {
+        const int count = baseCount + (p < extra ? 1 : 0);
+        ranges[(size_t) p].next.store(start, std::memory_order_relaxed);
+        ranges[(size_t) p].end = start + count;
+        start += count;
+    }
+
+    generation.store(closed + 1);
+    for (int i = 0; i < numWorkers; ++i)
+        workers[(size_t) i]->wake();
+
+    participate(0);
+
+    while (jobsRemaining.load(std::memory_order_acquire) != 0)
+        spinPause();
+
+    busy.store(false, std::memory_order_release);
+}
+
+void RealtimeWorkerPool::participate(int participantIndex)
+{
+    // Own slice first, then walk the other slices looking for unclaimed jobs
+    for (int i = 0; i < numParticipants; ++i)
+    {
+        const int rangeIndex = (participantIndex + i) % numParticipants;
+        while (tryRunJob(rangeIndex))
+        {
+        }
+    }
+}
+
+bool RealtimeWorkerPool::tryRunJob(int rangeIndex)
+{
+    auto& range = ranges[(size_t) rangeIndex];
+    if (range.next.load(std::memory_order_relaxed) >= range.end)
+        return false;
+
+    const int jobIndex = range.next.fetch_add(1, std::memory_order_acq_rel);
+    if (jobIndex >= range.end)
+        return false;
+
+    currentFunction(currentContext, jobIndex);
+    jobsRemaining.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Fixed set of realtime worker threads that share the jobs of a single audio block.
+// run() is called from the audio callback: it hands out job indices through per-participant
+// ranges that idle participants steal from, takes part itself and returns once every job
+// has finished. Nothing is allocated or locked on the calling thread.
+class RealtimeWorkerPool
+{
+public:
+    // numWorkers < 0 picks one worker per remaining CPU core
+    explicit RealtimeWorkerPool(int numWorkers = -1);
+    ~RealtimeWorkerPool();
+
+    // Message thread: (re)start the workers with a period hint matching the device callback
+    void start(double sampleRate, int blockSize);
+    void stop();
+
+    int getNumWorkers() const { return startedWorkers.load(std::memory_order_acquire); }
+    bool isRunning() const { return running.load(std::memory_order_acquire); }
+
+    // Calls fn(jobIndex) once for every index in [0, numJobs). Falls back to running on the
+    // calling thread if the pool is stopped or already busy with another caller.
+    template <typename Fn>
+    void run(int numJobs, Fn& fn)
+    {
+        runJobs(numJobs,
+                [](void* context, int jobIndex) { (*static_cast<Fn*>(context))(jobIndex); },
+                static_cast<void*>(std::addressof(fn)));
+    }
+
+private:
+    using JobFunction = void (*)(void* context, int jobIndex);
+
+    class Worker;
+
+    struct alignas(64) JobRange
+    {
+        std::atomic<int> next{ 0 };
+        int end = 0;
+    };
+
+    void runJobs(int numJobs, JobFunction function, void* context);
+    void participate(int participantIndex);
+    bool tryRunJob(int rangeIndex);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::unique_ptr<JobRange[]> ranges;
+    int numParticipants = 1;
+    int requestedWorkers = -1;
+
+    JobFunction currentFunction = nullptr;
+    void* currentContext = nullptr;
+
+    alignas(64) std::atomic<juce::uint32> generation{ 0 };
+    alignas(64) std::atomic<int> jobsRemaining{ 0 };
+    alignas(64) std::atomic<int> activeWorkers{ 0 };
+    std::atomic<bool> busy{ false };
+    std::atomic<bool> running{ false };
+    // Set once every worker thread exists, cleared before they are torn down. run() reads this,
+    // never the workers vector's size, so start() can build the vector while callbacks run.
+    std::atomic<int> startedWorkers{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RealtimeWorkerPool)
+};
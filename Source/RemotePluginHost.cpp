@@ -0,0 +1,522 @@
+#include "RemotePluginHost.h"
+#include "PluginWorkerProcess.h"
+#include "SharedAudioTransport.h"
+#include <algorithm>
+#include <array>
+#include <utility>
+
+namespace
+{
+    constexpr int kTransportChannels = 32;
+    constexpr int kTransportBlockSize = 4096;
+    constexpr int kRequestTimeoutMs = 5000;
+    constexpr int kLoadTimeoutMs = 60000;   // big sample libraries take a while
+}
+
+// One worker process and its transport. Requests block the calling thread until the worker
+// answers; answers arrive on the connection thread.
+class PluginProcessGroup : private juce::ChildProcessCoordinator
+{
+public:
+    explicit PluginProcessGroup(const juce::String& groupName) : name(groupName) {}
+
+    ~PluginProcessGroup() override
+    {
+        killWorkerProcess();
+        transport.reset();
+        transportFile.deleteFile();
+    }
+
+    bool start(juce::String& error)
+    {
+        transportFile = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                            .getNonexistentChildFile("oscdaw-" + juce::File::createLegalFileName(name), ".shm");
+        transport = SharedAudioTransport::create(transportFile, PluginWorkerProtocol::kMaxPlugins,
+                                                 kTransportChannels, kTransportBlockSize);
+        if (transport == nullptr)
+        {
+            error = "cannot create the shared memory transport";
+            return false;
+        }
+
+        const auto executable = juce::File::getSpecialLocation(juce::File::currentExecutableFile);
+        if (!launchWorkerProcess(executable, PluginWorkerProtocol::kProcessUid, 0, 0))
+        {
+            error = "cannot launch a worker process";
+            return false;
+        }
+
+        running = true;
+        juce::MemoryBlock reply;
+        return request(PluginWorkerProtocol::attach,
+                       [this](juce::MemoryOutputStream& args) { args.writeString(transportFile.getFullPathName()); },
+                       reply, error, kRequestTimeoutMs);
+    }
+
+    // Any thread. Starts the worker on the first call; later callers wait for that start and share its outcome.
+    bool ensureStarted(juce::String& error)
+    {
+        const juce::ScopedLock sl(startLock);
+        if (!startFinished.load())
+        {
+            if (!start(startError))
+            {
+                DBG("Plugin worker process " << name << " did not start: " << startError);
+                running = false;
+            }
+            startFinished = true;
+        }
+
+        if (!isRunning())
+        {
+            error = startError.isNotEmpty() ? startError : "worker process " + name + " is not running";
+            return false;
+        }
+        return true;
+    }
+
+    // Done starting, and not running: the start failed or the worker has gone since
+    bool hasStopped() const { return startFinished.load() && !isRunning(); }
+
+    bool isRunning() const { return running.load(); }
+    const juce::String& getName() const { return name; }
+    SharedAudioTransport& getTransport() { return *transport; }
+
+    int allocateSlot()
+    {
+        const juce::ScopedLock sl(slotLock);
+        for (int slot = 0; slot < PluginWorkerProtocol::kMaxPlugins; ++slot)
+        {
+            if (!slotsInUse[(size_t) slot])
+            {
+                slotsInUse[(size_t) slot] = true;
+                return slot;
+            }
+        }
+        return -1;
+    }
+
+    void freeSlot(int slot)
+    {
+        juce::MemoryBlock reply;
+        juce::String error;
+        if (isRunning())
+            request(PluginWorkerProtocol::release, [slot](juce::MemoryOutputStream& args) { args.writeInt(slot); },
+                    reply, error, kRequestTimeoutMs);
+
+        const juce::ScopedLock sl(slotLock);
+        slotsInUse[(size_t) slot] = false;
+    }
+
+    int getNumPlugins() const
+    {
+        const juce::ScopedLock sl(slotLock);
+        return (int) std::count(slotsInUse.begin(), slotsInUse.end(), true);
+    }
+
+    // Any thread but the connection's. On success reply is positioned at the payload.
+    bool request(PluginWorkerProtocol::Command command, const std::function<void(juce::MemoryOutputStream&)>& writeArgs,
+                 juce::MemoryBlock& reply, juce::String& error, int timeoutMs)
+    {
+        if (!isRunning())
+        {
+            error = "worker process " + name + " is not running";
+            return false;
+        }
+
+        auto pending = std::make_shared<PendingReply>();
+        int requestId;
+        {
+            const juce::ScopedLock sl(requestLock);
+            requestId = ++lastRequestId;
+            pendingReplies[requestId] = pending;
+        }
+
+        juce::MemoryOutputStream message;
+        message.writeInt(requestId);
+        message.writeInt(command);
+        if (writeArgs)
+            writeArgs(message);
+
+        const bool sent = sendMessageToWorker(message.getMemoryBlock());
+        const bool answered = sent && pending->done.wait(timeoutMs) && pending->answered;
+        {
+            const juce::ScopedLock sl(requestLock);
+            pendingReplies.erase(requestId);
+        }
+
+        if (!answered)
+        {
+            error = "worker process " + name + " did not answer";
+            return false;
+        }
+
+        juce::MemoryInputStream in(pending->message, false);
+        in.readInt();
+        const bool ok = in.readBool();
+        error = in.readString();
+        reply.setSize(0);
+        reply.append(static_cast<const char*>(pending->message.getData()) + in.getPosition(),
+                     pending->message.getSize() - (size_t) in.getPosition());
+        return ok;
+    }
+
+private:
+    struct PendingReply
+    {
+        juce::WaitableEvent done;
+        juce::MemoryBlock message;
+        bool answered = false;
+    };
+
+    void handleMessageFromWorker(const juce::MemoryBlock& message) override
+    {
+        // Connection thread
+        juce::MemoryInputStream in(message, false);
+        const int requestId = in.readInt();
+
+        const juce::ScopedLock sl(requestLock);
+        if (auto it = pendingReplies.find(requestId); it != pendingReplies.end())
+        {
+            it->second->message = message;
+            it->second->answered = true;
+            it->second->done.signal();
+        }
+    }
+
+    void handleConnectionLost() override
+    {
+        // Its plugins fall silent; they are not reloaded elsewhere
+        DBG("Plugin worker process " << name << " has gone");
+        running = false;
+
+        const juce::ScopedLock sl(requestLock);
+        for (auto& [id, pending] : pendingReplies)
+            pending->done.signal();
+    }
+
+    const juce::String name;
+    juce::File transportFile;
+    std::unique_ptr<SharedAudioTransport> transport;
+    std::atomic<bool> running{ false };
+    juce::CriticalSection startLock;
+    std::atomic<bool> startFinished{ false };
+    juce::String startError; // guarded by startLock
+
+    juce::CriticalSection requestLock;
+    int lastRequestId = 0;
+    std::map<int, std::shared_ptr<PendingReply>> pendingReplies;
+
+    mutable juce::CriticalSection slotLock;
+    std::array<bool, PluginWorkerProtocol::kMaxPlugins> slotsInUse{};
+};
+
+namespace
+{
+    // The engine's view of a plugin running in a worker process
+    class RemotePluginInstance final : public juce::AudioPluginInstance,
+                                       public RemotePlugin
+    {
+    public:
+        RemotePluginInstance(std::shared_ptr<PluginProcessGroup> processGroup, int slotIndex,
+                             const juce::PluginDescription& pluginDescription,
+                             int numInputs, int numOutputs, double tail, bool midiInput)
+            : juce::AudioPluginInstance(busesFor(numInputs, numOutputs)),
+              group(std::move(processGroup)),
+              slot(slotIndex),
+              description(pluginDescription),
+              tailSeconds(tail),
+              takesMidi(midiInput)
+        {
+            chunkMidi.ensureSize(SharedAudioTransport::kMidiRingSize * 8);
+        }
+
+        ~RemotePluginInstance() override
+        {
+            group->freeSlot(slot);
+        }
+
+        void fillInPluginDescription(juce::PluginDescription& result) const override { result = description; }
+        const juce::String getName() const override { return description.name; }
+
+        void prepareToPlay(double sampleRate, int blockSize) override
+        {
+            setRateAndBufferSizeDetails(sampleRate, blockSize);
+            chunkMillis = 1000.0 * juce::jmin(blockSize, group->getTransport().getMaxBlockSize()) / sampleRate;
+
+            juce::MemoryBlock reply;
+            juce::String error;
+            if (!group->request(PluginWorkerProtocol::prepare,
+                                [this, sampleRate, blockSize](juce::MemoryOutputStream& args)
+                                {
+                                    args.writeInt(slot);
+                                    args.writeDouble(sampleRate);
+                                    args.writeInt(blockSize);
+                                },
+                                reply, error, kRequestTimeoutMs))
+                DBG("Remote plugin " << description.name << " not prepared: " << error);
+        }
+
+        void releaseResources() override {}
+
+        void setDeadline(juce::int64 deadlineTicks) noexcept override
+        {
+            deadline = deadlineTicks;
+        }
+
+        void setOffline(bool shouldBeOffline) noexcept override
+        {
+            offline = shouldBeOffline;
+        }
+
+        void sendBlock(const juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midi) override
+        {
+            // Blocks longer than the transport's go through processBlock, a chunk at a time
+            auto& transport = group->getTransport();
+            if (!group->isRunning() || buffer.getNumSamples() > transport.getMaxBlockSize())
+            {
+                pending = Pending::none;
+                return;
+            }
+
+            // Offline the worker is never left behind, so a block is never missed
+            if (offline && !waitForWorker())
+            {
+                pending = Pending::none;
+                return;
+            }
+
+            pending = transport.sendBlock(slot, buffer, midi, buffer.getNumSamples()) ? Pending::sent : Pending::missed;
+        }
+
+        void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midi) override
+        {
+            // Audio thread. A block the worker misses passes through as it came in.
+            const auto sent = std::exchange(pending, Pending::none);
+            const auto requested = std::exchange(deadline, 0);
+            const auto blockDeadline = requested > 0 ? requested
+                                                     : juce::Time::getHighResolutionTicks()
+                                                           + juce::Time::secondsToHighResolutionTicks(chunkMillis / 1000.0);
+
+            if (!group->isRunning() || sent == Pending::missed)
+            {
+                midi.clear();
+                return;
+            }
+
+            auto& transport = group->getTransport();
+            if (sent == Pending::sent)
+            {
+                receive(buffer, blockDeadline);
+                midi.clear();
+                return;
+            }
+
+            const int numSamples = buffer.getNumSamples();
+            const int chunkSize = transport.getMaxBlockSize();
+            if (numSamples <= chunkSize)
+            {
+                sendAndReceive(buffer, midi, numSamples, blockDeadline);
+            }
+            else
+            {
+                for (int start = 0; start < numSamples; start += chunkSize)
+                {
+                    const int length = juce::jmin(chunkSize, numSamples - start);
+                    juce::AudioBuffer<float> chunk(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, length);
+                    chunkMidi.clear();
+                    chunkMidi.addEvents(midi, start, length, -start);
+                    sendAndReceive(chunk, chunkMidi, length, blockDeadline);
+                }
+            }
+
+            // MIDI the plugin sends is not carried back
+            midi.clear();
+        }
+
+        double getTailLengthSeconds() const override { return tailSeconds; }
+        bool acceptsMidi() const override { return takesMidi; }
+        bool producesMidi() const override { return false; }
+
+        juce::AudioProcessorEditor* createEditor() override { return nullptr; }
+        bool hasEditor() const override { return false; }
+
+        int getNumPrograms() override { return 1; }
+        int getCurrentProgram() override { return 0; }
+        void setCurrentProgram(int) override {}
+        const juce::String getProgramName(int) override { return {}; }
+        void changeProgramName(int, const juce::String&) override {}
+
+        void getStateInformation(juce::MemoryBlock& destData) override
+        {
+            juce::MemoryBlock reply;
+            juce::String error;
+            if (!group->request(PluginWorkerProtocol::getState, [this](juce::MemoryOutputStream& args) { args.writeInt(slot); },
+                                reply, error, kRequestTimeoutMs))
+            {
+                DBG("Remote plugin " << description.name << " state not read: " << error);
+                return;
+            }
+
+            juce::MemoryInputStream in(reply, false);
+            destData.setSize(0);
+            in.readIntoMemoryBlock(destData, in.readInt64());
+        }
+
+        void setStateInformation(const void* data, int sizeInBytes) override
+        {
+            juce::MemoryBlock reply;
+            juce::String error;
+            if (!group->request(PluginWorkerProtocol::setState,
+                                [this, data, sizeInBytes](juce::MemoryOutputStream& args)
+                                {
+                                    args.writeInt(slot);
+                                    args.writeInt64(sizeInBytes);
+                                    args.write(data, (size_t) sizeInBytes);
+                                },
+                                reply, error, kLoadTimeoutMs))
+                DBG("Remote plugin " << description.name << " state not restored: " << error);
+        }
+
+    private:
+        static BusesProperties busesFor(int numInputs, int numOutputs)
+        {
+            BusesProperties buses;
+            if (numInputs > 0)
+                buses = buses.withInput("Input", juce::AudioChannelSet::canonicalChannelSet(numInputs), true);
+            if (numOutputs > 0)
+                buses = buses.withOutput("Output", juce::AudioChannelSet::canonicalChannelSet(numOutputs), true);
+            return buses;
+        }
+
+        std::shared_ptr<PluginProcessGroup> group;
+        const int slot;
+        const juce::PluginDescription description;
+        const double tailSeconds;
+        const bool takesMidi;
+        double chunkMillis = 10.0;
+        juce::MidiBuffer chunkMidi;   // audio thread, for blocks longer than the transport's
+
+        // Audio thread only
+        enum class Pending
+        {
+            none,
+            sent,
+            missed   // the worker was still busy with an earlier block
+        };
+        Pending pending = Pending::none;
+        juce::int64 deadline = 0;
+        bool offline = false; // set with the live callback locked out
+
+        // Offline, the worker is waited for instead of the deadline
+        bool receive(juce::AudioBuffer<float>& buffer, juce::int64 blockDeadline)
+        {
+            if (offline && !waitForWorker())
+                return false;
+            return group->getTransport().receiveBlock(slot, buffer, blockDeadline);
+        }
+
+        bool sendAndReceive(juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midi, int numSamples, juce::int64 blockDeadline)
+        {
+            if (offline && !waitForWorker())
+                return false;
+            return group->getTransport().sendBlock(slot, buffer, midi, numSamples) && receive(buffer, blockDeadline);
+        }
+
+        // Waits, with no deadline, until the worker has finished every block it was handed;
+        // false if its process has gone away
+        bool waitForWorker() const
+        {
+            auto& transport = group->getTransport();
+            while (!transport.isIdle(slot))
+            {
+                if (!group->isRunning())
+                    return false;
+                juce::Thread::yield();
+            }
+            return true;
+        }
+    };
+}
+
+RemotePluginHost::RemotePluginHost() = default;
+RemotePluginHost::~RemotePluginHost() = default;
+
+std::unique_ptr<juce::AudioPluginInstance> RemotePluginHost::createInstance(const juce::String& groupName,
+                                                                            const juce::PluginDescription& description,
+                                                                            double sampleRate, int blockSize,
+                                                                            juce::String& errorMessage)
+{
+    auto group = startedGroup(groupName, errorMessage);
+    if (group == nullptr)
+        return nullptr;
+
+    const int slot = group->allocateSlot();
+    if (slot < 0)
+    {
+        errorMessage = "worker process " + groupName + " already hosts "
+                     + juce::String(PluginWorkerProtocol::kMaxPlugins) + " plugins";
+        return nullptr;
+    }
+
+    juce::MemoryBlock reply;
+    const bool loaded = group->request(PluginWorkerProtocol::load,
+                                       [&](juce::MemoryOutputStream& args)
+                                       {
+                                           args.writeInt(slot);
+                                           args.writeString(description.createXml()->toString());
+                                           args.writeDouble(sampleRate);
+                                           args.writeInt(blockSize);
+                                       },
+                                       reply, errorMessage, kLoadTimeoutMs);
+    if (!loaded)
+    {
+        group->freeSlot(slot);
+        return nullptr;
+    }
+
+    juce::MemoryInputStream in(reply, false);
+    const int numInputs = in.readInt();
+    const int numOutputs = in.readInt();
+    const double tailSeconds = in.readDouble();
+    const bool acceptsMidi = in.readBool();
+
+    auto instance = std::make_unique<RemotePluginInstance>(group, slot, description, numInputs, numOutputs,
+                                                           tailSeconds, acceptsMidi);
+    instance->setRateAndBufferSizeDetails(sampleRate, blockSize);
+    return instance;
+}
+
+std::shared_ptr<PluginProcessGroup> RemotePluginHost::startedGroup(const juce::String& groupName, juce::String& errorMessage)
+{
+    std::shared_ptr<PluginProcessGroup> group;
+    {
+        // A worker that died is replaced; its old plugins stay silent until reloaded
+        const juce::ScopedLock sl(groupLock);
+        auto& entry = groups[groupName];
+        if (entry == nullptr || entry->hasStopped())
+            entry = std::make_shared<PluginProcessGroup>(groupName);
+        group = entry;
+    }
+
+    // Outside groupLock, so a slow start holds up only the loads waiting for this group
+    if (group->ensureStarted(errorMessage))
+        return group;
+
+    const juce::ScopedLock sl(groupLock);
+    if (auto it = groups.find(groupName); it != groups.end() && it->second == group)
+        groups.erase(it);
+    return nullptr;
+}
+
+std::map<juce::String, int> RemotePluginHost::getGroupSizes() const
+{
+    const juce::ScopedLock sl(groupLock);
+    std::map<juce::String, int> sizes;
+    for (const auto& [name, group] : groups)
+    {
+        if (group != nullptr && group->isRunning())
+            sizes[name] = group->getNumPlugins();
+    }
+    return sizes;
+}
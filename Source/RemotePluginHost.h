@@ -0,0 +1,62 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <map>
+#include <memory>
+
+class PluginProcessGroup;
+
+// The audio thread's extra handle on a plugin running in a worker process. A block can be
+// split in two, so every remote plugin is handed its block before the engine waits on any
+// of them: sendBlock starts the worker on it, and the processBlock that follows on the same
+// buffer only collects the result. A result that misses the deadline leaves the buffer as
+// it was sent, so an insert passes its input through dry.
+class RemotePlugin
+{
+public:
+    virtual ~RemotePlugin() = default;
+
+    // Audio thread. The tick (high resolution) by which the next processBlock must have its
+    // result; 0 goes back to waiting up to one block's duration from when it is called.
+    virtual void setDeadline(juce::int64 deadlineTicks) noexcept = 0;
+    // Audio thread. Must be followed, in the same engine block, by processBlock on buffer.
+    virtual void sendBlock(const juce::AudioBuffer<float>& buffer, const juce::MidiBuffer& midi) = 0;
+    // With the live callback locked out. Offline, every block waits for its result however
+    // long the worker takes, and only passes through if the worker process goes away.
+    virtual void setOffline(bool shouldBeOffline) noexcept = 0;
+
+    // Message thread. The remote side of instance, nullptr for a plugin running in this process.
+    static RemotePlugin* of(juce::AudioPluginInstance* instance) { return dynamic_cast<RemotePlugin*>(instance); }
+};
+
+// Hosts plugins in child worker processes, in named groups of up to
+// PluginWorkerProtocol::kMaxPlugins per process. A plugin created here is a stand-in
+// AudioPluginInstance whose processBlock passes the block to its worker over shared memory
+// (see SharedAudioTransport), so PluginManager schedules, routes and mixes it like any other.
+// Remote plugins have no editor and expose no parameters; state save and restore go through.
+class RemotePluginHost
+{
+public:
+    RemotePluginHost();
+    ~RemotePluginHost();
+
+    // Any thread. Starts the group's worker process on first use, then blocks until the worker
+    // has loaded the plugin, which can take a while for big sample libraries.
+    std::unique_ptr<juce::AudioPluginInstance> createInstance(const juce::String& groupName,
+                                                              const juce::PluginDescription& description,
+                                                              double sampleRate, int blockSize,
+                                                              juce::String& errorMessage);
+
+    // Groups whose worker is running, with the number of plugins each hosts
+    std::map<juce::String, int> getGroupSizes() const;
+
+private:
+    // The group's running worker, started by whichever load gets there first; nullptr if it will not start
+    std::shared_ptr<PluginProcessGroup> startedGroup(const juce::String& groupName, juce::String& errorMessage);
+
+    // Groups are shared with their plugins, which keep them alive until the last one goes
+    mutable juce::CriticalSection groupLock;
+    std::map<juce::String, std::shared_ptr<PluginProcessGroup>> groups;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RemotePluginHost)
+};
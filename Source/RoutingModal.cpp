@@ -20,6 +20,11 @@
     rulesLabel.setTooltip("Comma-separated strings to match with plugin instance IDs");
     addAndMakeVisible(rulesLabel);
 
+    metersLabel.setJustificationType(juce::Justification::centredLeft);
+    metersLabel.setTooltip("Peak, RMS and short-term loudness of every bus, refreshed from the audio engine.");
+    addAndMakeVisible(metersLabel);
+    addAndMakeVisible(busMeters);
+
     stemsList.setRowHeight(26);
     stemsList.setMultipleSelectionEnabled(false);
     stemsList.setColour(juce::ListBox::backgroundColourId, juce::Colours::transparentBlack);
@@ -352,6 +357,11 @@ void RoutingModal::resized()
     bounds.removeFromTop(6);
     auto listsArea = bounds.removeFromTop(bounds.getHeight() - 120);
 
+    auto metersArea = listsArea.removeFromRight(240);
+    metersLabel.setBounds(metersArea.removeFromTop(22));
+    busMeters.setBounds(metersArea.reduced(0, 4));
+    listsArea.removeFromRight(10);
+
     auto leftArea = listsArea.removeFromLeft(listsArea.getWidth() / 2);
     const int listHeaderHeight = 24;
     const int addStemButtonWidth = 120;
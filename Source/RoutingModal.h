@@ -4,6 +4,7 @@
 #include <memory>
 #include <functional>
 #include "PluginManager.h"
+#include "BusMeterComponent.h"
 
 class RoutingModal : public juce::Component,
                      private juce::ListBoxModel
@@ -63,11 +64,13 @@ private:
     juce::Label titleLabel{ "titleLabel", "Routing Setup" };
     juce::Label stemsLabel{ "stemsLabel", "Stems" };
     juce::Label rulesLabel{ "rulesLabel", "Match Rules" };
+    juce::Label metersLabel{ "metersLabel", "Bus Meters" };
     juce::Label statusLabel;
 
     juce::ListBox stemsList{ "stemsList", this };
     RulesListModel rulesModel{ *this };
     juce::ListBox rulesList;
+    BusMeterComponent busMeters{ pluginManager.getAudioRouter() };
 
     juce::TextEditor stemNameEditor;
     juce::TextEditor ruleEditor;
@@ -0,0 +1,272 @@
+#include "SharedAudioTransport.h"
+#include <new>
+
+namespace
+{
+    constexpr juce::uint32 kMagic = 0x4f534454; // "OSDT"
+    constexpr juce::uint32 kVersion = 1;
+    constexpr int kSpinsBeforeYield = 512;
+    constexpr double kBusyWaitMs = 50.0;     // worker yields this long before sleeping between blocks
+
+    constexpr size_t alignUp(size_t size)
+    {
+        return (size + 63) & ~(size_t) 63;
+    }
+}
+
+struct SharedAudioTransport::Header
+{
+    juce::uint32 magic;
+    juce::uint32 version;
+    juce::int32 numSlots;
+    juce::int32 maxChannels;
+    juce::int32 maxBlockSize;
+};
+
+struct SharedAudioTransport::SlotHeader
+{
+    alignas(64) std::atomic<juce::uint32> requestSequence{ 0 };   // engine
+    alignas(64) std::atomic<juce::uint32> doneSequence{ 0 };      // worker
+    alignas(64) std::atomic<juce::uint32> midiWrite{ 0 };         // engine
+    alignas(64) std::atomic<juce::uint32> midiRead{ 0 };          // worker
+
+    // Written by the engine before each request
+    juce::int32 numSamples = 0;
+    juce::int32 numChannels = 0;
+};
+
+struct SharedAudioTransport::MidiEventRecord
+{
+    juce::int32 sampleOffset;
+    juce::int32 size;
+    juce::uint8 data[kMaxMidiEventBytes];
+};
+
+// Both processes see the same bytes, so the atomics must not hide a lock
+static_assert(std::atomic<juce::uint32>::is_always_lock_free, "shared memory needs lock-free atomics");
+static_assert((SharedAudioTransport::kMidiRingSize & (SharedAudioTransport::kMidiRingSize - 1)) == 0,
+              "the MIDI ring size must be a power of two");
+
+size_t SharedAudioTransport::slotStrideFor(int maxChannels, int maxBlockSize)
+{
+    return alignUp(sizeof(SlotHeader))
+         + alignUp(sizeof(MidiEventRecord) * (size_t) kMidiRingSize)
+         + alignUp(sizeof(float) * (size_t) maxChannels * (size_t) maxBlockSize);
+}
+
+std::unique_ptr<SharedAudioTransport> SharedAudioTransport::create(const juce::File& file, int numSlots,
+                                                                   int maxChannels, int maxBlockSize)
+{
+    jassert(numSlots > 0 && maxChannels > 0 && maxChannels <= kMaxChannels && maxBlockSize > 0);
+    const size_t size = alignUp(sizeof(Header)) + (size_t) numSlots * slotStrideFor(maxChannels, maxBlockSize);
+
+    file.deleteFile();
+    {
+        juce::FileOutputStream out(file);
+        if (!out.openedOk() || !out.writeRepeatedByte(0, size))
+        {
+            DBG("SharedAudioTransport: cannot create " << file.getFullPathName());
+            return nullptr;
+        }
+    }
+
+    auto mapping = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readWrite, false);
+    if (mapping->getData() == nullptr || mapping->getSize() < size)
+    {
+        DBG("SharedAudioTransport: cannot map " << file.getFullPathName());
+        return nullptr;
+    }
+
+    return std::unique_ptr<SharedAudioTransport>(
+        new SharedAudioTransport(std::move(mapping), true, numSlots, maxChannels, maxBlockSize));
+}
+
+std::unique_ptr<SharedAudioTransport> SharedAudioTransport::open(const juce::File& file)
+{
+    auto mapping = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readWrite, false);
+    if (mapping->getData() == nullptr || mapping->getSize() < sizeof(Header))
+    {
+        DBG("SharedAudioTransport: cannot map " << file.getFullPathName());
+        return nullptr;
+    }
+
+    const auto& header = *static_cast<const Header*>(mapping->getData());
+    if (header.magic != kMagic || header.version != kVersion || header.numSlots <= 0
+        || header.maxChannels <= 0 || header.maxChannels > kMaxChannels || header.maxBlockSize <= 0
+        || mapping->getSize() < alignUp(sizeof(Header)) + (size_t) header.numSlots * slotStrideFor(header.maxChannels, header.maxBlockSize))
+    {
+        DBG("SharedAudioTransport: " << file.getFullPathName() << " is not a transport file");
+        return nullptr;
+    }
+
+    const int numSlots = header.numSlots;
+    const int maxChannels = header.maxChannels;
+    const int maxBlockSize = header.maxBlockSize;
+    return std::unique_ptr<SharedAudioTransport>(
+        new SharedAudioTransport(std::move(mapping), false, numSlots, maxChannels, maxBlockSize));
+}
+
+SharedAudioTransport::SharedAudioTransport(std::unique_ptr<juce::MemoryMappedFile> mappingToUse, bool initialise,
+                                           int slots, int channels, int blockSize)
+    : mapping(std::move(mappingToUse)),
+      base(static_cast<char*>(mapping->getData())),
+      numSlots(slots),
+      maxChannels(channels),
+      maxBlockSize(blockSize),
+      slotStride(slotStrideFor(channels, blockSize))
+{
+    if (!initialise)
+        return;
+
+    for (int slot = 0; slot < numSlots; ++slot)
+        new (&slotHeader(slot)) SlotHeader();
+
+    // Written last, so a worker never sees a valid header over unformatted slots
+    auto* header = reinterpret_cast<Header*>(base);
+    header->numSlots = numSlots;
+    header->maxChannels = maxChannels;
+    header->maxBlockSize = maxBlockSize;
+    header->version = kVersion;
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = kMagic;
+}
+
+SharedAudioTransport::SlotHeader& SharedAudioTransport::slotHeader(int slot) const
+{
+    jassert(slot >= 0 && slot < numSlots);
+    return *reinterpret_cast<SlotHeader*>(base + alignUp(sizeof(Header)) + (size_t) slot * slotStride);
+}
+
+SharedAudioTransport::MidiEventRecord* SharedAudioTransport::midiRing(int slot) const
+{
+    return reinterpret_cast<MidiEventRecord*>(reinterpret_cast<char*>(&slotHeader(slot)) + alignUp(sizeof(SlotHeader)));
+}
+
+float* SharedAudioTransport::channelData(int slot, int channel) const
+{
+    auto* audio = reinterpret_cast<char*>(midiRing(slot)) + alignUp(sizeof(MidiEventRecord) * (size_t) kMidiRingSize);
+    return reinterpret_cast<float*>(audio) + (size_t) channel * (size_t) maxBlockSize;
+}
+
+bool SharedAudioTransport::sendBlock(int slot, const juce::AudioBuffer<float>& audio, const juce::MidiBuffer& midi,
+                                     int numSamples)
+{
+    auto& header = slotHeader(slot);
+    numSamples = juce::jmin(numSamples, maxBlockSize, audio.getNumSamples());
+
+    // MIDI goes into the ring whether or not this block gets through, so nothing is lost
+    auto* ring = midiRing(slot);
+    auto write = header.midiWrite.load(std::memory_order_relaxed);
+    const auto read = header.midiRead.load(std::memory_order_acquire);
+    for (const auto metadata : midi)
+    {
+        if (metadata.numBytes > kMaxMidiEventBytes || write - read >= (juce::uint32) kMidiRingSize)
+            continue;
+
+        auto& record = ring[write & (juce::uint32) (kMidiRingSize - 1)];
+        record.sampleOffset = juce::jlimit(0, juce::jmax(0, numSamples - 1), metadata.samplePosition);
+        record.size = metadata.numBytes;
+        std::memcpy(record.data, metadata.data, (size_t) metadata.numBytes);
+        ++write;
+    }
+    header.midiWrite.store(write, std::memory_order_release);
+
+    const auto previous = header.requestSequence.load(std::memory_order_relaxed);
+    if (header.doneSequence.load(std::memory_order_acquire) != previous)
+        return false;
+
+    const int numChannels = juce::jmin(audio.getNumChannels(), maxChannels);
+    for (int ch = 0; ch < numChannels; ++ch)
+        std::memcpy(channelData(slot, ch), audio.getReadPointer(ch), sizeof(float) * (size_t) numSamples);
+
+    header.numSamples = numSamples;
+    header.numChannels = numChannels;
+    header.requestSequence.store(previous + 1, std::memory_order_release);
+    return true;
+}
+
+bool SharedAudioTransport::receiveBlock(int slot, juce::AudioBuffer<float>& audio, juce::int64 deadlineTicks)
+{
+    auto& header = slotHeader(slot);
+    const auto sequence = header.requestSequence.load(std::memory_order_relaxed);
+    for (int spins = 0; header.doneSequence.load(std::memory_order_acquire) != sequence; ++spins)
+    {
+        if (juce::Time::getHighResolutionTicks() > deadlineTicks)
+            return false;
+        if (spins >= kSpinsBeforeYield)
+            juce::Thread::yield();
+    }
+
+    // Only this side writes the sizes, so they are still the ones sendBlock wrote
+    const int numSamples = juce::jmin((int) header.numSamples, audio.getNumSamples());
+    const int numChannels = juce::jmin((int) header.numChannels, audio.getNumChannels());
+    for (int ch = 0; ch < numChannels; ++ch)
+        std::memcpy(audio.getWritePointer(ch), channelData(slot, ch), sizeof(float) * (size_t) numSamples);
+    return true;
+}
+
+bool SharedAudioTransport::isIdle(int slot) const
+{
+    auto& header = slotHeader(slot);
+    return header.doneSequence.load(std::memory_order_acquire) == header.requestSequence.load(std::memory_order_relaxed);
+}
+
+bool SharedAudioTransport::waitForBlock(int slot, juce::uint32& sequence, int timeoutMs)
+{
+    auto& header = slotHeader(slot);
+    const auto start = juce::Time::getMillisecondCounterHiRes();
+    for (int spins = 0;; ++spins)
+    {
+        const auto request = header.requestSequence.load(std::memory_order_acquire);
+        if (request != header.doneSequence.load(std::memory_order_relaxed))
+        {
+            sequence = request;
+            return true;
+        }
+
+        if (spins < kSpinsBeforeYield)
+            continue;
+
+        // Yield while blocks are arriving, sleep once playback has stopped
+        const auto elapsed = juce::Time::getMillisecondCounterHiRes() - start;
+        if (elapsed >= timeoutMs)
+            return false;
+        if (elapsed < kBusyWaitMs)
+            juce::Thread::yield();
+        else
+            juce::Thread::sleep(1);
+    }
+}
+
+void SharedAudioTransport::readBlock(int slot, int minChannels, juce::AudioBuffer<float>& audioView, juce::MidiBuffer& midi)
+{
+    auto& header = slotHeader(slot);
+    const int numSamples = juce::jlimit(0, maxBlockSize, (int) header.numSamples);
+
+    // The plugin may want more channels than were sent; those start silent
+    const int numChannels = juce::jlimit(1, maxChannels, juce::jmax((int) header.numChannels, minChannels));
+    float* channels[kMaxChannels] = {};
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        channels[ch] = channelData(slot, ch);
+        if (ch >= header.numChannels)
+            juce::FloatVectorOperations::clear(channels[ch], numSamples);
+    }
+    audioView.setDataToReferTo(channels, numChannels, numSamples);
+
+    midi.clear();
+    const auto* ring = midiRing(slot);
+    auto read = header.midiRead.load(std::memory_order_relaxed);
+    const auto write = header.midiWrite.load(std::memory_order_acquire);
+    for (; read != write; ++read)
+    {
+        const auto& record = ring[read & (juce::uint32) (kMidiRingSize - 1)];
+        midi.addEvent(record.data, record.size, juce::jlimit(0, juce::jmax(0, numSamples - 1), (int) record.sampleOffset));
+    }
+    header.midiRead.store(read, std::memory_order_release);
+}
+
+void SharedAudioTransport::finishBlock(int slot, juce::uint32 sequence)
+{
+    slotHeader(slot).doneSequence.store(sequence, std::memory_order_release);
+}
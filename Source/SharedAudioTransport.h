@@ -0,0 +1,73 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+
+// Block transport between the engine and a plugin worker process, in a memory mapped file
+// both processes open. Each hosted plugin has a slot holding one block of audio, processed
+// in place as processBlock does, and a lock-free ring of MIDI events. A block is handed over
+// by bumping the slot's request sequence and handed back by the worker setting its done
+// sequence to match; nothing else is shared, and neither side ever locks.
+class SharedAudioTransport
+{
+public:
+    static constexpr int kMaxMidiEventBytes = 16;   // longer messages (SysEx) are not carried
+    static constexpr int kMidiRingSize = 1024;       // events, a power of two
+    static constexpr int kMaxChannels = 64;
+
+    // Engine side: creates and sizes the file, replacing anything already there
+    static std::unique_ptr<SharedAudioTransport> create(const juce::File& file, int numSlots,
+                                                        int maxChannels, int maxBlockSize);
+    // Worker side: maps a file made by create
+    static std::unique_ptr<SharedAudioTransport> open(const juce::File& file);
+
+    int getNumSlots() const { return numSlots; }
+    int getMaxChannels() const { return maxChannels; }
+    int getMaxBlockSize() const { return maxBlockSize; }
+
+    // Engine side, audio thread. Hands the first numSamples of audio and midi to the worker
+    // without waiting for it. False if the worker is still busy with an earlier block; the
+    // MIDI is delivered with the next block in that case.
+    bool sendBlock(int slot, const juce::AudioBuffer<float>& audio, const juce::MidiBuffer& midi, int numSamples);
+    // Engine side, audio thread. Waits until deadlineTicks (high resolution ticks) for the
+    // block sendBlock handed over and writes it back into audio. False, leaving audio as it
+    // was, if the worker has not finished by then.
+    bool receiveBlock(int slot, juce::AudioBuffer<float>& audio, juce::int64 deadlineTicks);
+    // Engine side: the worker has finished every block handed to it
+    bool isIdle(int slot) const;
+    bool processBlock(int slot, juce::AudioBuffer<float>& audio, const juce::MidiBuffer& midi,
+                      int numSamples, juce::int64 deadlineTicks)
+    {
+        return sendBlock(slot, audio, midi, numSamples) && receiveBlock(slot, audio, deadlineTicks);
+    }
+
+    // Worker side. Waits up to timeoutMs for the slot's next block.
+    bool waitForBlock(int slot, juce::uint32& sequence, int timeoutMs);
+    // Worker side: the block's audio, in place in the shared memory and at least minChannels
+    // wide, and its MIDI
+    void readBlock(int slot, int minChannels, juce::AudioBuffer<float>& audioView, juce::MidiBuffer& midi);
+    void finishBlock(int slot, juce::uint32 sequence);
+
+private:
+    struct Header;
+    struct SlotHeader;
+    struct MidiEventRecord;
+
+    SharedAudioTransport(std::unique_ptr<juce::MemoryMappedFile> mapping, bool initialise,
+                         int numSlots, int maxChannels, int maxBlockSize);
+
+    static size_t slotStrideFor(int maxChannels, int maxBlockSize);
+    SlotHeader& slotHeader(int slot) const;
+    MidiEventRecord* midiRing(int slot) const;
+    float* channelData(int slot, int channel) const;
+
+    std::unique_ptr<juce::MemoryMappedFile> mapping;
+    char* base = nullptr;
+    int numSlots = 0;
+    int maxChannels = 0;
+    int maxBlockSize = 0;
+    size_t slotStride = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SharedAudioTransport)
+};
@@ -0,0 +1,145 @@
+#include "TempoMap.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr double kBarEpsilon = 1.0e-9;
+
+    double quarterNotesPerBar(const TempoMap::Point& point)
+    {
+        return 4.0 * point.numerator / point.denominator;
+    }
+
+    // A point at a fractional sample takes over from the sample after it
+    juce::int64 changeSampleOf(const TempoMap::Point& point, double sampleRate)
+    {
+        return (juce::int64)std::ceil(point.timeSeconds * sampleRate);
+    }
+}
+
+TempoMap::TempoMap() : TempoMap(std::vector<Point>{ Point{} })
+{
+}
+
+TempoMap::TempoMap(std::vector<Point> newPoints)
+{
+    for (auto& point : newPoints)
+    {
+        point.timeSeconds = juce::jmax(0.0, point.timeSeconds);
+        point.bpm = std::isfinite(point.bpm) ? juce::jlimit(kMinBpm, kMaxBpm, point.bpm) : 120.0;
+        point.numerator = juce::jlimit(1, 64, point.numerator);
+        point.denominator = juce::jlimit(1, 64, point.denominator);
+    }
+
+    // Later points win at the same time
+    std::stable_sort(newPoints.begin(), newPoints.end(), [](const Point& a, const Point& b)
+                     { return a.timeSeconds < b.timeSeconds; });
+    for (auto& point : newPoints)
+    {
+        if (!points.empty() && point.timeSeconds <= points.back().timeSeconds)
+            points.back() = point;
+        else
+            points.push_back(point);
+    }
+
+    if (points.empty())
+        points.push_back(Point{});
+    points.front().timeSeconds = 0.0;
+
+    startPpq.resize(points.size(), 0.0);
+    startBar.resize(points.size(), 0.0);
+    for (size_t i = 1; i < points.size(); ++i)
+    {
+        const auto& previous = points[i - 1];
+        const double quarters = (points[i].timeSeconds - previous.timeSeconds) * previous.bpm / 60.0;
+        startPpq[i] = startPpq[i - 1] + quarters;
+
+        double bar = startBar[i - 1] + quarters / quarterNotesPerBar(previous);
+        if (points[i].numerator != previous.numerator || points[i].denominator != previous.denominator)
+            bar = std::ceil(bar - kBarEpsilon);
+        startBar[i] = bar;
+    }
+}
+
+TempoMap TempoMap::constant(double bpm, int numerator, int denominator)
+{
+    return TempoMap({ Point{ 0.0, bpm, numerator, denominator } });
+}
+
+int TempoMap::segmentIndexAt(double timeSeconds) const
+{
+    auto it = std::upper_bound(points.begin(), points.end(), timeSeconds, [](double t, const Point& point)
+                               { return t < point.timeSeconds; });
+    return juce::jmax(0, (int)std::distance(points.begin(), it) - 1);
+}
+
+int TempoMap::segmentIndexAtSample(juce::int64 samplePosition, double sampleRate) const
+{
+    auto it = std::upper_bound(points.begin(), points.end(), samplePosition, [sampleRate](juce::int64 s, const Point& point)
+                               { return s < changeSampleOf(point, sampleRate); });
+    return juce::jmax(0, (int)std::distance(points.begin(), it) - 1);
+}
+
+const TempoMap::Point& TempoMap::getPointAt(double timeSeconds) const
+{
+    return points[(size_t)segmentIndexAt(timeSeconds)];
+}
+
+juce::AudioPlayHead::PositionInfo TempoMap::getPositionAt(juce::int64 samplePosition, double sampleRate) const
+{
+    samplePosition = juce::jmax<juce::int64>(0, samplePosition);
+    const double timeSeconds = sampleRate > 0.0 ? samplePosition / sampleRate : 0.0;
+    const auto index = (size_t)(sampleRate > 0.0 ? segmentIndexAtSample(samplePosition, sampleRate) : 0);
+    const auto& point = points[index];
+
+    const double ppq = startPpq[index] + (timeSeconds - point.timeSeconds) * point.bpm / 60.0;
+    const double barLength = quarterNotesPerBar(point);
+    const double barsIntoSegment = std::floor((ppq - startPpq[index]) / barLength + kBarEpsilon);
+
+    juce::AudioPlayHead::PositionInfo position;
+    position.setBpm(point.bpm);
+    position.setTimeSignature(juce::AudioPlayHead::TimeSignature{ point.numerator, point.denominator });
+    position.setTimeInSamples(samplePosition);
+    position.setTimeInSeconds(timeSeconds);
+    position.setPpqPosition(ppq);
+    position.setPpqPositionOfLastBarStart(startPpq[index] + barsIntoSegment * barLength);
+    position.setBarCount((juce::int64)(startBar[index] + barsIntoSegment));
+    return position;
+}
+
+juce::int64 TempoMap::getNextChangeSample(juce::int64 samplePosition, double sampleRate) const
+{
+    if (sampleRate <= 0.0)
+        return -1;
+
+    const auto next = (size_t)segmentIndexAtSample(samplePosition, sampleRate) + 1;
+    return next < points.size() ? changeSampleOf(points[next], sampleRate) : -1;
+}
+
+std::unique_ptr<juce::XmlElement> TempoMap::createXml() const
+{
+    auto xml = std::make_unique<juce::XmlElement>(kXmlTag);
+    for (const auto& point : points)
+    {
+        auto* xmlPoint = xml->createNewChildElement("Point");
+        xmlPoint->setAttribute("time", point.timeSeconds);
+        xmlPoint->setAttribute("bpm", point.bpm);
+        xmlPoint->setAttribute("numerator", point.numerator);
+        xmlPoint->setAttribute("denominator", point.denominator);
+    }
+    return xml;
+}
+
+TempoMap TempoMap::fromXml(const juce::XmlElement& xml)
+{
+    std::vector<Point> loaded;
+    for (auto* xmlPoint : xml.getChildWithTagNameIterator("Point"))
+    {
+        loaded.push_back({ xmlPoint->getDoubleAttribute("time"),
+                           xmlPoint->getDoubleAttribute("bpm", 120.0),
+                           xmlPoint->getIntAttribute("numerator", 4),
+                           xmlPoint->getIntAttribute("denominator", 4) });
+    }
+    return TempoMap(std::move(loaded));
+}
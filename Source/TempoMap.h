@@ -0,0 +1,50 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+// Tempo and time signature over playback time, as steps: each point holds from its time until
+// the next one. Times are seconds since playback zero, the same clock MIDI timestamps use, so a
+// map does not depend on the sample rate. A map never changes once built; PluginManager
+// publishes a new one to change it, and reads it on the audio thread without locking.
+class TempoMap
+{
+public:
+    struct Point
+    {
+        double timeSeconds = 0.0;
+        double bpm = 120.0;
+        int numerator = 4;
+        int denominator = 4;
+    };
+
+    static constexpr double kMinBpm = 1.0;
+    static constexpr double kMaxBpm = 999.0;
+
+    TempoMap();
+    // Sorted by time; out of range values are clamped, and the first point moves to time zero.
+    // A point whose signature differs from the one before starts a new bar.
+    explicit TempoMap(std::vector<Point> points);
+    static TempoMap constant(double bpm, int numerator = 4, int denominator = 4);
+
+    const std::vector<Point>& getPoints() const { return points; }
+    const Point& getPointAt(double timeSeconds) const;
+
+    // Realtime safe. Tempo, signature, musical position and bar for the sample; not playing.
+    juce::AudioPlayHead::PositionInfo getPositionAt(juce::int64 samplePosition, double sampleRate) const;
+    // First sample after samplePosition at which a point takes over, or -1 when none is left
+    juce::int64 getNextChangeSample(juce::int64 samplePosition, double sampleRate) const;
+
+    std::unique_ptr<juce::XmlElement> createXml() const;
+    // An empty or unreadable element gives the default map
+    static TempoMap fromXml(const juce::XmlElement& xml);
+    static constexpr const char* kXmlTag = "TempoMap";
+
+private:
+    int segmentIndexAt(double timeSeconds) const;
+    int segmentIndexAtSample(juce::int64 samplePosition, double sampleRate) const;
+
+    std::vector<Point> points;
+    std::vector<double> startPpq;   // per point
+    std::vector<double> startBar;   // per point, bars since zero
+};